@@ -51,7 +51,8 @@ auto Demo_Icon = [](Application& app)
     {
         auto& icon = app.entities.get<Icon>(entity);
 
-        ImGuiLTable::Checkbox("Visible", &icon.active);
+        if (ImGuiLTable::Checkbox("Visible", &icon.active))
+            app.entities.patch<Icon>(entity);
 
         if (ImGuiLTable::SliderFloat("Pixel size", &icon.style.size_pixels, 1.0f, 1024.0f))
             icon.dirty();
@@ -59,7 +59,8 @@ auto Demo_Label = [](Application& app)
     if (ImGuiLTable::Begin("text"))
     {
         auto& label = app.entities.get<Label>(entity);
-        ImGuiLTable::Checkbox("Visible", &label.active);
+        if (ImGuiLTable::Checkbox("Visible", &label.active))
+            app.entities.patch<Label>(entity);
 
         char buf[256];
         strcpy(&buf[0], label.text.c_str());
@@ -67,13 +68,20 @@ auto Demo_Label = [](Application& app)
         {
             label.text = std::string(buf);
             label.dirty();
+            app.entities.patch<Label>(entity);
         }
 
         if (ImGuiLTable::SliderFloat("Point size", &label.style.pointSize, 8.0f, 144.0f, "%.1f"))
+        {
             label.dirty();
+            app.entities.patch<Label>(entity);
+        }
 
         if (ImGuiLTable::SliderFloat("Outline size", &label.style.outlineSize, 0.0f, 0.5f, "%.2f"))
+        {
             label.dirty();
+            app.entities.patch<Label>(entity);
+        }
 
         auto& transform = app.entities.get<Transform>(entity);
         auto& xform = transform.node;
@@ -49,7 +49,8 @@ auto Demo_Line_Absolute = [](Application& app)
     {
         auto& component = app.entities.get<Line>(entity);
 
-        ImGuiLTable::Checkbox("Visible", &component.active);
+        if (ImGuiLTable::Checkbox("Visible", &component.active))
+            app.entities.patch<Line>(entity);
 
         if (component.style.has_value())
         {
@@ -107,7 +108,8 @@ auto Demo_Line_Relative = [](Application& app)
     {
         auto& line = app.entities.get<Line>(entity);
 
-        ImGuiLTable::Checkbox("Visible", &line.active);
+        if (ImGuiLTable::Checkbox("Visible", &line.active))
+            app.entities.patch<Line>(entity);
 
         if (line.style.has_value())
         {
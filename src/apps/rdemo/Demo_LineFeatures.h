@@ -58,7 +58,8 @@ auto Demo_LineFeatures = [](Application& app)
     if (ImGuiLTable::Begin("Line features"))
     {
         auto& component = app.entities.get<FeatureView>(entity);
-        ImGuiLTable::Checkbox("Visible", &component.active);
+        if (ImGuiLTable::Checkbox("Visible", &component.active))
+            ECS::patch<Line, Mesh>(app.entities, component.next_entity);
 
         ImGuiLTable::End();
     }
@@ -51,7 +51,8 @@ auto Demo_Mesh_Absolute = [](Application& app)
     {
         auto& mesh = app.entities.get<Mesh>(entity);
 
-        ImGuiLTable::Checkbox("Visible", &mesh.active);
+        if (ImGuiLTable::Checkbox("Visible", &mesh.active))
+            app.entities.patch<Mesh>(entity);
 
         if (mesh.style.has_value())
         {
@@ -128,7 +129,8 @@ auto Demo_Mesh_Relative = [](Application& app)
     {
         auto& mesh = app.entities.get<Mesh>(entity);
 
-        ImGuiLTable::Checkbox("Visible", &mesh.active);
+        if (ImGuiLTable::Checkbox("Visible", &mesh.active))
+            app.entities.patch<Mesh>(entity);
 
         auto* style = app.entities.try_get<MeshStyle>(entity);
         if (style)
@@ -206,7 +208,8 @@ auto Demo_Mesh_Multi = [](Application& app)
     {
         auto& mesh = app.entities.get<Mesh>(entity);
 
-        ImGuiLTable::Checkbox("Visible", &mesh.active);
+        if (ImGuiLTable::Checkbox("Visible", &mesh.active))
+            app.entities.patch<Mesh>(entity);
 
         auto* style = app.entities.try_get<MeshStyle>(entity);
         if (style)
@@ -68,7 +68,8 @@ auto Demo_Model = [](Application& app)
     if (ImGuiLTable::Begin("model"))
     {
         auto& component = app.entities.get<ECS::NodeComponent>(entity);
-        ImGuiLTable::Checkbox("Visible", &component.active);
+        if (ImGuiLTable::Checkbox("Visible", &component.active))
+            app.entities.patch<ECS::NodeComponent>(entity);
 
         auto& transform = app.entities.get<Transform>(entity);
         auto& geo = transform.node;
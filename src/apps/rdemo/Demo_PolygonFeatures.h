@@ -67,7 +67,8 @@ auto Demo_PolygonFeatures = [](Application& app)
     if (ImGuiLTable::Begin("Polygon features"))
     {
         auto& component = app.entities.get<FeatureView>(entity);
-        ImGuiLTable::Checkbox("Visible", &component.active);
+        if (ImGuiLTable::Checkbox("Visible", &component.active))
+            ECS::patch<Line, Mesh>(app.entities, component.next_entity);
 
         ImGuiLTable::End();
     }
@@ -152,7 +152,8 @@ auto Demo_RTT = [](Application& app)
     {
         auto& mesh = app.entities.get<Mesh>(entity);
 
-        ImGuiLTable::Checkbox("Visible", &mesh.active);
+        if (ImGuiLTable::Checkbox("Visible", &mesh.active))
+            app.entities.patch<Mesh>(entity);
 
         ImGuiLTable::End();
     }
@@ -13,6 +13,7 @@
 #include <rocky_vsg/engine/TerrainEngine.h>
 #include <rocky/Memory.h>
 #include <vsg/core/Allocator.h>
+#include <algorithm>
 #include "helpers.h"
 
 using namespace ROCKY_NAMESPACE;
@@ -39,6 +40,11 @@ namespace
             total += t[i % frame_count].count();
         return total / count;
     }
+    long long percentile(const Timings& t, float p) {
+        Timings sorted(t);
+        std::sort(sorted.begin(), sorted.end());
+        return (long long)sorted[std::min((int)(p * (float)frame_count), frame_count - 1)].count();
+    }
 }
 auto Demo_Stats = [](Application& app)
 {
@@ -67,6 +73,8 @@ auto Demo_Stats = [](Application& app)
         sprintf(buf, "%.2f ms", 0.001f * (float)app.stats.frame.count());
         ImGuiLTable::PlotLines("Frame", get_timings, &frames, frame_count, f, buf, 0.0f, 17.0f);
 
+        ImGuiLTable::Text("Frame p99", "%.2f ms", 0.001f * (float)percentile(frames, 0.99f));
+
         sprintf(buf, u8"%lld \x00B5s", average(&events, over, f));
         ImGuiLTable::PlotLines("Event", get_timings, &events, frame_count, f, buf, 0.0f, 10.0f);
 
@@ -76,6 +84,23 @@ auto Demo_Stats = [](Application& app)
         sprintf(buf, u8"%lld \x00B5s", average(&record, over, f));
         ImGuiLTable::PlotLines("Record", get_timings, &record, frame_count, f, buf, 0.0f, 10.0f);
 
+        for (auto& [viewID, t] : app.stats.viewRecord)
+        {
+            sprintf(buf, "  View %u", viewID);
+            ImGuiLTable::Text(buf, u8"%lld \x00B5s", (long long)t.count());
+        }
+
+        ImGuiLTable::End();
+    }
+
+    ImGui::SeparatorText("Uploads");
+    if (ImGuiLTable::Begin("Uploads"))
+    {
+        auto& uploads = app.instance.runtime().uploadStats();
+        ImGuiLTable::Text("Uploads / frame", u8"%u (%.1lf KB, %llu \x00B5s)", uploads.objects,
+            (double)uploads.bytes / 1024.0, (unsigned long long)uploads.time);
+        ImGuiLTable::Text("Uploads pending", "%u", uploads.pending);
+        ImGuiLTable::Text("Upload rate", "%.1lf MB/s", uploads.megabytesPerSecond);
         ImGuiLTable::End();
     }
 
@@ -115,6 +140,23 @@ auto Demo_Stats = [](Application& app)
         auto& engine = app.mapNode->terrain->engine;
         ImGuiLTable::Text("Resident tiles", std::to_string(engine->tiles.size()).c_str());
         ImGuiLTable::Text("Geometry pool cache", std::to_string(engine->geometryPool.size()).c_str());
+        ImGuiLTable::Text("Shared tile textures", std::to_string(engine->stateFactory.sharedTextureCount()).c_str());
+        auto textureStats = engine->stateFactory.textureStats();
+        ImGuiLTable::Text("Tile textures", "%zu (%zu compressed)", textureStats.textures, textureStats.compressed);
+        ImGuiLTable::Text("Texture data", "%.1lf MB (%.1lf MB raw)",
+            (double)textureStats.bytes / 1048576.0, (double)textureStats.uncompressedBytes / 1048576.0);
+        auto tileStats = engine->tiles.stats();
+        ImGuiLTable::Text("Tile pings / frame", std::to_string(tileStats.pings).c_str());
+        ImGuiLTable::Text("Tiles expired / frame", std::to_string(tileStats.expired).c_str());
+        ImGuiLTable::Text("Ping lock wait", "%lld us", (long long)tileStats.pingLockWait.count());
+        ImGuiLTable::Text("Tiles drawn", std::to_string(tileStats.drawn).c_str());
+        ImGuiLTable::Text("Frustum culled", std::to_string(tileStats.frustumCulled).c_str());
+        ImGuiLTable::Text("Horizon culled", std::to_string(tileStats.horizonCulled).c_str());
+        ImGuiLTable::Text("Merges / frame", "%u (%u deferred)", tileStats.merged, tileStats.mergesDeferred);
+        ImGuiLTable::Text("Requests deferred", "%u subtiles, %u loads", tileStats.subtilesDeferred, tileStats.loadsDeferred);
+        ImGuiLTable::Text("Expiry deferred", tileStats.expiryDeferred ? "yes" : "no");
+        ImGuiLTable::Text("Budgeted update", u8"%lld \x00B5s / %.1f ms", (long long)tileStats.budgetedTime.count(),
+            engine->settings.updateBudget.value());
         ImGuiLTable::End();
     }
 
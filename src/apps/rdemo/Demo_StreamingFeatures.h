@@ -0,0 +1,87 @@
+/**
+ * rocky c++
+ * Copyright 2023 Pelican Mapping
+ * MIT License
+ */
+#pragma once
+#include <rocky_vsg/FeatureView.h>
+#include "helpers.h"
+
+using namespace ROCKY_NAMESPACE;
+
+/**
+* Streams a (possibly very large) vector data source into the scene with a
+* FeatureLoader. Reading and tessellation run in the background; the frame
+* only pays for handing finished chunks to the registry.
+*/
+auto Demo_StreamingFeatures = [](Application& app)
+{
+#ifdef GDAL_FOUND
+    static FeatureLoader loader;
+    static Status status;
+    static char uri[512] = "https://readymap.org/readymap/filemanager/download/public/countries.geojson";
+    static std::chrono::steady_clock::time_point started;
+    static std::chrono::steady_clock::duration elapsed;
+
+    if (ImGuiLTable::Begin("Streaming features"))
+    {
+        ImGuiLTable::InputText("Source", uri, sizeof(uri));
+
+        if (ImGuiLTable::Button("Load"))
+        {
+            auto fs = rocky::OGRFeatureSource::create();
+            fs->uri = std::string(uri);
+            status = fs->open();
+            if (status.ok())
+            {
+                // color by feature ID; this runs in worker threads
+                loader.styles.mesh_function = [](const Feature& f)
+                    {
+                        auto h = (std::uint64_t)f.id * 0x9E3779B97F4A7C15ull;
+                        return MeshStyle{
+                            { 0.15f + 0.85f * (float)((h >> 40) & 0xff) / 255.0f,
+                              0.15f + 0.85f * (float)((h >> 48) & 0xff) / 255.0f,
+                              0.15f + 0.85f * (float)((h >> 56) & 0xff) / 255.0f, 1.0f },
+                            64.0f };
+                    };
+                loader.styles.line = LineStyle{ { 1, 1, 0, 1 }, 2.0f };
+                status = loader.load(fs, app.instance.ioOptions());
+                started = std::chrono::steady_clock::now();
+            }
+        }
+
+        if (status.failed())
+        {
+            ImGui::TextColored(ImVec4(1, 0, 0, 1), status.message.c_str());
+        }
+
+        loader.update(app.entities);
+
+        if (!loader.done() && !loader.entities.empty())
+            elapsed = std::chrono::steady_clock::now() - started;
+
+        auto stats = loader.stats();
+        if (ImGuiLTable::Checkbox("Visible", &loader.active))
+        {
+            for (auto e : loader.entities)
+                ECS::patch<Line, Mesh>(app.entities, e);
+        }
+        ImGuiLTable::Text("Features read", "%d", (int)stats.read);
+        ImGuiLTable::Text("Features in scene", "%d", (int)stats.handedOver);
+        ImGuiLTable::Text("Chunks in flight", "%d", (int)stats.chunksInFlight);
+        ImGuiLTable::Text("Load time", "%.1f s", std::chrono::duration<float>(elapsed).count());
+        ImGuiLTable::Text("Frame", "%.2f ms", 0.001f * (float)app.stats.frame.count());
+
+        if (ImGuiLTable::Button("Remove"))
+        {
+            loader.cancel();
+            app.entities.destroy(loader.entities.begin(), loader.entities.end());
+            loader.entities.clear();
+        }
+
+        ImGuiLTable::End();
+    }
+#else
+    ImGui::TextColored(ImVec4(1, .3, .3, 1), "Unavailable - not built with GDAL");
+#endif
+};
@@ -0,0 +1,343 @@
+/**
+ * rocky c++
+ * Copyright 2023 Pelican Mapping
+ * MIT License
+ */
+#pragma once
+#include <rocky_vsg/Icon.h>
+#include <rocky_vsg/engine/IconSystem.h>
+#include <rocky_vsg/Label.h>
+#include <rocky_vsg/engine/LabelSystem.h>
+#include <rocky_vsg/Line.h>
+#include <random>
+
+#include "helpers.h"
+using namespace ROCKY_NAMESPACE;
+
+/**
+* Benchmark: creates a large number of Transform-bearing icon entities
+* scattered around the globe so you can watch how the record traversal
+* scales. Compare the "Record" timing before and after creating them;
+* try 10k, 50k and 200k, with and without instanced icons, and with
+* some of them moving.
+*/
+auto Demo_Stress = [](Application& app)
+{
+    static std::vector<entt::entity> entities;
+    static std::shared_ptr<Image> image;
+    static int count = 10000;
+    static std::chrono::microseconds baseline_record(0);
+    static float moving_percent = 0.0f;
+    static std::mt19937 motion_rng(1);
+
+    IconSystemNode* icons = nullptr;
+    for (auto& system : app.ecs.systems)
+    {
+        auto icon_system = std::dynamic_pointer_cast<IconSystem>(system);
+        if (icon_system)
+            icons = static_cast<IconSystemNode*>(icon_system->getOrCreateNode().get());
+    }
+
+    if (!image)
+    {
+        // a tiny shared image keeps the GPU memory down:
+        image = Image::create(Image::R8G8B8A8_UNORM, 4, 4);
+        image->fill(glm::fvec4(1, 1, 0, 1));
+    }
+
+    if (ImGuiLTable::Begin("stress"))
+    {
+        if (icons)
+        {
+            ImGuiLTable::Checkbox("Instanced icons", &icons->instanced);
+        }
+
+        if (entities.empty())
+        {
+            ImGuiLTable::SliderInt("Entities", &count, 1000, 1000000);
+
+            if (ImGuiLTable::Button("10k"))
+                count = 10000;
+            if (ImGuiLTable::Button("50k"))
+                count = 50000;
+            if (ImGuiLTable::Button("200k"))
+                count = 200000;
+
+            if (ImGuiLTable::Button("Create"))
+            {
+                baseline_record = app.stats.record;
+
+                std::mt19937 rng(0);
+                std::uniform_real_distribution<double> lon(-180.0, 180.0), lat(-85.0, 85.0);
+
+                entities.reserve(count);
+                for (int i = 0; i < count; ++i)
+                {
+                    auto entity = app.entities.create();
+
+                    auto& icon = app.entities.emplace<Icon>(entity);
+                    icon.image = image;
+                    icon.style = IconStyle{ 8, 0.0f };
+
+                    auto& xform = app.entities.emplace<Transform>(entity);
+                    xform.setPosition(GeoPoint(SRS::WGS84, lon(rng), lat(rng), 1000.0));
+
+                    entities.push_back(entity);
+                }
+            }
+        }
+        else
+        {
+            ImGuiLTable::Text("Entities", "%d", (int)entities.size());
+            ImGuiLTable::Text("Record (before)", u8"%lld \x00B5s", (long long)baseline_record.count());
+            ImGuiLTable::Text("Record (now)", u8"%lld \x00B5s", (long long)app.stats.record.count());
+            ImGuiLTable::Text("Update (now)", u8"%lld \x00B5s", (long long)app.stats.update.count());
+
+            // move a share of the icons each frame to exercise the dynamic updates
+            ImGuiLTable::SliderFloat("Moving (%)", &moving_percent, 0.0f, 100.0f, "%.0f");
+            int num_moving = (int)(0.01f * moving_percent * (float)entities.size());
+            std::uniform_int_distribution<std::size_t> pick(0, entities.size() - 1);
+            std::uniform_real_distribution<double> nudge(-0.01, 0.01);
+            for (int i = 0; i < num_moving; ++i)
+            {
+                auto& xform = app.entities.get<Transform>(entities[pick(motion_rng)]);
+                auto p = xform.node->position;
+                p.x += nudge(motion_rng);
+                p.y += nudge(motion_rng);
+                xform.setPosition(p);
+            }
+
+            if (icons && icons->instanced)
+            {
+                auto stats = icons->instancer.stats();
+                ImGuiLTable::Text("Instances", "%d", (int)stats.instances);
+                ImGuiLTable::Text("Draws", "%d", (int)stats.draws);
+                ImGuiLTable::Text("Pages uploaded", "%d", (int)stats.pagesUploaded);
+            }
+
+            if (ImGuiLTable::Button("Remove"))
+            {
+                app.entities.destroy(entities.begin(), entities.end());
+                entities.clear();
+            }
+        }
+
+        ImGuiLTable::End();
+    }
+};
+
+/**
+* Benchmark: creates a large number of labels whose text changes once a
+* second (a tail number and an altitude readout), so you can compare the
+* frame time of per-label text nodes with batched labels. Try 5k and 20k.
+*/
+auto Demo_Stress_Labels = [](Application& app)
+{
+    static std::vector<entt::entity> entities;
+    static int count = 5000;
+    static std::chrono::microseconds baseline_frame(0);
+    static std::chrono::steady_clock::time_point last_text_update;
+    static int tick = 0;
+
+    auto& font = app.instance.runtime().defaultFont;
+    if (!font)
+    {
+        ImGui::TextWrapped("No font available - did you set the ROCKY_DEFAULT_FONT environment variable?");
+        return;
+    }
+
+    LabelSystemNode* labels = nullptr;
+    for (auto& system : app.ecs.systems)
+    {
+        auto label_system = std::dynamic_pointer_cast<LabelSystem>(system);
+        if (label_system)
+            labels = static_cast<LabelSystemNode*>(label_system->getOrCreateNode().get());
+    }
+
+    if (ImGuiLTable::Begin("stress_labels"))
+    {
+        if (labels)
+        {
+            ImGuiLTable::Checkbox("Batched labels", &labels->batched);
+        }
+
+        if (entities.empty())
+        {
+            ImGuiLTable::SliderInt("Labels", &count, 1000, 100000);
+
+            if (ImGuiLTable::Button("5k"))
+                count = 5000;
+            if (ImGuiLTable::Button("20k"))
+                count = 20000;
+
+            if (ImGuiLTable::Button("Create"))
+            {
+                baseline_frame = app.stats.frame;
+
+                std::mt19937 rng(0);
+                std::uniform_real_distribution<double> lon(-180.0, 180.0), lat(-85.0, 85.0);
+
+                entities.reserve(count);
+                for (int i = 0; i < count; ++i)
+                {
+                    auto entity = app.entities.create();
+
+                    auto& label = app.entities.emplace<Label>(entity);
+                    label.text = "N" + std::to_string(10000 + i);
+                    label.style.font = font;
+                    label.style.pointSize = 14.0f;
+
+                    auto& xform = app.entities.emplace<Transform>(entity);
+                    xform.setPosition(GeoPoint(SRS::WGS84, lon(rng), lat(rng), 1000.0));
+
+                    entities.push_back(entity);
+                }
+            }
+        }
+        else
+        {
+            // new text for every label, once a second
+            auto now = std::chrono::steady_clock::now();
+            if (now - last_text_update > std::chrono::seconds(1))
+            {
+                ++tick;
+                for (std::size_t i = 0; i < entities.size(); ++i)
+                {
+                    auto& label = app.entities.get<Label>(entities[i]);
+                    label.text = "N" + std::to_string(10000 + i) + "\nFL" + std::to_string(100 + (i + tick) % 300);
+                    label.dirty();
+                    app.entities.patch<Label>(entities[i]);
+                }
+                last_text_update = now;
+            }
+
+            ImGuiLTable::Text("Labels", "%d", (int)entities.size());
+            ImGuiLTable::Text("Frame (before)", "%.2f ms", 0.001f * (float)baseline_frame.count());
+            ImGuiLTable::Text("Frame (now)", "%.2f ms", 0.001f * (float)app.stats.frame.count());
+            ImGuiLTable::Text("Update (now)", u8"%lld \x00B5s", (long long)app.stats.update.count());
+            ImGuiLTable::Text("Record (now)", u8"%lld \x00B5s", (long long)app.stats.record.count());
+
+            if (labels && labels->batched)
+            {
+                auto stats = labels->batcher.stats();
+                ImGuiLTable::Text("Batched labels", "%d", (int)stats.labels);
+                ImGuiLTable::Text("Draws", "%d", (int)stats.draws);
+                ImGuiLTable::Text("Layouts", "%d", (int)stats.layouts);
+                ImGuiLTable::Text("Pages uploaded", "%d", (int)stats.pagesUploaded);
+            }
+
+            if (ImGuiLTable::Button("Remove"))
+            {
+                app.entities.destroy(entities.begin(), entities.end());
+                entities.clear();
+            }
+        }
+
+        ImGuiLTable::End();
+    }
+};
+
+/**
+* Benchmark: creates a number of live "tracks", dynamic line strings that
+* gain a point every frame and drop their oldest one, so you can watch the
+* cost of streaming vertex updates. Try 1k tracks of 10k points.
+*/
+auto Demo_Stress_Tracks = [](Application& app)
+{
+    struct Track
+    {
+        entt::entity entity;
+        vsg::ref_ptr<LineGeometry> geometry;
+        glm::dvec3 position;
+        glm::dvec3 heading;
+    };
+    static std::vector<Track> tracks;
+    static int count = 1000;
+    static int points = 10000;
+    static bool appending = true;
+    static std::chrono::microseconds baseline_frame(0);
+    static std::mt19937 rng(0);
+
+    // Advance a track along the globe at constant altitude, turning a little each step
+    auto step = [](Track& track, std::mt19937& rng)
+        {
+            std::uniform_real_distribution<double> turn(-0.05, 0.05);
+            auto up = glm::normalize(track.position);
+            auto east = glm::normalize(glm::cross(up, track.heading));
+            track.heading = glm::normalize(track.heading + east * turn(rng));
+            track.heading = glm::normalize(track.heading - up * glm::dot(track.heading, up));
+            track.position = glm::normalize(track.position + track.heading * 500.0) * glm::length(track.position);
+            return vsg::vec3(track.position.x, track.position.y, track.position.z);
+        };
+
+    if (ImGuiLTable::Begin("stress_tracks"))
+    {
+        if (tracks.empty())
+        {
+            ImGuiLTable::SliderInt("Tracks", &count, 100, 5000);
+            ImGuiLTable::SliderInt("Points per track", &points, 100, 20000);
+
+            if (ImGuiLTable::Button("1k x 10k"))
+            {
+                count = 1000;
+                points = 10000;
+            }
+
+            double mb = (double)count * (double)points * 4.0 * (3.0 * sizeof(vsg::vec3) + sizeof(vsg::vec4)) / 1048576.0;
+            ImGuiLTable::Text("Vertex memory", "%.0lf MB", mb);
+
+            if (ImGuiLTable::Button("Create"))
+            {
+                baseline_frame = app.stats.frame;
+
+                auto xform = SRS::WGS84.to(SRS::ECEF);
+                std::uniform_real_distribution<double> lon(-180.0, 180.0), lat(-70.0, 70.0);
+
+                tracks.reserve(count);
+                for (int i = 0; i < count; ++i)
+                {
+                    Track track;
+                    track.entity = app.entities.create();
+
+                    auto& line = app.entities.emplace<Line>(track.entity);
+                    line.style = LineStyle{ { 0.2f, 1.0f, 0.6f, 1.0f }, 2.0f };
+                    track.geometry = line.pushDynamic(points);
+
+                    xform(glm::dvec3(lon(rng), lat(rng), 10000.0), track.position);
+                    track.heading = glm::normalize(glm::cross(glm::normalize(track.position), glm::dvec3(0, 0, 1)));
+
+                    // fill the history
+                    for (int p = 0; p < points; ++p)
+                        track.geometry->push_back(step(track, rng));
+
+                    tracks.push_back(track);
+                }
+            }
+        }
+        else
+        {
+            ImGuiLTable::Checkbox("Append every frame", &appending);
+
+            if (appending)
+            {
+                for (auto& track : tracks)
+                    track.geometry->push_back(step(track, rng));
+            }
+
+            ImGuiLTable::Text("Tracks", "%d", (int)tracks.size());
+            ImGuiLTable::Text("Points per track", "%d", (int)tracks.front().geometry->numVerts());
+            ImGuiLTable::Text("Frame (before)", "%.2f ms", 0.001f * (float)baseline_frame.count());
+            ImGuiLTable::Text("Frame (now)", "%.2f ms", 0.001f * (float)app.stats.frame.count());
+            ImGuiLTable::Text("Record (now)", u8"%lld \x00B5s", (long long)app.stats.record.count());
+
+            if (ImGuiLTable::Button("Remove"))
+            {
+                for (auto& track : tracks)
+                    app.entities.destroy(track.entity);
+                tracks.clear();
+            }
+        }
+
+        ImGuiLTable::End();
+    }
+};
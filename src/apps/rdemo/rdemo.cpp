@@ -38,6 +38,7 @@ using namespace ROCKY_NAMESPACE;
 #include "Demo_Label.h"
 #include "Demo_LineFeatures.h"
 #include "Demo_PolygonFeatures.h"
+#include "Demo_StreamingFeatures.h"
 #include "Demo_MapManipulator.h"
 #include "Demo_Serialization.h"
 #include "Demo_Tethering.h"
@@ -45,6 +46,7 @@ using namespace ROCKY_NAMESPACE;
 #include "Demo_Views.h"
 #include "Demo_RTT.h"
 #include "Demo_Stats.h"
+#include "Demo_Stress.h"
 
 template<class T>
 int layerError(T layer)
@@ -91,7 +93,8 @@ void setup_demos(rocky::Application& app)
         Demo{ "GIS Data", {},
         {
             Demo{ "Polygon features", Demo_PolygonFeatures },
-            Demo{ "Line features", Demo_LineFeatures }
+            Demo{ "Line features", Demo_LineFeatures },
+            Demo{ "Streaming features", Demo_StreamingFeatures }
         } }
     );
 
@@ -113,6 +116,14 @@ void setup_demos(rocky::Application& app)
         Demo{ "Serialization", Demo_Serialization });
     demos.emplace_back(
         Demo{ "Stats", Demo_Stats });
+    demos.emplace_back(
+        Demo{ "Stress test", {},
+        {
+            Demo{ "Icons", Demo_Stress },
+            Demo{ "Labels", Demo_Stress_Labels },
+            Demo{ "Tracks", Demo_Stress_Tracks }
+        } }
+    );
     demos.emplace_back(
         Demo{ "About", Demo_About });
 }
@@ -13,9 +13,11 @@
 */
 
 #include <rocky/Instance.h>
+#include <rocky/DiskCache.h>
 #include <rocky/Version.h>
 #include <rocky/ImageLayer.h>
 #include <rocky/Ephemeris.h>
+#include <rocky/Threading.h>
 
 #include <rocky_vsg/InstanceVSG.h>
 #include <rocky_vsg/MapNode.h>
@@ -83,7 +85,17 @@ int main(int argc, char** argv)
     rocky::Log()->info("Using VSG " VSG_VERSION_STRING " (so " VSG_SOVERSION_STRING ")");
 
     // An LRU cache mainly used for network data fetches.
-    ri.ioOptions().services.contentCache->setCapacity(128);
+    ri.ioOptions().services.contentCache->setCapacity(128 * 1024 * 1024);
+
+    // Optional persistent tile cache. Run twice with the same path to
+    // compare cold and warm start times.
+    std::string cachePath;
+    if (arguments.read("--cache", cachePath))
+    {
+        auto cache = rocky::DiskCache::create(cachePath);
+        ri.ioOptions().services.cache = [cache]() { return cache; };
+        rocky::Log()->info("Using tile cache at " + cachePath);
+    }
 
     // main window
     auto traits = vsg::WindowTraits::create(ROCKY_PROJECT_NAME);
@@ -203,6 +215,9 @@ int main(int argc, char** argv)
     float frames = 0.0f;
     bool measureFrameTime = (rocky::Log()->level() >= rocky::log::level::info);
 
+    // time until the terrain finishes paging in for the first time
+    bool loading = false, loaded = false;
+
     // rendering main loop
     auto start = std::chrono::steady_clock::now();
     while (viewer->advanceToNextFrame())
@@ -224,6 +239,24 @@ int main(int argc, char** argv)
         viewer->present();
 
         frames += 1.0f;
+
+        if (measureFrameTime && !loaded)
+        {
+            unsigned jobs = 0;
+            for (auto& metrics : rocky::util::job_metrics::get())
+                if (metrics) jobs += metrics->pending + metrics->running;
+
+            if (jobs > 0)
+            {
+                loading = true;
+            }
+            else if (loading)
+            {
+                loaded = true;
+                auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+                rocky::Log()->info("Time to first full-resolution frame = " + std::to_string(ms) + " ms");
+            }
+        }
     }
 
     auto end = std::chrono::steady_clock::now();
@@ -239,6 +272,11 @@ int main(int argc, char** argv)
             << std::endl;
         rocky::Log()->info(buf.str());
 
+        auto cache = ri.ioOptions().services.contentCache->stats();
+        rocky::Log()->info("content cache hits = " + std::to_string(cache.hits)
+            + ", misses = " + std::to_string(cache.misses)
+            + ", evictions = " + std::to_string(cache.evictions)
+            + ", MB = " + std::to_string(cache.bytes / (1024 * 1024)));
     }
 
     return 0;
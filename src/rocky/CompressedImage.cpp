@@ -0,0 +1,439 @@
+/**
+ * rocky c++
+ * Copyright 2023 Pelican Mapping
+ * MIT License
+ */
+#include "CompressedImage.h"
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <cstring>
+
+using namespace ROCKY_NAMESPACE;
+
+namespace
+{
+    using uchar = unsigned char;
+
+    struct RGBA { uchar r, g, b, a; };
+
+    inline float square(float x) { return x * x; }
+
+    inline std::uint16_t pack565(float r, float g, float b)
+    {
+        int r5 = std::clamp((int)(r * 31.0f / 255.0f + 0.5f), 0, 31);
+        int g6 = std::clamp((int)(g * 63.0f / 255.0f + 0.5f), 0, 63);
+        int b5 = std::clamp((int)(b * 31.0f / 255.0f + 0.5f), 0, 31);
+        return (std::uint16_t)((r5 << 11) | (g6 << 5) | b5);
+    }
+
+    inline void unpack565(std::uint16_t c, float* out)
+    {
+        int r5 = (c >> 11) & 31, g6 = (c >> 5) & 63, b5 = c & 31;
+        out[0] = (float)((r5 << 3) | (r5 >> 2));
+        out[1] = (float)((g6 << 2) | (g6 >> 4));
+        out[2] = (float)((b5 << 3) | (b5 >> 2));
+    }
+
+    // the four colors a 4-color BC1 block can express
+    inline void palette(std::uint16_t c0, std::uint16_t c1, float p[4][3])
+    {
+        unpack565(c0, p[0]);
+        unpack565(c1, p[1]);
+        for (int i = 0; i < 3; ++i)
+        {
+            p[2][i] = (2.0f * p[0][i] + p[1][i]) / 3.0f;
+            p[3][i] = (p[0][i] + 2.0f * p[1][i]) / 3.0f;
+        }
+    }
+
+    // choose the closest palette entry for each pixel; returns the total squared error
+    float assignIndices(const float px[16][3], std::uint16_t c0, std::uint16_t c1, uchar indices[16])
+    {
+        float p[4][3];
+        palette(c0, c1, p);
+
+        float total = 0.0f;
+        for (int i = 0; i < 16; ++i)
+        {
+            float best = FLT_MAX;
+            for (uchar j = 0; j < 4; ++j)
+            {
+                float e = square(px[i][0] - p[j][0]) + square(px[i][1] - p[j][1]) + square(px[i][2] - p[j][2]);
+                if (e < best)
+                    best = e, indices[i] = j;
+            }
+            total += best;
+        }
+        return total;
+    }
+
+    // encodes the color half of a block (8 bytes)
+    void encodeColor(const RGBA block[16], float quality, uchar* out)
+    {
+        float px[16][3];
+        float mean[3] = { 0, 0, 0 };
+        float lo[3] = { 255, 255, 255 }, hi[3] = { 0, 0, 0 };
+        for (int i = 0; i < 16; ++i)
+        {
+            px[i][0] = block[i].r, px[i][1] = block[i].g, px[i][2] = block[i].b;
+            for (int c = 0; c < 3; ++c)
+            {
+                mean[c] += px[i][c] / 16.0f;
+                lo[c] = std::min(lo[c], px[i][c]);
+                hi[c] = std::max(hi[c], px[i][c]);
+            }
+        }
+
+        // covariance of the block's colors
+        float cov[6] = { 0, 0, 0, 0, 0, 0 }; // rr rg rb gg gb bb
+        for (int i = 0; i < 16; ++i)
+        {
+            float r = px[i][0] - mean[0], g = px[i][1] - mean[1], b = px[i][2] - mean[2];
+            cov[0] += r * r, cov[1] += r * g, cov[2] += r * b;
+            cov[3] += g * g, cov[4] += g * b, cov[5] += b * b;
+        }
+
+        float e0[3], e1[3];
+
+        if (quality < 0.25f)
+        {
+            // fast: the diagonal of the bounding box that best follows the
+            // colors' correlation, inset a little to reduce rounding error.
+            for (int c = 0; c < 3; ++c)
+            {
+                float inset = (hi[c] - lo[c]) / 16.0f;
+                e0[c] = hi[c] - inset;
+                e1[c] = lo[c] + inset;
+            }
+            if (cov[1] < 0.0f) std::swap(e0[0], e1[0]);
+            if (cov[4] < 0.0f) std::swap(e0[2], e1[2]);
+        }
+        else
+        {
+            // principal axis of the colors, by power iteration
+            float axis[3] = { hi[0] - lo[0], hi[1] - lo[1], hi[2] - lo[2] };
+            for (int k = 0; k < 8; ++k)
+            {
+                float x = cov[0] * axis[0] + cov[1] * axis[1] + cov[2] * axis[2];
+                float y = cov[1] * axis[0] + cov[3] * axis[1] + cov[4] * axis[2];
+                float z = cov[2] * axis[0] + cov[4] * axis[1] + cov[5] * axis[2];
+                float len = std::max({ std::fabs(x), std::fabs(y), std::fabs(z) });
+                if (len <= 0.0f)
+                    break;
+                axis[0] = x / len, axis[1] = y / len, axis[2] = z / len;
+            }
+
+            float len2 = axis[0] * axis[0] + axis[1] * axis[1] + axis[2] * axis[2];
+            float tmin = 0.0f, tmax = 0.0f;
+            if (len2 > 0.0f)
+            {
+                tmin = FLT_MAX, tmax = -FLT_MAX;
+                for (int i = 0; i < 16; ++i)
+                {
+                    float t = ((px[i][0] - mean[0]) * axis[0] + (px[i][1] - mean[1]) * axis[1] + (px[i][2] - mean[2]) * axis[2]) / len2;
+                    tmin = std::min(tmin, t);
+                    tmax = std::max(tmax, t);
+                }
+            }
+            for (int c = 0; c < 3; ++c)
+            {
+                e0[c] = std::clamp(mean[c] + axis[c] * tmax, 0.0f, 255.0f);
+                e1[c] = std::clamp(mean[c] + axis[c] * tmin, 0.0f, 255.0f);
+            }
+        }
+
+        std::uint16_t c0 = pack565(e0[0], e0[1], e0[2]);
+        std::uint16_t c1 = pack565(e1[0], e1[1], e1[2]);
+        uchar indices[16];
+        float error = assignIndices(px, c0, c1, indices);
+
+        // refine: least-squares fit of the endpoints to the chosen indices
+        static const float weight[4] = { 1.0f, 0.0f, 2.0f / 3.0f, 1.0f / 3.0f };
+        int iterations = (int)(std::clamp(quality, 0.0f, 1.0f) * 3.0f + 0.5f);
+        for (int k = 0; k < iterations && error > 0.0f; ++k)
+        {
+            float aa = 0, ab = 0, bb = 0;
+            float ax[3] = { 0, 0, 0 }, bx[3] = { 0, 0, 0 };
+            for (int i = 0; i < 16; ++i)
+            {
+                float a = weight[indices[i]], b = 1.0f - a;
+                aa += a * a, ab += a * b, bb += b * b;
+                for (int c = 0; c < 3; ++c)
+                    ax[c] += a * px[i][c], bx[c] += b * px[i][c];
+            }
+
+            float det = aa * bb - ab * ab;
+            if (std::fabs(det) < 1e-6f)
+                break;
+
+            for (int c = 0; c < 3; ++c)
+            {
+                e0[c] = std::clamp((ax[c] * bb - bx[c] * ab) / det, 0.0f, 255.0f);
+                e1[c] = std::clamp((bx[c] * aa - ax[c] * ab) / det, 0.0f, 255.0f);
+            }
+
+            std::uint16_t n0 = pack565(e0[0], e0[1], e0[2]);
+            std::uint16_t n1 = pack565(e1[0], e1[1], e1[2]);
+            uchar n_indices[16];
+            float n_error = assignIndices(px, n0, n1, n_indices);
+            if (n_error >= error)
+                break;
+
+            c0 = n0, c1 = n1, error = n_error;
+            std::memcpy(indices, n_indices, 16);
+        }
+
+        // 4-color mode requires c0 > c1
+        if (c0 < c1)
+        {
+            static const uchar swapped[4] = { 1, 0, 3, 2 };
+            std::swap(c0, c1);
+            for (auto& i : indices)
+                i = swapped[i];
+        }
+        else if (c0 == c1)
+        {
+            std::memset(indices, 0, 16);
+        }
+
+        std::uint32_t bits = 0;
+        for (int i = 0; i < 16; ++i)
+            bits |= (std::uint32_t)indices[i] << (2 * i);
+
+        out[0] = c0 & 0xff, out[1] = c0 >> 8;
+        out[2] = c1 & 0xff, out[3] = c1 >> 8;
+        for (int i = 0; i < 4; ++i)
+            out[4 + i] = (bits >> (8 * i)) & 0xff;
+    }
+
+    // encodes the BC3 alpha half of a block (8 bytes)
+    void encodeAlpha(const RGBA block[16], uchar* out)
+    {
+        uchar a0 = 0, a1 = 255;
+        for (int i = 0; i < 16; ++i)
+        {
+            a0 = std::max(a0, block[i].a);
+            a1 = std::min(a1, block[i].a);
+        }
+
+        std::uint64_t bits = 0;
+        if (a0 > a1)
+        {
+            // 8-value mode: a0, a1, then six interpolated values
+            float p[8] = { (float)a0, (float)a1 };
+            for (int k = 1; k <= 6; ++k)
+                p[k + 1] = ((7 - k) * (float)a0 + k * (float)a1) / 7.0f;
+
+            for (int i = 0; i < 16; ++i)
+            {
+                std::uint64_t best_index = 0;
+                float best = FLT_MAX;
+                for (int j = 0; j < 8; ++j)
+                {
+                    float e = std::fabs((float)block[i].a - p[j]);
+                    if (e < best)
+                        best = e, best_index = j;
+                }
+                bits |= best_index << (3 * i);
+            }
+        }
+
+        out[0] = a0, out[1] = a1;
+        for (int i = 0; i < 6; ++i)
+            out[2 + i] = (bits >> (8 * i)) & 0xff;
+    }
+
+    // box-filters a level down to half size
+    std::vector<RGBA> downsample(const std::vector<RGBA>& in, unsigned w, unsigned h)
+    {
+        std::vector<RGBA> out((w / 2) * (h / 2));
+        for (unsigned t = 0; t < h / 2; ++t)
+        {
+            for (unsigned s = 0; s < w / 2; ++s)
+            {
+                auto& p00 = in[(2 * t) * w + 2 * s];
+                auto& p10 = in[(2 * t) * w + 2 * s + 1];
+                auto& p01 = in[(2 * t + 1) * w + 2 * s];
+                auto& p11 = in[(2 * t + 1) * w + 2 * s + 1];
+                out[t * (w / 2) + s] = {
+                    (uchar)((p00.r + p10.r + p01.r + p11.r + 2) / 4),
+                    (uchar)((p00.g + p10.g + p01.g + p11.g + 2) / 4),
+                    (uchar)((p00.b + p10.b + p01.b + p11.b + 2) / 4),
+                    (uchar)((p00.a + p10.a + p01.a + p11.a + 2) / 4) };
+            }
+        }
+        return out;
+    }
+}
+
+shared_ptr<CompressedImage>
+CompressedImage::compress(const Image& image, float quality, bool mipmaps)
+{
+    if (!image.valid() || image.depth() != 1)
+        return nullptr;
+
+    if (image.pixelFormat() != Image::R8G8B8_UNORM && image.pixelFormat() != Image::R8G8B8A8_UNORM)
+        return nullptr;
+
+    unsigned w = image.width(), h = image.height();
+    if (w % 4 != 0 || h % 4 != 0)
+        return nullptr;
+
+    // read the source into 8-bit RGBA
+    std::vector<RGBA> level(w * h);
+    std::vector<Image::Pixel> row(w);
+    bool opaque = true;
+    for (unsigned t = 0; t < h; ++t)
+    {
+        image.readSpan(row.data(), 0, t, w);
+        for (unsigned s = 0; s < w; ++s)
+        {
+            auto& p = level[t * w + s];
+            p.r = (uchar)(std::clamp(row[s].r, 0.0f, 1.0f) * 255.0f + 0.5f);
+            p.g = (uchar)(std::clamp(row[s].g, 0.0f, 1.0f) * 255.0f + 0.5f);
+            p.b = (uchar)(std::clamp(row[s].b, 0.0f, 1.0f) * 255.0f + 0.5f);
+            p.a = image.hasAlphaChannel() ? (uchar)(std::clamp(row[s].a, 0.0f, 1.0f) * 255.0f + 0.5f) : 255;
+            opaque = opaque && p.a == 255;
+        }
+    }
+
+    auto result = CompressedImage::create();
+    result->_format = opaque ? BC1 : BC3;
+    result->_width = w;
+    result->_height = h;
+
+    // count the levels first so we can allocate once. Stop while every
+    // level is still a whole number of blocks.
+    unsigned levels = 1;
+    if (mipmaps)
+    {
+        while ((w >> (levels - 1)) % 8 == 0 && (h >> (levels - 1)) % 8 == 0)
+            ++levels;
+    }
+
+    std::size_t size = 0;
+    for (unsigned i = 0; i < levels; ++i)
+    {
+        result->_offsets.push_back(size);
+        size += result->levelSize(i);
+    }
+    result->_data.resize(size);
+
+    RGBA block[16];
+    for (unsigned i = 0; i < levels; ++i)
+    {
+        unsigned lw = result->levelWidth(i), lh = result->levelHeight(i);
+        uchar* out = result->_data.data() + result->_offsets[i];
+
+        for (unsigned bt = 0; bt < lh; bt += 4)
+        {
+            for (unsigned bs = 0; bs < lw; bs += 4)
+            {
+                for (unsigned y = 0; y < 4; ++y)
+                    for (unsigned x = 0; x < 4; ++x)
+                        block[y * 4 + x] = level[(bt + y) * lw + bs + x];
+
+                if (result->_format == BC3)
+                {
+                    encodeAlpha(block, out);
+                    out += 8;
+                }
+
+                encodeColor(block, quality, out);
+                out += 8;
+            }
+        }
+
+        if (i + 1 < levels)
+            level = downsample(level, lw, lh);
+    }
+
+    return result;
+}
+
+shared_ptr<Image>
+CompressedImage::decompress(unsigned level) const
+{
+    ROCKY_SOFT_ASSERT_AND_RETURN(level < numLevels(), nullptr);
+
+    unsigned w = levelWidth(level), h = levelHeight(level);
+    auto image = Image::create(Image::R8G8B8A8_UNORM, w, h);
+    uchar* pixels = image->data<uchar>();
+    const uchar* in = _data.data() + _offsets[level];
+
+    for (unsigned bt = 0; bt < h; bt += 4)
+    {
+        for (unsigned bs = 0; bs < w; bs += 4)
+        {
+            uchar alpha[16];
+            std::memset(alpha, 255, 16);
+
+            if (_format == BC3)
+            {
+                float a0 = in[0], a1 = in[1];
+                float p[8] = { a0, a1 };
+                if (a0 > a1)
+                {
+                    for (int k = 1; k <= 6; ++k)
+                        p[k + 1] = ((7 - k) * a0 + k * a1) / 7.0f;
+                }
+                else
+                {
+                    for (int k = 1; k <= 4; ++k)
+                        p[k + 1] = ((5 - k) * a0 + k * a1) / 5.0f;
+                    p[6] = 0.0f, p[7] = 255.0f;
+                }
+
+                std::uint64_t bits = 0;
+                for (int i = 0; i < 6; ++i)
+                    bits |= (std::uint64_t)in[2 + i] << (8 * i);
+                for (int i = 0; i < 16; ++i)
+                    alpha[i] = (uchar)(p[(bits >> (3 * i)) & 7] + 0.5f);
+
+                in += 8;
+            }
+
+            std::uint16_t c0 = in[0] | (in[1] << 8);
+            std::uint16_t c1 = in[2] | (in[3] << 8);
+            std::uint32_t bits = in[4] | (in[5] << 8) | (in[6] << 16) | ((std::uint32_t)in[7] << 24);
+            in += 8;
+
+            float p[4][3];
+            palette(c0, c1, p);
+
+            // BC1 with c0 <= c1 is 3-color mode with transparent black
+            bool three_color = _format == BC1 && c0 <= c1;
+            if (three_color)
+            {
+                for (int c = 0; c < 3; ++c)
+                    p[2][c] = (p[0][c] + p[1][c]) / 2.0f, p[3][c] = 0.0f;
+            }
+
+            for (unsigned y = 0; y < 4; ++y)
+            {
+                for (unsigned x = 0; x < 4; ++x)
+                {
+                    unsigned i = y * 4 + x;
+                    unsigned index = (bits >> (2 * i)) & 3;
+                    uchar* out = pixels + ((bt + y) * w + bs + x) * 4;
+                    out[0] = (uchar)(p[index][0] + 0.5f);
+                    out[1] = (uchar)(p[index][1] + 0.5f);
+                    out[2] = (uchar)(p[index][2] + 0.5f);
+                    out[3] = (three_color && index == 3) ? 0 : alpha[i];
+                }
+            }
+        }
+    }
+
+    return image;
+}
+
+std::size_t
+CompressedImage::uncompressedSize() const
+{
+    std::size_t size = 0;
+    for (unsigned i = 0; i < numLevels(); ++i)
+        size += (std::size_t)levelWidth(i) * levelHeight(i) * 4;
+    return size;
+}
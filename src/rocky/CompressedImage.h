@@ -0,0 +1,92 @@
+/**
+ * rocky c++
+ * Copyright 2023 Pelican Mapping
+ * MIT License
+ */
+#pragma once
+
+#include <rocky/Image.h>
+#include <cstdint>
+#include <vector>
+
+namespace ROCKY_NAMESPACE
+{
+    /**
+     * An image encoded in a GPU block-compressed texture format,
+     * along with its mipmaps.
+     *
+     * BC1 stores opaque color in 8 bytes per 4x4 block (8:1 versus RGBA).
+     * BC3 adds an 8-byte alpha block (4:1). GPUs sample both natively,
+     * so textures stay compressed in GPU memory.
+     */
+    class ROCKY_EXPORT CompressedImage : public Inherit<Object, CompressedImage>
+    {
+    public:
+        enum Format {
+            BC1, // RGB, 8 bytes per block
+            BC3  // RGBA, 16 bytes per block
+        };
+
+        //! Encodes an image. Uses BC3 if the image has any transparent
+        //! pixels, BC1 otherwise.
+        //! @param image Source image; must be R8G8B8_UNORM or R8G8B8A8_UNORM,
+        //!   with a width and height that are multiples of 4
+        //! @param quality Encoder effort, 0 (fastest) to 1 (best)
+        //! @param mipmaps Whether to generate and encode mipmap levels
+        //! @return Compressed image, or nullptr if the image is not eligible
+        static shared_ptr<CompressedImage> compress(
+            const Image& image,
+            float quality = 0.5f,
+            bool mipmaps = true);
+
+        //! Decodes one level back to an R8G8B8A8_UNORM image
+        shared_ptr<Image> decompress(unsigned level = 0) const;
+
+        //! Block format
+        Format format() const { return _format; }
+
+        //! Width of the base level in pixels
+        unsigned width() const { return _width; }
+
+        //! Height of the base level in pixels
+        unsigned height() const { return _height; }
+
+        //! Number of levels, including the base level
+        unsigned numLevels() const { return (unsigned)_offsets.size(); }
+
+        //! Size of each 4x4 block in bytes
+        unsigned blockSize() const { return _format == BC1 ? 8 : 16; }
+
+        //! Width of a level in pixels
+        unsigned levelWidth(unsigned level) const { return _width >> level; }
+
+        //! Height of a level in pixels
+        unsigned levelHeight(unsigned level) const { return _height >> level; }
+
+        //! Offset of a level within data()
+        std::size_t levelOffset(unsigned level) const { return _offsets[level]; }
+
+        //! Size of a level in bytes
+        std::size_t levelSize(unsigned level) const {
+            return (levelWidth(level) / 4) * (levelHeight(level) / 4) * blockSize();
+        }
+
+        //! Encoded blocks of every level, base level first, rows of blocks
+        //! top to bottom in the same row order as the source image.
+        const std::vector<std::uint8_t>& data() const { return _data; }
+
+        //! Size in bytes of the same levels stored as uncompressed RGBA
+        std::size_t uncompressedSize() const;
+
+    public:
+        //! Construct an empty image; use compress() instead
+        CompressedImage() = default;
+
+    private:
+        Format _format = BC1;
+        unsigned _width = 0u;
+        unsigned _height = 0u;
+        std::vector<std::size_t> _offsets;
+        std::vector<std::uint8_t> _data;
+    };
+}
@@ -0,0 +1,252 @@
+/**
+ * rocky c++
+ * Copyright 2023 Pelican Mapping
+ * MIT License
+ */
+#include "DiskCache.h"
+#include "Utils.h"
+
+#include <filesystem>
+#include <fstream>
+#include <algorithm>
+#include <thread>
+
+using namespace ROCKY_NAMESPACE;
+using namespace ROCKY_NAMESPACE::util;
+
+#define LC "[DiskCache] "
+
+namespace
+{
+    // every record file starts with this tag followed by the write time
+    const char RECORD_MAGIC[4] = { 'R', 'K', 'C', '1' };
+
+    const std::string TEMP_EXTENSION = ".tmp";
+}
+
+DiskCache::DiskCache(const std::string& rootPath, unsigned maxSizeMB) :
+    _rootPath(rootPath),
+    _maxSize((std::uint64_t)maxSizeMB * 1024u * 1024u)
+{
+    std::error_code ec;
+    std::filesystem::create_directories(_rootPath, ec);
+    if (ec)
+    {
+        Log()->warn(LC "Cannot create cache folder " + _rootPath + " : " + ec.message());
+    }
+
+    scan();
+}
+
+void
+DiskCache::setMaxSize(std::uint64_t bytes)
+{
+    std::scoped_lock lock(_mutex);
+    _maxSize = bytes;
+    evict();
+}
+
+std::uint64_t
+DiskCache::size() const
+{
+    std::scoped_lock lock(_mutex);
+    return _size;
+}
+
+std::size_t
+DiskCache::count() const
+{
+    std::scoped_lock lock(_mutex);
+    return _entries.size();
+}
+
+std::string
+DiskCache::relativePath(const std::string& bin, const std::string& key) const
+{
+    return makeCacheKey(key, toLegalFileName(bin));
+}
+
+void
+DiskCache::scan()
+{
+    namespace fs = std::filesystem;
+
+    struct Found {
+        std::string path;
+        std::uint64_t size;
+        fs::file_time_type time;
+    };
+    std::vector<Found> found;
+
+    std::error_code ec;
+    for (auto i = fs::recursive_directory_iterator(_rootPath, ec); !ec && i != fs::recursive_directory_iterator(); i.increment(ec))
+    {
+        if (!i->is_regular_file(ec))
+            continue;
+
+        // leftovers from an interrupted write:
+        if (i->path().extension() == TEMP_EXTENSION)
+        {
+            fs::remove(i->path(), ec);
+            continue;
+        }
+
+        found.push_back({
+            fs::relative(i->path(), _rootPath, ec).generic_string(),
+            (std::uint64_t)i->file_size(ec),
+            i->last_write_time(ec) });
+    }
+
+    // oldest first, so the most recently written records are the last to go
+    std::sort(found.begin(), found.end(),
+        [](const Found& lhs, const Found& rhs) { return lhs.time < rhs.time; });
+
+    std::scoped_lock lock(_mutex);
+    for (auto& f : found)
+    {
+        auto& entry = _entries[f.path];
+        entry.size = f.size;
+        entry.lru = _lru.insert(_lru.end(), f.path);
+        _size += f.size;
+    }
+
+    evict();
+}
+
+void
+DiskCache::evict()
+{
+    std::error_code ec;
+    while (_size > _maxSize && !_lru.empty())
+    {
+        auto iter = _entries.find(_lru.front());
+        if (iter != _entries.end())
+        {
+            // an open reader may keep the file alive on some platforms;
+            // the next scan will pick it up if the removal fails.
+            std::filesystem::remove(std::filesystem::path(_rootPath) / iter->first, ec);
+            _size -= iter->second.size;
+            _entries.erase(iter);
+        }
+        _lru.pop_front();
+    }
+}
+
+Result<Cache::Record>
+DiskCache::read(const std::string& bin, const std::string& key) const
+{
+    auto rel = relativePath(bin, key);
+
+    std::ifstream in(std::filesystem::path(_rootPath) / rel, std::ios::binary);
+    if (!in.is_open())
+    {
+        return Status(Status::ResourceUnavailable);
+    }
+
+    char magic[4];
+    std::int64_t timestamp = 0;
+    in.read(magic, sizeof(magic));
+    in.read(reinterpret_cast<char*>(&timestamp), sizeof(timestamp));
+    if (!in.good() || !std::equal(magic, magic + 4, RECORD_MAGIC))
+    {
+        return Status(Status::ResourceUnavailable, "Corrupt cache record");
+    }
+
+    Record record;
+    record.lastModified = (TimeStamp)timestamp;
+    record.data.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+
+    // mark as recently used
+    {
+        std::scoped_lock lock(_mutex);
+        auto iter = _entries.find(rel);
+        if (iter != _entries.end())
+        {
+            _lru.splice(_lru.end(), _lru, iter->second.lru);
+        }
+    }
+
+    return record;
+}
+
+Status
+DiskCache::write(const std::string& bin, const std::string& key, const std::string& data)
+{
+    namespace fs = std::filesystem;
+
+    auto rel = relativePath(bin, key);
+    auto path = fs::path(_rootPath) / rel;
+
+    std::error_code ec;
+    fs::create_directories(path.parent_path(), ec);
+
+    // write to a unique temporary file and then move it into place, so that
+    // a concurrent reader never sees a partially written record.
+    auto temp = path;
+    temp += "." + std::to_string(std::hash<std::thread::id>()(std::this_thread::get_id())) + TEMP_EXTENSION;
+    {
+        std::ofstream out(temp, std::ios::binary | std::ios::trunc);
+        if (!out.is_open())
+        {
+            return Status(Status::ResourceUnavailable, "Cannot write to cache folder " + _rootPath);
+        }
+
+        std::int64_t timestamp = (std::int64_t)DateTime().asTimeStamp();
+        out.write(RECORD_MAGIC, sizeof(RECORD_MAGIC));
+        out.write(reinterpret_cast<const char*>(&timestamp), sizeof(timestamp));
+        out.write(data.data(), data.size());
+        if (!out.good())
+        {
+            out.close();
+            fs::remove(temp, ec);
+            return Status(Status::ResourceUnavailable, "Failed to write cache record");
+        }
+    }
+
+    fs::rename(temp, path, ec);
+    if (ec)
+    {
+        fs::remove(temp, ec);
+        return Status(Status::ResourceUnavailable, "Failed to commit cache record");
+    }
+
+    std::uint64_t size = sizeof(RECORD_MAGIC) + sizeof(std::int64_t) + data.size();
+
+    std::scoped_lock lock(_mutex);
+    auto iter = _entries.find(rel);
+    if (iter != _entries.end())
+    {
+        _size -= iter->second.size;
+        iter->second.size = size;
+        _lru.splice(_lru.end(), _lru, iter->second.lru);
+    }
+    else
+    {
+        auto& entry = _entries[rel];
+        entry.size = size;
+        entry.lru = _lru.insert(_lru.end(), rel);
+    }
+    _size += size;
+
+    evict();
+
+    return StatusOK;
+}
+
+void
+DiskCache::remove(const std::string& bin, const std::string& key)
+{
+    auto rel = relativePath(bin, key);
+
+    std::scoped_lock lock(_mutex);
+    std::error_code ec;
+    std::filesystem::remove(std::filesystem::path(_rootPath) / rel, ec);
+
+    auto iter = _entries.find(rel);
+    if (iter != _entries.end())
+    {
+        _size -= iter->second.size;
+        _lru.erase(iter->second.lru);
+        _entries.erase(iter);
+    }
+}
@@ -0,0 +1,92 @@
+/**
+ * rocky c++
+ * Copyright 2023 Pelican Mapping
+ * MIT License
+ */
+#pragma once
+
+#include <rocky/IOTypes.h>
+#include <atomic>
+#include <list>
+#include <mutex>
+#include <unordered_map>
+
+namespace ROCKY_NAMESPACE
+{
+    /**
+     * Persistent cache that stores each record in its own file under a root folder.
+     *
+     * Records are written to a temporary file and then renamed into place, so
+     * readers never see a partial record and do not need to lock anything
+     * beyond a brief update of the usage index. The total size of all records
+     * is bounded; when a write exceeds the budget, the least-recently-used
+     * records are evicted. Recency is tracked in memory and restored
+     * (approximately) from file times when the cache is reopened.
+     *
+     * Usage:
+     *   auto cache = DiskCache::create("/path/to/cache", 2048);
+     *   instance.ioOptions().services.cache = [cache]() { return cache; };
+     */
+    class ROCKY_EXPORT DiskCache : public Inherit<Cache, DiskCache>
+    {
+    public:
+        //! Open (or create) a cache in a folder.
+        //! @param rootPath Folder in which to store records
+        //! @param maxSizeMB Maximum total size of all records, in megabytes
+        DiskCache(const std::string& rootPath, unsigned maxSizeMB = 1024u);
+
+        //! Folder in which records are stored
+        const std::string& rootPath() const { return _rootPath; }
+
+        //! Maximum total size of all records in bytes; exceeding it evicts
+        //! the least recently used records.
+        void setMaxSize(std::uint64_t bytes);
+        std::uint64_t maxSize() const { return _maxSize; }
+
+        //! Total size of all records in bytes
+        std::uint64_t size() const;
+
+        //! Number of records in the cache
+        std::size_t count() const;
+
+    public: // Cache
+
+        Result<Record> read(
+            const std::string& bin,
+            const std::string& key) const override;
+
+        Status write(
+            const std::string& bin,
+            const std::string& key,
+            const std::string& data) override;
+
+        void remove(
+            const std::string& bin,
+            const std::string& key) override;
+
+    private:
+        struct Entry
+        {
+            std::uint64_t size = 0;
+            std::list<std::string>::iterator lru;
+        };
+
+        std::string _rootPath;
+        std::atomic<std::uint64_t> _maxSize;
+
+        // index of records, keyed by path relative to the root
+        mutable std::mutex _mutex;
+        mutable std::list<std::string> _lru; // front is least recently used
+        std::unordered_map<std::string, Entry> _entries;
+        std::uint64_t _size = 0;
+
+        //! Relative path of the record file for a bin and key
+        std::string relativePath(const std::string& bin, const std::string& key) const;
+
+        //! Build the index from the files already on disk
+        void scan();
+
+        //! Remove records until the cache fits its budget; call with _mutex locked
+        void evict();
+    };
+}
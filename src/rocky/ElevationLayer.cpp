@@ -343,7 +343,7 @@ ElevationLayer::createHeightfield(const TileKey& key) const
 Result<GeoHeightfield>
 ElevationLayer::createHeightfield(
     const TileKey& key,
-    const IOOptions& io) const
+    const IOOptions& in_io) const
 {    
     // If the layer is disabled, bail out
     if (!isOpen())
@@ -351,7 +351,43 @@ ElevationLayer::createHeightfield(
         return Result(GeoHeightfield::INVALID);
     }
 
-    return createHeightfieldInKeyProfile(key, io);
+    // identify this layer to shared services like the content cache
+    IOOptions io(in_io);
+    io.property("layer") = name().value();
+
+    // Check the cache first; a fresh record short-circuits the source.
+    bool cacheOnly = effectiveCachePolicy().isCacheOnly();
+    bool expired = false;
+    shared_ptr<Heightfield> cached;
+    auto cachedImage = readCachedImage(key, expired, io);
+    if (cachedImage && cachedImage->pixelFormat() == Image::R32_SFLOAT)
+    {
+        cached = Heightfield::create(cachedImage.get());
+    }
+
+    if (cached && (!expired || cacheOnly))
+    {
+        return GeoHeightfield(cached, key.extent());
+    }
+
+    if (cacheOnly)
+    {
+        return Result(GeoHeightfield::INVALID);
+    }
+
+    auto result = createHeightfieldInKeyProfile(key, io);
+
+    if (result.status.ok() && result.value.valid())
+    {
+        writeCachedImage(key, result.value.heightfield().get(), io);
+    }
+    else if (cached)
+    {
+        // the source failed, but an expired record beats nothing
+        return GeoHeightfield(cached, key.extent());
+    }
+
+    return result;
 }
 
 Result<GeoHeightfield>
@@ -646,10 +682,6 @@ ElevationLayerVector::populateHeightfield(
 
     unsigned int total = numColumns * numRows;
 
-    int nodataCount = 0;
-
-    TileKey actualKey; // Storage if a new key needs to be constructed
-
     bool requiresResample = true;
 
     // If we only have a single contender layer, and the tile is the same size as the requested
@@ -690,180 +722,190 @@ ElevationLayerVector::populateHeightfield(
     // If we need to mosaic multiple layers or resample it to a new output tilesize go through a resampling loop.
     if (requiresResample)
     {
-        // We will load the actual heightfields on demand. We might not need them all.
-        std::vector<GeoHeightfield> heightfields(contenders.size());
-        std::vector<TileKey> heightfieldActualKeys(contenders.size());
-        std::vector<GeoHeightfield> offsetfields(offsets.size());
-        std::vector<bool> heightFallback(contenders.size(), false);
-        std::vector<bool> heightFailed(contenders.size(), false);
-        std::vector<bool> offsetFailed(offsets.size(), false);
-
-        // Initialize the actual keys to match the contender keys.
-        // We'll adjust these as necessary if we need to fall back
-        for(unsigned i=0; i<contenders.size(); ++i)
+        // Build the grid of sample points once, in the key's SRS (row-major,
+        // matching the heightfield layout).
+        std::vector<glm::dvec3> grid(total);
+        for (unsigned r = 0; r < numRows; ++r)
         {
-            heightfieldActualKeys[i] = contenders[i].key;
+            double y = ymin + (dy * (double)r);
+            for (unsigned c = 0; c < numColumns; ++c)
+            {
+                grid[r * numColumns + c] = glm::dvec3(xmin + (dx * (double)c), y, 0.0);
+            }
         }
 
-        // The maximum number of heightfields to keep in this local cache
-        const unsigned maxHeightfields = 50;
-        unsigned numHeightfieldsInCache = 0;
+        // The grid transformed into each source SRS we encounter. Layers almost
+        // always share an SRS, so this usually holds a single entry and every
+        // point is transformed exactly once per tile.
+        struct TransformedGrid
+        {
+            SRS srs;
+            SRSOperation xform;
+            std::vector<glm::dvec3> points;
+        };
+        std::vector<TransformedGrid> grids;
 
-        for (unsigned c = 0; c < numColumns; ++c)
+        auto gridFor = [&](const SRS& srs) -> const TransformedGrid&
         {
-            double x = xmin + (dx * (double)c);
+            for (auto& g : grids)
+                if (g.srs == srs)
+                    return g;
+
+            TransformedGrid g;
+            g.srs = srs;
+            g.points = grid;
+            if (srs != keySRS)
+            {
+                g.xform = keySRS.to(srs);
+                if (g.xform.valid())
+                    g.xform.transformArray(g.points.data(), g.points.size());
+            }
+            grids.emplace_back(std::move(g));
+            return grids.back();
+        };
+
+        // Samples a layer heightfield at every grid point and returns the subset
+        // of "wanted" points that produced data, with heights transformed back
+        // into the key's SRS.
+        std::vector<float> samples(total);
+        std::vector<unsigned> hits;
+        std::vector<glm::dvec3> scratch;
+
+        auto sample = [&](const GeoHeightfield& layerHF, const std::vector<unsigned>& wanted, bool skipZero)
+        {
+            auto& g = gridFor(layerHF.srs());
+            layerHF.heightsAtLocations(g.points.data(), total, samples.data(), interpolation);
 
-            // periodically check for cancelation
-            if (io.canceled())
+            hits.clear();
+            for (auto p : wanted)
             {
-                return false;
+                if (samples[p] != NO_DATA_VALUE && !(skipZero && equiv(samples[p], 0.0f)))
+                    hits.push_back(p);
             }
 
-            for (unsigned r = 0; r < numRows; ++r)
+            // transform the heights back into the key's vertical datum:
+            if (g.xform.valid() && !hits.empty())
             {
-                double y = ymin + (dy * (double)r);
+                scratch.resize(hits.size());
+                for (unsigned k = 0; k < hits.size(); ++k)
+                    scratch[k] = glm::dvec3(g.points[hits[k]].x, g.points[hits[k]].y, samples[hits[k]]);
 
-                // Collect elevations from each layer as necessary.
-                int resolvedIndex = -1;
+                g.xform.inverseArray(scratch.data(), scratch.size());
 
-                float resolution = FLT_MAX;
+                for (unsigned k = 0; k < hits.size(); ++k)
+                    samples[hits[k]] = (float)scratch[k].z;
+            }
+        };
 
-                glm::fvec3 normal_sum(0, 0, 0);
+        float* heights = hf->data<float>();
+        std::vector<int> resolvedIndex(total, -1);
+        std::vector<float> resolution(total, FLT_MAX);
 
-                for (int i = 0; i < contenders.size() && resolvedIndex < 0; ++i)
-                {
-                    ElevationLayer* layer = contenders[i].layer.get();
-                    TileKey& contenderKey = contenders[i].key;
-                    int index = contenders[i].index;
+        // points still waiting for a value, in grid order
+        std::vector<unsigned> unresolved(total);
+        for (unsigned p = 0; p < total; ++p)
+            unresolved[p] = p;
 
-                    if (heightFailed[i])
-                        continue;
+        // Contenders are in priority order; each one fills in whatever the
+        // higher-priority layers left empty. A layer's heightfield is fetched
+        // once and stays live for the whole tile.
+        for (unsigned i = 0; i < contenders.size() && !unresolved.empty(); ++i)
+        {
+            if (io.canceled())
+            {
+                return false;
+            }
 
-                    GeoHeightfield& layerHF = heightfields[i];
-                    TileKey& actualKey = heightfieldActualKeys[i];
+            ElevationLayer* layer = contenders[i].layer.get();
+            TileKey actualKey = contenders[i].key;
 
-                    if (!layerHF.valid())
-                    {
-                        // We couldn't get the heightfield from the cache, so try to create it.
-                        // We also fallback on parent layers to make sure that we have data at the location even if it's fallback.
-                        while (!layerHF.valid() && actualKey.valid() && layer->isKeyInLegalRange(actualKey))
-                        {
-                            layerHF = layer->createHeightfield(actualKey, io).value;
-                            if (!layerHF.valid())
-                            {
-                                actualKey.makeParent();
-                            }
-                        }
-
-                        // Mark this layer as fallback if necessary.
-                        if (layerHF.valid())
-                        {
-                            //TODO: check this. Should it be actualKey != keyToUse...?
-                            heightFallback[i] =
-                                contenders[i].isFallback ||
-                                (actualKey != contenderKey);
-
-                            numHeightfieldsInCache++;
-                        }
-                        else
-                        {
-                            heightFailed[i] = true;
-                            continue;
-                        }
-                    }
+            // Fall back on parent keys to make sure that we have data at the
+            // location even if it's fallback.
+            GeoHeightfield layerHF;
+            while (!layerHF.valid() && actualKey.valid() && layer->isKeyInLegalRange(actualKey))
+            {
+                layerHF = layer->createHeightfield(actualKey, io).value;
+                if (!layerHF.valid())
+                {
+                    actualKey.makeParent();
+                }
+            }
 
-                    if (layerHF.valid())
-                    {
-                        bool isFallback = heightFallback[i];
-
-                        // We only have real data if this is not a fallback heightfield.
-                        if (!isFallback)
-                        {
-                            realData = true;
-                        }
-
-                        //TODO: optimize by using SRSOperation variant
-                        float elevation = layerHF.heightAt(x, y, keySRS, interpolation);
-                        if (elevation != NO_DATA_VALUE)
-                        {
-                            // remember the index so we can only apply offset layers that
-                            // sit on TOP of this layer.
-                            resolvedIndex = index;
-
-                            hf->write(glm::fvec4(elevation), c, r);
-
-                            resolution = actualKey.getResolutionForTileSize(hf->width()).second;
-                        }
-                        else
-                        {
-                            ++nodataCount;
-                        }
-                    }
+            if (!layerHF.valid())
+                continue;
 
+            // We only have real data if this is not a fallback heightfield.
+            //TODO: check this. Should it be actualKey != keyToUse...?
+            if (!contenders[i].isFallback && actualKey == contenders[i].key)
+            {
+                realData = true;
+            }
 
-                    // Clear the heightfield cache if we have too many heightfields in the cache.
-                    if (numHeightfieldsInCache >= maxHeightfields)
-                    {
-                        //OE_NOTICE << "Clearing cache" << std::endl;
-                        for (unsigned int k = 0; k < heightfields.size(); k++)
-                        {
-                            heightfields[k] = GeoHeightfield::INVALID;
-                            heightFallback[k] = false;
-                        }
-                        numHeightfieldsInCache = 0;
-                    }
-                }
+            sample(layerHF, unresolved, false);
 
-                for (int i = offsets.size() - 1; i >= 0; --i)
-                {
-                    if (io.canceled())
-                        return false;
+            float layerResolution = actualKey.getResolutionForTileSize(hf->width()).second;
+            for (auto p : hits)
+            {
+                heights[p] = samples[p];
+                resolvedIndex[p] = contenders[i].index;
+                resolution[p] = layerResolution;
+            }
+
+            // compact the unresolved list:
+            unsigned n = 0;
+            for (auto p : unresolved)
+            {
+                if (resolvedIndex[p] < 0)
+                    unresolved[n++] = p;
+            }
+            unresolved.resize(n);
+        }
 
-                    // Only apply an offset layer if it sits on top of the resolved layer
-                    // (or if there was no resolved layer).
-                    if (resolvedIndex >= 0 && offsets[i].index < resolvedIndex)
-                        continue;
+        std::vector<unsigned> wanted;
+        wanted.reserve(total);
 
-                    TileKey& contenderKey = offsets[i].key;
+        for (int i = offsets.size() - 1; i >= 0; --i)
+        {
+            if (io.canceled())
+                return false;
 
-                    if (offsetFailed[i] == true)
-                        continue;
+            // Only apply an offset layer where it sits on top of the resolved layer
+            // (or where there was no resolved layer).
+            wanted.clear();
+            for (unsigned p = 0; p < total; ++p)
+            {
+                if (resolvedIndex[p] < 0 || offsets[i].index >= resolvedIndex[p])
+                    wanted.push_back(p);
+            }
 
-                    GeoHeightfield& layerHF = offsetfields[i];
-                    if (!layerHF.valid())
-                    {
-                        ElevationLayer* offset = offsets[i].layer.get();
-
-                        layerHF = offset->createHeightfield(contenderKey, io).value;
-                        if (!layerHF.valid())
-                        {
-                            offsetFailed[i] = true;
-                            continue;
-                        }
-                    }
+            if (wanted.empty())
+                continue;
 
-                    // If we actually got a layer then we have real data
-                    realData = true;
+            TileKey& contenderKey = offsets[i].key;
 
-                    float elevation = layerHF.heightAt(x, y, keySRS, interpolation);
-                    if (elevation != NO_DATA_VALUE && !equiv(elevation, 0.0f))
-                    {
-                        hf->heightAt(c, r) += elevation;
+            auto layerHF = offsets[i].layer->createHeightfield(contenderKey, io).value;
+            if (!layerHF.valid())
+                continue;
 
-                        // Technically this is correct, but the resultin normal maps
-                        // look awful and faceted.
-                        resolution = std::min(
-                            resolution,
-                            (float)contenderKey.getResolutionForTileSize(hf->width()).second);
-                    }
-                }
+            // If we actually got a layer then we have real data
+            realData = true;
 
-                if (resolutions)
-                {
-                    (*resolutions)[r*numColumns+c] = resolution;
-                }
+            sample(layerHF, wanted, true);
+
+            // Technically this is correct, but the resultin normal maps
+            // look awful and faceted.
+            float offsetResolution = contenderKey.getResolutionForTileSize(hf->width()).second;
+            for (auto p : hits)
+            {
+                heights[p] += samples[p];
+                resolution[p] = std::min(resolution[p], offsetResolution);
             }
         }
+
+        if (resolutions)
+        {
+            std::copy(resolution.begin(), resolution.end(), resolutions->begin());
+        }
     }
 
     // Resolve any invalid heights in the output heightfield.
@@ -83,6 +83,90 @@ GeoHeightfield::heightAtLocation(
     }
 }
 
+void
+GeoHeightfield::heightsAtLocations(
+    const glm::dvec3* points,
+    std::size_t count,
+    float* out,
+    Image::Interpolation interpolation) const
+{
+    ROCKY_SOFT_ASSERT_AND_RETURN(valid(), void());
+
+    const int width = (int)_hf->width();
+    const int height = (int)_hf->height();
+
+    // First pass: convert locations to pixel coordinates, flagging the ones
+    // that fall outside the extent with a negative column.
+    std::vector<double> cols(count), rows(count);
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        if (_extent.contains(points[i].x, points[i].y))
+        {
+            cols[i] = clamp((points[i].x - _extent.xmin()) / _resolution.x, 0.0, (double)(width - 1));
+            rows[i] = clamp((points[i].y - _extent.ymin()) / _resolution.y, 0.0, (double)(height - 1));
+        }
+        else
+        {
+            cols[i] = -1.0;
+        }
+    }
+
+    if (interpolation != Image::BILINEAR)
+    {
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            out[i] = cols[i] >= 0.0 ?
+                _hf->heightAtPixel(cols[i], rows[i], interpolation) :
+                NO_DATA_VALUE;
+        }
+        return;
+    }
+
+    // Second pass: bilinear kernel over the raw samples. Equivalent to
+    // Heightfield::heightAtPixel(BILINEAR) but without the per-sample
+    // call overhead and branching on exact/edge cases.
+    const float* data = _hf->data<float>();
+
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        double c = cols[i], r = rows[i];
+        if (c < 0.0)
+        {
+            out[i] = NO_DATA_VALUE;
+            continue;
+        }
+
+        int c0 = (int)c, r0 = (int)r;
+        double fx = c - (double)c0, fy = r - (double)r0;
+        int c1 = fx > 0.0 ? c0 + 1 : c0;
+        int r1 = fy > 0.0 ? r0 + 1 : r0;
+
+        float ll = data[r0 * width + c0];
+        float lr = data[r0 * width + c1];
+        float ul = data[r1 * width + c0];
+        float ur = data[r1 * width + c1];
+
+        if (ll == NO_DATA_VALUE || lr == NO_DATA_VALUE || ul == NO_DATA_VALUE || ur == NO_DATA_VALUE)
+        {
+            // substitute a valid neighbor for any missing samples
+            float valid = ur != NO_DATA_VALUE ? ur : ll != NO_DATA_VALUE ? ll : ul != NO_DATA_VALUE ? ul : lr;
+            if (valid == NO_DATA_VALUE)
+            {
+                out[i] = NO_DATA_VALUE;
+                continue;
+            }
+            if (ll == NO_DATA_VALUE) ll = valid;
+            if (lr == NO_DATA_VALUE) lr = valid;
+            if (ul == NO_DATA_VALUE) ul = valid;
+            if (ur == NO_DATA_VALUE) ur = valid;
+        }
+
+        double bottom = (1.0 - fx) * (double)ll + fx * (double)lr;
+        double top = (1.0 - fx) * (double)ul + fx * (double)ur;
+        out[i] = (float)((1.0 - fy) * bottom + fy * top);
+    }
+}
+
 float
 GeoHeightfield::heightAt(double x, double y, const SRSOperation& xform, Image::Interpolation interp) const
 {
@@ -105,6 +105,18 @@ namespace ROCKY_NAMESPACE
             double x, double y,
             Image::Interpolation interp = Image::BILINEAR) const;
 
+        //! Gets the heights at many geographic locations (in this object's SRS)
+        //! at once. Much faster than calling heightAtLocation in a loop.
+        //! @param points Array of locations; only x and y are used
+        //! @param count Number of locations
+        //! @param out Output array of count heights (NO_DATA_VALUE where there is no data)
+        //! @param interp Interpolation method
+        void heightsAtLocations(
+            const glm::dvec3* points,
+            std::size_t count,
+            float* out,
+            Image::Interpolation interp = Image::BILINEAR) const;
+
         // Functor to GeoHeightField's by resolution
         struct SortByResolutionFunctor
         {
@@ -273,7 +273,8 @@ namespace
         double in_xmin, double in_ymin,
         double in_xmax, double in_ymax,
         double* x, double* y,
-        unsigned int numx, unsigned int numy)
+        unsigned int numx, unsigned int numy,
+        double tolerance)
     {
         ROCKY_SOFT_ASSERT_AND_RETURN(fromSRS.valid() && toSRS.valid(), false);
 
@@ -282,25 +283,24 @@ namespace
             return false;
 
         std::vector<glm::dvec3> points;
+        points.reserve(numx * numy);
 
         const double dx = (in_xmax - in_xmin) / (numx - 1);
         const double dy = (in_ymax - in_ymin) / (numy - 1);
 
-        unsigned int pixel = 0;
-        double fc = 0.0;
-        for (unsigned int c = 0; c < numx; ++c, ++fc)
+        // row-major, so callers can process the output one image row at a time
+        for (unsigned int r = 0; r < numy; ++r)
         {
-            const double dest_x = in_xmin + fc * dx;
-            double fr = 0.0;
-            for (unsigned int r = 0; r < numy; ++r, ++fr)
+            const double dest_y = in_ymin + (double)r * dy;
+            for (unsigned int c = 0; c < numx; ++c)
             {
-                const double dest_y = in_ymin + fr * dy;
+                const double dest_x = in_xmin + (double)c * dx;
                 points.emplace_back(dest_x, dest_y, 0);
-                pixel++;
             }
         }
 
-        if (xform.transformRange(points.begin(), points.end()))
+        xform.setGridErrorTolerance(tolerance);
+        if (xform.transformGrid(points.data(), numx, numy))
         {
             for (unsigned i = 0; i < points.size(); ++i)
             {
@@ -357,120 +357,82 @@ namespace
         double *srcPointsX = new double[numPixels * 2];
         double *srcPointsY = srcPointsX + numPixels;
 
+        // an eighth of a source pixel is visually indistinguishable from exact
+        const double tolerance = 0.125 * std::min(
+            src_extent.width() / (double)image->width(),
+            src_extent.height() / (double)image->height());
+
         transformGrid(
             dest_extent.srs(),
             src_extent.srs(),
             dest_extent.xMin() + .5 * dx, dest_extent.yMin() + .5 * dy,
             dest_extent.xMax() - .5 * dx, dest_extent.yMax() - .5 * dy,
-            srcPointsX, srcPointsY, width, height);
-
-        //ImageUtils::PixelReader ia(image);
-        Image::Pixel color;
-        Image::Pixel urColor;
-        Image::Pixel llColor;
-        Image::Pixel ulColor;
-        Image::Pixel lrColor;
+            srcPointsX, srcPointsY, width, height,
+            tolerance);
 
         double xfac = (image->width() - 1) / src_extent.width();
         double yfac = (image->height() - 1) / src_extent.height();
 
+        // normalized sample coordinate for read_bilinear(); a source that is
+        // only one pixel across has nothing to interpolate, so sample its center
+        auto normalize = [](float p, unsigned size) {
+            return size > 1 ? p / (float)(size - 1) : 0.5f;
+        };
+
+        // per-row working sets, so we can read and write whole spans at a time
+        std::vector<Image::Pixel> row(width);
+        std::vector<float> u(width), v(width);
+        std::vector<unsigned> cols(width);
+        std::vector<Image::Pixel> samples(width);
+
         for (auto depth = 0u; depth < image->depth(); depth++)
         {
             // Next, go through the source-SRS sample grid, read the color at each point from the source image,
             // and write it to the corresponding pixel in the destination image.
-            int pixel = 0;
-            double xfac = (image->width() - 1) / src_extent.width();
-            double yfac = (image->height() - 1) / src_extent.height();
-            for (unsigned int c = 0; c < width; ++c)
+            for (unsigned int r = 0; r < height; ++r)
             {
-                for (unsigned int r = 0; r < height; ++r)
+                std::fill(row.begin(), row.end(), Image::Pixel(0, 0, 0, 0));
+                unsigned count = 0;
+
+                for (unsigned int c = 0; c < width; ++c)
                 {
+                    unsigned pixel = r * width + c;
                     double src_x = srcPointsX[pixel];
                     double src_y = srcPointsY[pixel];
 
                     if (src_x < src_extent.xMin() || src_x > src_extent.xMax() || src_y < src_extent.yMin() || src_y > src_extent.yMax())
                     {
-                        //If the sample point is outside of the bound of the source extent, increment the pixel and keep looping through.
-                        //ROCKY_WARN << LC << "ERROR: sample point out of bounds: " << src_x << ", " << src_y << std::endl;
-                        pixel++;
+                        //If the sample point is outside of the bound of the source extent, leave it transparent.
                         continue;
                     }
 
                     float px = (src_x - src_extent.xMin()) * xfac;
                     float py = (src_y - src_extent.yMin()) * yfac;
 
-                    int px_i = clamp((int)round(px), 0, (int)image->width() - 1);
-                    int py_i = clamp((int)round(py), 0, (int)image->height() - 1);
-
-                    color = { 0,0,0,0 };
-
                     // TODO: consider this again later. Causes blockiness.
                     if (!interpolate) //! isSrcContiguous ) // non-contiguous space- use nearest neighbot
                     {
-                        image->read(color, px_i, py_i, depth);
-                        //ia(color, px_i, py_i, depth);
+                        int px_i = clamp((int)round(px), 0, (int)image->width() - 1);
+                        int py_i = clamp((int)round(py), 0, (int)image->height() - 1);
+                        image->read(row[c], px_i, py_i, depth);
                     }
-
                     else // contiguous space - use bilinear sampling
                     {
-                        int rowMin = std::max((int)floor(py), 0);
-                        int rowMax = std::max(std::min((int)ceil(py), (int)(image->height() - 1)), 0);
-                        int colMin = std::max((int)floor(px), 0);
-                        int colMax = std::max(std::min((int)ceil(px), (int)(image->width() - 1)), 0);
-
-                        if (rowMin > rowMax) rowMin = rowMax;
-                        if (colMin > colMax) colMin = colMax;
-
-                        image->read(urColor, colMax, rowMax, depth);
-                        image->read(llColor, colMin, rowMin, depth);
-                        image->read(ulColor, colMin, rowMax, depth);
-                        image->read(lrColor, colMax, rowMin, depth);
-
-                        /*Bilinear interpolation*/
-                        //Check for exact value
-                        if ((colMax == colMin) && (rowMax == rowMin))
-                        {
-                            //ROCKY_NOTICE << "[rocky::GeoData] Exact value" << std::endl;
-                            image->read(color, px_i, py_i, depth);
-                        }
-                        else if (colMax == colMin)
-                        {
-                            //ROCKY_NOTICE << "[rocky::GeoData] Vertically" << std::endl;
-                            //Linear interpolate vertically
-                            for (unsigned int i = 0; i < 4; ++i)
-                            {
-                                color[i] = ((float)rowMax - py) * llColor[i] + (py - (float)rowMin) * ulColor[i];
-                            }
-                        }
-                        else if (rowMax == rowMin)
-                        {
-                            //ROCKY_NOTICE << "[rocky::GeoData] Horizontally" << std::endl;
-                            //Linear interpolate horizontally
-                            for (unsigned int i = 0; i < 4; ++i)
-                            {
-                                color[i] = ((float)colMax - px) * llColor[i] + (px - (float)colMin) * lrColor[i];
-                            }
-                        }
-                        else
-                        {
-                            //ROCKY_NOTICE << "[rocky::GeoData] Bilinear" << std::endl;
-                            //Bilinear interpolate
-                            float col1 = colMax - px, col2 = px - colMin;
-                            float row1 = rowMax - py, row2 = py - rowMin;
-                            for (unsigned int i = 0; i < 4; ++i)
-                            {
-                                float r1 = col1 * llColor[i] + col2 * lrColor[i];
-                                float r2 = col1 * ulColor[i] + col2 * urColor[i];
-
-                                //ROCKY_INFO << "r1, r2 = " << r1 << " , " << r2 << std::endl;
-                                color[i] = row1 * r1 + row2 * r2;
-                            }
-                        }
+                        cols[count] = c;
+                        u[count] = normalize(px, image->width());
+                        v[count] = normalize(py, image->height());
+                        ++count;
                     }
+                }
 
-                    result->write(color, c, r, depth);
-                    pixel++;
+                if (count > 0)
+                {
+                    image->read_bilinear(samples.data(), u.data(), v.data(), count, depth);
+                    for (unsigned i = 0; i < count; ++i)
+                        row[cols[i]] = samples[i];
                 }
+
+                result->writeSpan(row.data(), 0, r, width, depth);
             }
         }
 
@@ -701,10 +663,6 @@ GeoImage::reproject(
 
     bool reproject_with_gdal = false;
 
-#ifndef GDAL_FOUND
-    reproject_with_gdal = image()->depth() == 1;
-#endif
-
 
     //if (srs().isUserDefined() || to_srs.isUserDefined() || getImage()->depth() > 1)
     if (reproject_with_gdal == false)
@@ -742,14 +700,26 @@ GeoImage::reproject(
 void
 GeoImage::composite(const std::vector<GeoImage>& sources)
 {
+    ROCKY_SOFT_ASSERT_AND_RETURN(valid(), void());
+
+    // one transform per source instead of one per pixel
+    std::vector<SRSOperation> xforms;
+    for (auto& source : sources)
+        xforms.emplace_back(source.srs().to(srs()));
+
     double x, y;
     glm::fvec4 pixel;
-    for (unsigned t = 0; t < _image->width(); ++t)
+    std::vector<glm::fvec4> row(_image->width());
+
+    for (unsigned t = 0; t < _image->height(); ++t)
     {
-        for(unsigned s = 0; s < _image->height(); ++s)
+        // read the existing row
+        _image->readSpan(row.data(), 0, t, _image->width());
+        bool dirty = false;
+
+        for (unsigned s = 0; s < _image->width(); ++s)
         {
-            // read the existing pixel
-            _image->read(pixel, s, t);
+            pixel = row[s];
 
             // see if we need to overwrite it
             if ((_image->hasAlphaChannel() && pixel.a < 1.0f) ||
@@ -759,18 +729,25 @@ GeoImage::composite(const std::vector<GeoImage>& sources)
                 for (int i = (int)sources.size() - 1; i >= 0; --i)
                 {
                     auto& source = sources[i];
-                    source.read(pixel, x, y, srs());
+                    if (xforms[i].valid())
+                        source.read(pixel, x, y, xforms[i]);
 
                     if ((i == 0) ||
                         (source.image()->hasAlphaChannel() && pixel.a > 0.5f) ||
                         (pixel.r > 0.05f || pixel.g > 0.05f || pixel.b > 0.05f))
                     {
-                        _image->write(pixel, s, t);
+                        row[s] = pixel;
+                        dirty = true;
                         break;
                     }
                 }
             }
         }
+
+        if (dirty)
+        {
+            _image->writeSpan(row.data(), 0, t, _image->width());
+        }
     }
 }
 
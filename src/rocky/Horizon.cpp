@@ -157,6 +157,80 @@ Horizon::isVisible(double x, double y, double z, double radius) const
     return false;
 }
 
+bool
+Horizon::isCullingPointVisible(const glm::dvec3& cullingPoint) const
+{
+    if (_valid == false)
+        return true;
+
+    // Viewer-to-target vector in unit space. The point is occluded if it lies
+    // behind the horizon plane and inside the horizon cone.
+    glm::dvec3 VT = cullingPoint * _scale + _VC;
+    double VTdotVC = glm::dot(VT, _VC);
+
+    return !(
+        VTdotVC > _VHmag2 &&
+        (VTdotVC * VTdotVC) / glm::dot(VT, VT) > _VHmag2);
+}
+
+bool
+Horizon::computeCullingPoint(
+    const Ellipsoid& em,
+    const glm::dvec3* points,
+    unsigned count,
+    glm::dvec3& out)
+{
+    if (points == nullptr || count == 0)
+        return false;
+
+    glm::dvec3 scale(
+        1.0 / em.semiMajorAxis(),
+        1.0 / em.semiMajorAxis(),
+        1.0 / em.semiMinorAxis());
+
+    // The culling point lies along the direction to the points' centroid
+    // (in unit space).
+    glm::dvec3 direction(0, 0, 0);
+    for (unsigned i = 0; i < count; ++i)
+        direction += points[i] * scale;
+
+    if (glm::length(direction) <= 0.0)
+        return false;
+
+    direction = glm::normalize(direction);
+
+    // For each point, find how far along that direction we must go so that
+    // the culling point is hidden whenever the point is; keep the farthest.
+    double maxMag = 0.0;
+    for (unsigned i = 0; i < count; ++i)
+    {
+        glm::dvec3 P = points[i] * scale;
+        double mag2 = glm::dot(P, P);
+
+        // allow for roundoff on points that sit right on the surface
+        if (mag2 < 1.0 - 1e-9)
+            return false;
+
+        glm::dvec3 Pdir = P / sqrt(mag2);
+        mag2 = std::max(mag2, 1.0);
+        double mag = sqrt(mag2);
+
+        double cosAlpha = glm::dot(Pdir, direction);
+        double sinAlpha = glm::length(glm::cross(Pdir, direction));
+        double cosBeta = 1.0 / mag;
+        double sinBeta = sqrt(mag2 - 1.0) * cosBeta;
+
+        double denom = cosAlpha * cosBeta - sinAlpha * sinBeta;
+        if (denom <= 0.0)
+            return false;
+
+        maxMag = std::max(maxMag, 1.0 / denom);
+    }
+
+    out = direction * maxMag / scale;
+    return true;
+}
+
 #if 0
 bool
 Horizon::getPlane(osg::Plane& out_plane) const
@@ -45,6 +45,27 @@ namespace ROCKY_NAMESPACE
         //! @return true if the point is visible
         bool isVisible(double x, double y, double z, double radius = 0.0) const;
 
+        //! Whether a culling point (see computeCullingPoint) is visible over
+        //! the horizon. One test covers the entire set of points it represents.
+        //! @param cullingPoint Culling point in geocentric coordinates
+        //! @return true if any of the points it represents may be visible
+        bool isCullingPointVisible(const glm::dvec3& cullingPoint) const;
+
+        //! Computes a single point that is occluded by the horizon only when
+        //! all of the input points are occluded, for any eye position.
+        //! ref: https://cesium.com/blog/2013/05/09/computing-the-horizon-occlusion-point/
+        //! @param ellipsoid Ellipsoid that defines the horizon
+        //! @param points Points in geocentric coordinates, all above the ellipsoid
+        //! @param count Number of points
+        //! @param out_cullingPoint Output culling point in geocentric coordinates
+        //! @return false if no such point exists (for example, the points
+        //!     span too much of the ellipsoid or lie below its surface)
+        static bool computeCullingPoint(
+            const Ellipsoid& ellipsoid,
+            const glm::dvec3* points,
+            unsigned count,
+            glm::dvec3& out_cullingPoint);
+
         //! Sets the output variable to the horizon plane plane with its
         //! normal pointing at the eye.
         // bool getPlane(osg::Plane& out_plane) const;
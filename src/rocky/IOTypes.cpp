@@ -158,3 +158,196 @@ Services::Services() :
     //nop
 }
 
+
+ContentCache::ContentCache(std::size_t maxBytes, unsigned numShards) :
+    _capacity(maxBytes)
+{
+    _shards.resize(std::max(1u, numShards));
+    for (auto& shard : _shards)
+        shard = std::make_unique<Shard>();
+}
+
+ContentCache::Shard&
+ContentCache::shard(const std::string& key) const
+{
+    return *_shards[std::hash<std::string>()(key) % _shards.size()];
+}
+
+std::size_t
+ContentCache::shardCapacity() const
+{
+    return _capacity / _shards.size();
+}
+
+void
+ContentCache::setCapacity(std::size_t maxBytes)
+{
+    _capacity = maxBytes;
+
+    auto budget = shardCapacity();
+    for (auto& shard : _shards)
+    {
+        std::scoped_lock lock(shard->mutex);
+        evict(*shard, budget);
+    }
+    trim(nullptr);
+}
+
+void
+ContentCache::evictLRU(Shard& shard)
+{
+    auto& entry = shard.lru.front();
+    auto& stats = shard.stats[entry.bin];
+    stats.bytes -= entry.size;
+    --stats.entries;
+    ++stats.evictions;
+    shard.bytes -= entry.size;
+    _bytes -= entry.size;
+    shard.index.erase(entry.key);
+    shard.lru.pop_front();
+}
+
+void
+ContentCache::evict(Shard& shard, std::size_t budget)
+{
+    // a shard always keeps its newest entry, even one bigger than its
+    // share of the capacity; trim() takes the difference out of the others
+    while (shard.bytes > budget && shard.lru.size() > 1)
+        evictLRU(shard);
+}
+
+void
+ContentCache::trim(const Shard* skip)
+{
+    for (unsigned n = 0; n < _shards.size() && _bytes > _capacity; ++n)
+    {
+        auto& shard = *_shards[_trimCursor++ % _shards.size()];
+        if (&shard == skip)
+            continue;
+
+        std::scoped_lock lock(shard.mutex);
+        while (_bytes > _capacity && !shard.lru.empty())
+            evictLRU(shard);
+    }
+}
+
+Result<Content>
+ContentCache::get(const std::string& key, const std::string& bin)
+{
+    if (_capacity == 0)
+        return Result<Content>();
+
+    auto& shard = this->shard(key);
+    std::scoped_lock lock(shard.mutex);
+
+    auto i = shard.index.find(key);
+    if (i == shard.index.end())
+    {
+        ++shard.stats[bin].misses;
+        return Result<Content>();
+    }
+
+    ++shard.stats[bin].hits;
+    shard.lru.splice(shard.lru.end(), shard.lru, i->second);
+    return i->second->content;
+}
+
+void
+ContentCache::put(const std::string& key, const Content& value, const std::string& bin)
+{
+    auto budget = shardCapacity();
+    auto size = key.size() + value.contentType.size() + value.data.size() + sizeof(Entry);
+
+    // content bigger than the whole cache can't be kept
+    if (size > _capacity)
+        return;
+
+    auto& shard = this->shard(key);
+    {
+        std::scoped_lock lock(shard.mutex);
+
+        auto i = shard.index.find(key);
+        if (i != shard.index.end())
+        {
+            auto& old = *i->second;
+            auto& stats = shard.stats[old.bin];
+            stats.bytes -= old.size;
+            --stats.entries;
+            shard.bytes -= old.size;
+            _bytes -= old.size;
+            shard.lru.erase(i->second);
+            shard.index.erase(i);
+        }
+
+        shard.lru.push_back(Entry{ key, value, bin, size });
+        shard.index[key] = std::prev(shard.lru.end());
+        shard.bytes += size;
+        _bytes += size;
+
+        auto& stats = shard.stats[bin];
+        stats.bytes += size;
+        ++stats.entries;
+
+        evict(shard, budget);
+    }
+
+    if (_bytes > _capacity)
+        trim(&shard);
+}
+
+void
+ContentCache::clear()
+{
+    for (auto& shard : _shards)
+    {
+        std::scoped_lock lock(shard->mutex);
+        shard->lru.clear();
+        shard->index.clear();
+        shard->stats.clear();
+        _bytes -= shard->bytes;
+        shard->bytes = 0;
+    }
+}
+
+std::unordered_map<std::string, ContentCache::Stats>
+ContentCache::statsPerBin() const
+{
+    std::unordered_map<std::string, Stats> result;
+    for (auto& shard : _shards)
+    {
+        std::scoped_lock lock(shard->mutex);
+        for (auto& [bin, stats] : shard->stats)
+        {
+            auto& total = result[bin];
+            total.hits += stats.hits;
+            total.misses += stats.misses;
+            total.evictions += stats.evictions;
+            total.bytes += stats.bytes;
+            total.entries += stats.entries;
+        }
+    }
+    return result;
+}
+
+ContentCache::Stats
+ContentCache::stats() const
+{
+    Stats total;
+    for (auto& [bin, stats] : statsPerBin())
+    {
+        total.hits += stats.hits;
+        total.misses += stats.misses;
+        total.evictions += stats.evictions;
+        total.bytes += stats.bytes;
+        total.entries += stats.entries;
+    }
+    return total;
+}
+
+float
+ContentCache::hitRatio() const
+{
+    auto s = stats();
+    auto lookups = s.hits + s.misses;
+    return lookups > 0 ? (float)s.hits / (float)lookups : 0.0f;
+}
@@ -9,6 +9,11 @@
 #include <rocky/Log.h>
 #include <rocky/Status.h>
 #include <rocky/Units.h>
+#include <atomic>
+#include <list>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
 
 /**
  * A collection of types used by the various I/O systems.
@@ -26,9 +31,37 @@ namespace ROCKY_NAMESPACE
         virtual bool canceled() const = 0;
     };
 
-    //! Base class for a cache
-    class Cache : public Inherit<Object, Cache>
+    /**
+     * Interface for a persistent cache of binary records.
+     * Records are grouped into bins (typically one per layer) and addressed
+     * by a string key within the bin. Implementations must be safe to call
+     * from multiple threads at once.
+     */
+    class ROCKY_EXPORT Cache : public Inherit<Object, Cache>
     {
+    public:
+        //! A record read from the cache
+        struct Record
+        {
+            std::string data;
+            TimeStamp lastModified = 0;
+        };
+
+        //! Read a record. The status is ResourceUnavailable if there is no record.
+        virtual Result<Record> read(
+            const std::string& bin,
+            const std::string& key) const = 0;
+
+        //! Write a record, replacing any existing record with the same key.
+        virtual Status write(
+            const std::string& bin,
+            const std::string& key,
+            const std::string& data) = 0;
+
+        //! Remove a record if it exists.
+        virtual void remove(
+            const std::string& bin,
+            const std::string& key) = 0;
     };
 
     //! Service providing a Log
@@ -45,8 +78,7 @@ namespace ROCKY_NAMESPACE
         Status(shared_ptr<Image> image, std::ostream& stream, std::string contentType, const IOOptions& io)>;
 
     //! Service for caching data
-    using CacheImpl = void*; // todo.
-    using CacheService = std::function<shared_ptr<CacheImpl>()>;
+    using CacheService = std::function<shared_ptr<Cache>()>;
 
     //! Service for accessing other data
     class DataInterface {
@@ -60,7 +92,84 @@ namespace ROCKY_NAMESPACE
         std::string data;
     };
 
-    using ContentCache = util::LRUCache<std::string, Result<Content>>;
+    /**
+     * In-memory cache of recently read content, bounded by total size in bytes.
+     * Entries are spread over independently locked shards so that concurrent
+     * readers rarely contend; each shard evicts its own least recently used
+     * entries first, and content bigger than a shard's share of the capacity
+     * takes its space from the other shards. Usage is tracked in total and per bin, where the bin is usually
+     * the name of the layer that requested the content.
+     */
+    class ROCKY_EXPORT ContentCache
+    {
+    public:
+        //! Usage statistics
+        struct Stats
+        {
+            std::uint64_t hits = 0;
+            std::uint64_t misses = 0;
+            std::uint64_t evictions = 0;
+            std::uint64_t bytes = 0;
+            std::uint64_t entries = 0;
+        };
+
+        //! Construct a cache
+        //! @param maxBytes Maximum total size of all cached content
+        //! @param numShards Number of independently locked partitions
+        ContentCache(std::size_t maxBytes = 64u * 1024u * 1024u, unsigned numShards = 16u);
+
+        //! Maximum total size of all cached content in bytes. Shrinking
+        //! the cache evicts entries immediately; zero disables it.
+        void setCapacity(std::size_t maxBytes);
+        std::size_t capacity() const { return _capacity; }
+
+        //! Fetch content. The status is ResourceUnavailable on a miss.
+        Result<Content> get(const std::string& key, const std::string& bin = {});
+
+        //! Add or replace content
+        void put(const std::string& key, const Content& value, const std::string& bin = {});
+
+        //! Remove all content and reset the statistics
+        void clear();
+
+        //! Statistics across all bins
+        Stats stats() const;
+
+        //! Statistics for each bin
+        std::unordered_map<std::string, Stats> statsPerBin() const;
+
+        //! Fraction of lookups that were hits [0..1]
+        float hitRatio() const;
+
+    private:
+        struct Entry
+        {
+            std::string key;
+            Content content;
+            std::string bin;
+            std::size_t size;
+        };
+
+        struct Shard
+        {
+            mutable std::mutex mutex;
+            std::list<Entry> lru; // front is least recently used
+            std::unordered_map<std::string, std::list<Entry>::iterator> index;
+            std::unordered_map<std::string, Stats> stats;
+            std::size_t bytes = 0;
+        };
+
+        std::atomic<std::size_t> _capacity;
+        std::atomic<std::size_t> _bytes = { 0 };
+        std::atomic_uint _trimCursor = { 0 };
+        std::vector<std::unique_ptr<Shard>> _shards;
+
+        Shard& shard(const std::string& key) const;
+        std::size_t shardCapacity() const;
+        void evictLRU(Shard& shard);
+        void evict(Shard& shard, std::size_t budget);
+        void trim(const Shard* skip);
+    };
 
     class ROCKY_EXPORT Services
     {
@@ -70,7 +179,7 @@ namespace ROCKY_NAMESPACE
         ReadImageStreamService readImageFromStream;
         WriteImageStreamService writeImageToStream;
         CacheService cache;
-        shared_ptr<ContentCache> contentCache = std::make_shared<ContentCache>(128);
+        shared_ptr<ContentCache> contentCache = std::make_shared<ContentCache>();
     };
 
     // User options passed along with an IO context.
@@ -5,6 +5,16 @@
  */
 #include "Image.h"
 
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define ROCKY_SIMD_AVX2
+#endif
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define ROCKY_SIMD_SSE2
+#endif
+
 using namespace ROCKY_NAMESPACE;
 
 namespace
@@ -17,7 +27,7 @@ namespace
 
     template<typename T>
     struct NORM8 {
-        static void read(Image::Pixel& pixel, unsigned char* ptr, int n) {
+        static void read(Image::Pixel& pixel, const unsigned char* ptr, int n) {
             for (int i = 0; i < n; ++i)
                 pixel[i] = (float)(*ptr++) * denorm_8;
             for (int i = n; i < 4; ++i)
@@ -34,8 +44,8 @@ namespace
 
     template<typename T>
     struct NORM16 {
-        static void read(Image::Pixel& pixel, unsigned char* ptr, int n) {
-            T* sptr = (T*)ptr;
+        static void read(Image::Pixel& pixel, const unsigned char* ptr, int n) {
+            const T* sptr = (const T*)ptr;
             for (int i = 0; i < n; ++i)
                 pixel[i] = (float)(*sptr++) * denorm_16;
         }
@@ -48,8 +58,8 @@ namespace
 
     template<typename T>
     struct FLOAT {
-        static void read(Image::Pixel& pixel, unsigned char* ptr, int n) {
-            T* sptr = (T*)ptr;
+        static void read(Image::Pixel& pixel, const unsigned char* ptr, int n) {
+            const T* sptr = (const T*)ptr;
             for (int i = 0; i < n; ++i)
                 pixel[i] = (float)(*sptr++);
         }
@@ -59,18 +69,132 @@ namespace
                 *sptr++ = (T)pixel[i];
         }
     };
+
+    // Span and block kernels. The component count and pixel size are
+    // compile-time constants, so the codec inlines into a tight loop the
+    // compiler can unroll and vectorize, and callers pay for one dispatch
+    // per span instead of one per pixel.
+    template<class CODEC, int N, int BPP>
+    struct SPAN {
+        static void read(Image::Pixel* pixels, const unsigned char* ptr, unsigned count) {
+            for (unsigned i = 0; i < count; ++i, ptr += BPP)
+                CODEC::read(pixels[i], ptr, N);
+        }
+        static void write(const Image::Pixel* pixels, unsigned char* ptr, unsigned count) {
+            for (unsigned i = 0; i < count; ++i, ptr += BPP)
+                CODEC::write(pixels[i], ptr, N);
+        }
+        static void read_bilinear(Image::Pixel* pixels, const float* u, const float* v, unsigned count,
+            const unsigned char* data, unsigned width, unsigned height)
+        {
+            const float sizeS = (float)(width - 1);
+            const float sizeT = (float)(height - 1);
+
+            for (unsigned i = 0; i < count; ++i)
+            {
+                float s = clamp(u[i], 0.0f, 1.0f) * sizeS;
+                float s0 = std::max(std::floor(s), 0.0f);
+                float s1 = std::min(s0 + 1.0f, sizeS);
+                float smix = s0 < s1 ? (s - s0) / (s1 - s0) : 0.0f;
+
+                float t = clamp(v[i], 0.0f, 1.0f) * sizeT;
+                float t0 = std::max(std::floor(t), 0.0f);
+                float t1 = std::min(t0 + 1.0f, sizeT);
+                float tmix = t0 < t1 ? (t - t0) / (t1 - t0) : 0.0f;
+
+                const unsigned char* row0 = data + (unsigned)t0 * width * BPP;
+                const unsigned char* row1 = data + (unsigned)t1 * width * BPP;
+
+                Image::Pixel UL(0), UR(0), LL(0), LR(0);
+                CODEC::read(UL, row0 + (unsigned)s0 * BPP, N);
+                CODEC::read(UR, row0 + (unsigned)s1 * BPP, N);
+                CODEC::read(LL, row1 + (unsigned)s0 * BPP, N);
+                CODEC::read(LR, row1 + (unsigned)s1 * BPP, N);
+
+                Image::Pixel TOP = UL * (1.0f - smix) + UR * smix;
+                Image::Pixel BOT = LL * (1.0f - smix) + LR * smix;
+                pixels[i] = TOP * (1.0f - tmix) + BOT * tmix;
+            }
+        }
+    };
+
+    // RGBA8 is by far the most common format, so its spans get explicit SIMD
+    // conversions. Results match the scalar codec for in-range values;
+    // out-of-range values saturate.
+    struct RGBA8_SPAN : public SPAN<NORM8<uchar>, 4, 4>
+    {
+        static void read(Image::Pixel* pixels, const unsigned char* ptr, unsigned count) {
+            unsigned i = 0;
+#if defined(ROCKY_SIMD_AVX2)
+            float* out = &pixels[0][0];
+            const __m256 scale = _mm256_set1_ps(denorm_8);
+            for (; i + 2 <= count; i += 2, ptr += 8, out += 8)
+            {
+                __m256i ints = _mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i*)ptr));
+                _mm256_storeu_ps(out, _mm256_mul_ps(_mm256_cvtepi32_ps(ints), scale));
+            }
+#elif defined(ROCKY_SIMD_SSE2)
+            float* out = &pixels[0][0];
+            const __m128i zero = _mm_setzero_si128();
+            const __m128 scale = _mm_set1_ps(denorm_8);
+            for (; i + 4 <= count; i += 4, ptr += 16, out += 16)
+            {
+                __m128i bytes = _mm_loadu_si128((const __m128i*)ptr);
+                __m128i lo = _mm_unpacklo_epi8(bytes, zero);
+                __m128i hi = _mm_unpackhi_epi8(bytes, zero);
+                _mm_storeu_ps(out + 0, _mm_mul_ps(_mm_cvtepi32_ps(_mm_unpacklo_epi16(lo, zero)), scale));
+                _mm_storeu_ps(out + 4, _mm_mul_ps(_mm_cvtepi32_ps(_mm_unpackhi_epi16(lo, zero)), scale));
+                _mm_storeu_ps(out + 8, _mm_mul_ps(_mm_cvtepi32_ps(_mm_unpacklo_epi16(hi, zero)), scale));
+                _mm_storeu_ps(out + 12, _mm_mul_ps(_mm_cvtepi32_ps(_mm_unpackhi_epi16(hi, zero)), scale));
+            }
+#endif
+            SPAN::read(pixels + i, ptr, count - i);
+        }
+
+        static void write(const Image::Pixel* pixels, unsigned char* ptr, unsigned count) {
+            unsigned i = 0;
+#if defined(ROCKY_SIMD_SSE2)
+            const float* in = &pixels[0][0];
+            const __m128 scale = _mm_set1_ps(norm_8);
+            for (; i + 4 <= count; i += 4, ptr += 16, in += 16)
+            {
+                __m128i p0 = _mm_cvttps_epi32(_mm_mul_ps(_mm_loadu_ps(in + 0), scale));
+                __m128i p1 = _mm_cvttps_epi32(_mm_mul_ps(_mm_loadu_ps(in + 4), scale));
+                __m128i p2 = _mm_cvttps_epi32(_mm_mul_ps(_mm_loadu_ps(in + 8), scale));
+                __m128i p3 = _mm_cvttps_epi32(_mm_mul_ps(_mm_loadu_ps(in + 12), scale));
+                __m128i bytes = _mm_packus_epi16(_mm_packs_epi32(p0, p1), _mm_packs_epi32(p2, p3));
+                _mm_storeu_si128((__m128i*)ptr, bytes);
+            }
+#endif
+            SPAN::write(pixels + i, ptr, count - i);
+        }
+    };
 }
 
 // static member
 Image::Layout Image::_layouts[7] =
 {
-    { &NORM8<uchar>::read, &NORM8<uchar>::write, 1, 1, R8_UNORM },
-    { &NORM8<uchar>::read, &NORM8<uchar>::write, 2, 2, R8G8_UNORM },
-    { &NORM8<uchar>::read, &NORM8<uchar>::write, 3, 3, R8G8B8_UNORM },
-    { &NORM8<uchar>::read, &NORM8<uchar>::write, 4, 4, R8G8B8A8_UNORM },
-    { &NORM16<ushort>::read, &NORM16<ushort>::write, 1, 2, R16_UNORM },
-    { &FLOAT<float>::read, &FLOAT<float>::write, 1, 4, R32_SFLOAT },
-    { &FLOAT<double>::read, &FLOAT<double>::write, 1, 8, R64_SFLOAT }
+    { &NORM8<uchar>::read, &NORM8<uchar>::write,
+      &SPAN<NORM8<uchar>, 1, 1>::read, &SPAN<NORM8<uchar>, 1, 1>::write, &SPAN<NORM8<uchar>, 1, 1>::read_bilinear,
+      1, 1, R8_UNORM },
+    { &NORM8<uchar>::read, &NORM8<uchar>::write,
+      &SPAN<NORM8<uchar>, 2, 2>::read, &SPAN<NORM8<uchar>, 2, 2>::write, &SPAN<NORM8<uchar>, 2, 2>::read_bilinear,
+      2, 2, R8G8_UNORM },
+    { &NORM8<uchar>::read, &NORM8<uchar>::write,
+      &SPAN<NORM8<uchar>, 3, 3>::read, &SPAN<NORM8<uchar>, 3, 3>::write, &SPAN<NORM8<uchar>, 3, 3>::read_bilinear,
+      3, 3, R8G8B8_UNORM },
+    { &NORM8<uchar>::read, &NORM8<uchar>::write,
+      &RGBA8_SPAN::read, &RGBA8_SPAN::write, &RGBA8_SPAN::read_bilinear,
+      4, 4, R8G8B8A8_UNORM },
+    { &NORM16<ushort>::read, &NORM16<ushort>::write,
+      &SPAN<NORM16<ushort>, 1, 2>::read, &SPAN<NORM16<ushort>, 1, 2>::write, &SPAN<NORM16<ushort>, 1, 2>::read_bilinear,
+      1, 2, R16_UNORM },
+    { &FLOAT<float>::read, &FLOAT<float>::write,
+      &SPAN<FLOAT<float>, 1, 4>::read, &SPAN<FLOAT<float>, 1, 4>::write, &SPAN<FLOAT<float>, 1, 4>::read_bilinear,
+      1, 4, R32_SFLOAT },
+    { &FLOAT<double>::read, &FLOAT<double>::write,
+      &SPAN<FLOAT<double>, 1, 8>::read, &SPAN<FLOAT<double>, 1, 8>::write, &SPAN<FLOAT<double>, 1, 8>::read_bilinear,
+      1, 8, R64_SFLOAT }
 };
 
 Image::Image() :
@@ -195,16 +319,13 @@ Image::copyAsSubImage(
         return false;
     }
 
-    Pixel pixel;
+    std::vector<Pixel> row(width());
     for (unsigned r = 0; r < depth(); ++r)
     {
         for (unsigned src_t = 0, dst_t = dst_start_row; src_t < height(); src_t++, dst_t++)
         {
-            for (unsigned src_s = 0, dst_s = dst_start_col; src_s < width(); src_s++, dst_s++)
-            {
-                read(pixel, src_s, src_t, r);
-                dst->write(pixel, dst_s, dst_t, r);
-            }
+            readSpan(row.data(), 0, src_t, width(), r);
+            dst->writeSpan(row.data(), dst_start_col, dst_t, width(), r);
         }
     }
 
@@ -237,8 +358,8 @@ Image::flipVerticalInPlace()
 void
 Image::fill(const Image::Pixel& value)
 {
+    std::vector<Pixel> row(width(), value);
     for (unsigned r = 0; r < depth(); ++r)
         for (unsigned t = 0; t < height(); ++t)
-            for (unsigned s = 0; s < width(); ++s)
-                write(value, s, t, r);
+            writeSpan(row.data(), 0, t, width(), r);
 }
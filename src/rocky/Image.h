@@ -127,6 +127,42 @@ namespace ROCKY_NAMESPACE
             unsigned t,
             unsigned layer = 0);
 
+        //! Read a horizontal span of pixels starting at a column, row, and layer.
+        //! Much faster than calling read() for each pixel.
+        //! @param pixels Output array of at least count pixels
+        //! @param s, t Column and row of the first pixel
+        //! @param count Number of pixels to read; s + count must not exceed width()
+        inline void readSpan(
+            Pixel* pixels,
+            unsigned s,
+            unsigned t,
+            unsigned count,
+            unsigned layer = 0) const;
+
+        //! Write a horizontal span of pixels starting at a column, row, and layer.
+        //! Much faster than calling write() for each pixel.
+        //! @param pixels Array of at least count pixels
+        //! @param s, t Column and row of the first pixel
+        //! @param count Number of pixels to write; s + count must not exceed width()
+        inline void writeSpan(
+            const Pixel* pixels,
+            unsigned s,
+            unsigned t,
+            unsigned count,
+            unsigned layer = 0);
+
+        //! Read a block of pixels at UV coordinates with bilinear interpolation.
+        //! Same results as calling read_bilinear() for each sample, but faster.
+        //! @param pixels Output array of at least count pixels
+        //! @param u, v Arrays of count UV coordinates
+        //! @param count Number of samples
+        inline void read_bilinear(
+            Pixel* pixels,
+            const float* u,
+            const float* v,
+            unsigned count,
+            unsigned layer = 0) const;
+
         //! Size of this image in bytes
         inline unsigned sizeInBytes() const;
 
@@ -210,8 +246,11 @@ namespace ROCKY_NAMESPACE
             unsigned r);
 
         struct Layout {
-            void(*read)(Pixel&, unsigned char*, int);
+            void(*read)(Pixel&, const unsigned char*, int);
             void(*write)(const Pixel&, unsigned char*, int);
+            void(*readSpan)(Pixel*, const unsigned char*, unsigned);
+            void(*writeSpan)(const Pixel*, unsigned char*, unsigned);
+            void(*readBilinear)(Pixel*, const float*, const float*, unsigned, const unsigned char*, unsigned, unsigned);
             int num_components;
             int bytes_per_pixel;
             PixelFormat format;
@@ -270,10 +309,37 @@ namespace ROCKY_NAMESPACE
     {
         _layouts[pixelFormat()].write(
             pixel,
-            _data + (width()*height()*r + height() * t + s)*_layouts[pixelFormat()].bytes_per_pixel,
+            _data + (width()*height()*r + width()*t + s)*_layouts[pixelFormat()].bytes_per_pixel,
             _layouts[pixelFormat()].num_components);
     }
 
+    void Image::readSpan(Pixel* pixels, unsigned s, unsigned t, unsigned count, unsigned r) const
+    {
+        auto& layout = _layouts[pixelFormat()];
+        layout.readSpan(
+            pixels,
+            _data + (width()*height()*r + width()*t + s)*layout.bytes_per_pixel,
+            count);
+    }
+
+    void Image::writeSpan(const Pixel* pixels, unsigned s, unsigned t, unsigned count, unsigned r)
+    {
+        auto& layout = _layouts[pixelFormat()];
+        layout.writeSpan(
+            pixels,
+            _data + (width()*height()*r + width()*t + s)*layout.bytes_per_pixel,
+            count);
+    }
+
+    void Image::read_bilinear(Pixel* pixels, const float* u, const float* v, unsigned count, unsigned r) const
+    {
+        auto& layout = _layouts[pixelFormat()];
+        layout.readBilinear(
+            pixels, u, v, count,
+            _data + width()*height()*r*layout.bytes_per_pixel,
+            width(), height());
+    }
+
     unsigned Image::sizeInBytes() const
     {
         return sizeInPixels() * _layouts[pixelFormat()].bytes_per_pixel;
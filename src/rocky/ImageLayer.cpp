@@ -63,7 +63,7 @@ ImageLayer::createImage(const TileKey& key) const
 }
 
 Result<GeoImage>
-ImageLayer::createImage(const TileKey& key, const IOOptions& io) const
+ImageLayer::createImage(const TileKey& key, const IOOptions& in_io) const
 {    
     ROCKY_PROFILING_ZONE;
     ROCKY_PROFILING_ZONE_TEXT(getName() + " " + key.str());
@@ -73,10 +73,38 @@ ImageLayer::createImage(const TileKey& key, const IOOptions& io) const
         return Result(GeoImage::INVALID);
     }
 
+    // identify this layer to shared services like the content cache
+    IOOptions io(in_io);
+    io.property("layer") = name().value();
+
     //NetworkMonitor::ScopedRequestLayer layerRequest(getName());
 
+    // Check the cache first; a fresh record short-circuits the source.
+    bool cacheOnly = effectiveCachePolicy().isCacheOnly();
+    bool expired = false;
+    auto cached = readCachedImage(key, expired, io);
+    if (cached && (!expired || cacheOnly))
+    {
+        return GeoImage(cached, key.extent());
+    }
+
+    if (cacheOnly)
+    {
+        return Result(GeoImage::INVALID);
+    }
+
     auto result = createImageInKeyProfile(key, io);
 
+    if (result.status.ok() && result.value.valid())
+    {
+        writeCachedImage(key, result.value.image().get(), io);
+    }
+    else if (cached)
+    {
+        // the source failed, but an expired record beats nothing
+        return GeoImage(cached, key.extent());
+    }
+
 #if 0
     // Post-cache operations:
     if (!_postLayers.empty())
@@ -262,28 +290,33 @@ ImageLayer::assembleImage(const TileKey& key, const IOOptions& io) const
                 }
             }
 
-            // transform the sample points to the SRS of our source data tiles:
+            // transform the sample points to the SRS of our source data tiles,
+            // approximating to within an eighth of a source pixel:
             if (xform.valid())
-                xform.transformArray(&points[0], points.size());
+            {
+                auto& sourceExtent = source_list[0].extent();
+                auto sourceImage = source_list[0].image();
+                xform.setGridErrorTolerance(0.125 * std::min(
+                    sourceExtent.width() / (double)sourceImage->width(),
+                    sourceExtent.height() / (double)sourceImage->height()));
+
+                xform.transformGrid(&points[0], width, height);
+            }
+
+            //Create the new image by sampling all of them, one output row at a time.
+            std::vector<Image::Pixel> row(width);
 
-            //Create the new heightfield by sampling all of them.
             for (unsigned r = 0; r < height; ++r)
             {
-                double y = miny + (dy * (double)r);
-
                 for (unsigned int c = 0; c < width; ++c)
                 {
-                    double x = minx + (dx * (double)c);
-
                     unsigned i = r * width + c;
 
-                    // For each sample point, try each heightfield.  The first one with a valid elevation wins.
+                    // For each sample point, try each source image. The first one with a visible pixel wins.
                     glm::fvec4 pixel(0, 0, 0, 0);
 
                     for (unsigned k = 0; k < source_list.size(); ++k)
                     {
-                        // get the elevation value, at the same time transforming it vertically into the
-                        // requesting key's vertical datum.
                         if (source_list[k].read(pixel, points[i].x, points[i].y) && 
                             pixel.a > 0.0f)
                         {
@@ -291,8 +324,10 @@ ImageLayer::assembleImage(const TileKey& key, const IOOptions& io) const
                         }
                     }
 
-                    output->write(pixel, c, r);
+                    row[c] = pixel;
                 }
+
+                output->writeSpan(row.data(), 0, r, width);
             }
         }
     }
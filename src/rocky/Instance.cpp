@@ -4,6 +4,7 @@
  * MIT License
  */
 #include "Instance.h"
+#include "DiskCache.h"
 #include "Profile.h"
 #include "SRS.h"
 #include "Threading.h"
@@ -98,6 +99,22 @@ Instance::Instance()
         Log()->warn("Environment variable PROJ_DATA is not set");
     }
 
+    // Optional persistent tile cache
+    char const* cachePath = ::getenv("ROCKY_CACHE_PATH");
+    if (cachePath)
+    {
+        unsigned maxSizeMB = 1024u;
+        char const* cacheSize = ::getenv("ROCKY_CACHE_MAX_SIZE_MB");
+        if (cacheSize)
+        {
+            maxSizeMB = util::as<unsigned>(std::string(cacheSize), maxSizeMB);
+        }
+
+        auto cache = DiskCache::create(std::string(cachePath), maxSizeMB);
+        _impl->ioOptions.services.cache = [cache]() { return cache; };
+        Log()->info("Using tile cache at " + cache->rootPath());
+    }
+
     _global_status = StatusOK;
 }
 
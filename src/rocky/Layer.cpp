@@ -38,6 +38,7 @@ Layer::construct(const JSON& conf)
     get_to(j, "open", _openAutomatically);
     get_to(j, "attribution", _attribution);
     get_to(j, "l2_cache_size", _l2cachesize);
+    get_to(j, "cache_id", _cacheid);
 
     _status = Status(
         Status::ResourceUnavailable,
@@ -53,6 +54,7 @@ Layer::to_json() const
     set(j, "open", _openAutomatically);
     set(j, "attribution", _attribution);
     set(j, "l2_cache_size", _l2cachesize);
+    set(j, "cache_id", _cacheid);
     return j.dump();
 }
 
@@ -9,6 +9,9 @@
 #include "Instance.h"
 
 #include <filesystem>
+#include <functional>
+#include <algorithm>
+#include <cmath>
 #include <proj.h>
 
 #define LC "[SRS] "
@@ -750,6 +753,8 @@ SRSOperation::operator=(SRSOperation&& rhs)
 {
     _from = rhs._from;
     _to = rhs._to;
+    _nop = rhs._nop;
+    _gridErrorTolerance = rhs._gridErrorTolerance;
     rhs._from = { };
     rhs._to = { };
     return *this;
@@ -820,6 +825,163 @@ SRSOperation::forward(void* handle, double* x, double* y, double* z, std::size_t
 }
 
 
+namespace
+{
+    // Adaptive approximation of a transform over a regular grid (similar in
+    // spirit to GDAL's approximate transformer). Each cell's corners are
+    // transformed exactly; if the center and edge midpoints of the cell are
+    // within tolerance of a bilinear interpolation of the corners, the rest of
+    // the cell is interpolated. Otherwise the cell is split in four.
+    struct GridApproximation
+    {
+        enum State : char { PENDING, EXACT, FAILED, INTERPOLATED };
+
+        // cells never interpolate across more than this many points, so a
+        // lucky midpoint test can't paper over a large curved region
+        static constexpr unsigned max_cell_size = 64;
+
+        std::function<bool(double&, double&, double&)> transform;
+        double* x;
+        double* y;
+        double* z;
+        std::size_t stride;
+        unsigned cols;
+        double tolerance;
+        std::vector<glm::dvec3> input;
+        std::vector<State> state;
+
+        double& X(unsigned i) { return *(double*)((char*)x + i * stride); }
+        double& Y(unsigned i) { return *(double*)((char*)y + i * stride); }
+        double& Z(unsigned i) { return *(double*)((char*)z + i * stride); }
+
+        bool exact(unsigned c, unsigned r)
+        {
+            unsigned i = r * cols + c;
+            if (state[i] == PENDING || state[i] == INTERPOLATED)
+            {
+                double px = input[i].x, py = input[i].y, pz = input[i].z;
+                if (transform(px, py, pz))
+                {
+                    X(i) = px, Y(i) = py, Z(i) = pz;
+                    state[i] = EXACT;
+                }
+                else
+                {
+                    X(i) = HUGE_VAL, Y(i) = HUGE_VAL, Z(i) = HUGE_VAL;
+                    state[i] = FAILED;
+                }
+            }
+            return state[i] == EXACT;
+        }
+
+        // bilinear interpolation of the four (exact) corners of a cell
+        glm::dvec3 interpolate(unsigned c0, unsigned r0, unsigned c1, unsigned r1, unsigned c, unsigned r)
+        {
+            double u = c1 > c0 ? (double)(c - c0) / (double)(c1 - c0) : 0.0;
+            double v = r1 > r0 ? (double)(r - r0) / (double)(r1 - r0) : 0.0;
+            unsigned ll = r0 * cols + c0, lr = r0 * cols + c1, ul = r1 * cols + c0, ur = r1 * cols + c1;
+            glm::dvec3 bottom = glm::dvec3(X(ll), Y(ll), Z(ll)) * (1.0 - u) + glm::dvec3(X(lr), Y(lr), Z(lr)) * u;
+            glm::dvec3 top = glm::dvec3(X(ul), Y(ul), Z(ul)) * (1.0 - u) + glm::dvec3(X(ur), Y(ur), Z(ur)) * u;
+            return bottom * (1.0 - v) + top * v;
+        }
+
+        bool withinTolerance(unsigned c0, unsigned r0, unsigned c1, unsigned r1, unsigned c, unsigned r)
+        {
+            if (!exact(c, r))
+                return false;
+            auto approx = interpolate(c0, r0, c1, r1, c, r);
+            unsigned i = r * cols + c;
+            return std::abs(approx.x - X(i)) <= tolerance && std::abs(approx.y - Y(i)) <= tolerance;
+        }
+
+        void process(unsigned c0, unsigned r0, unsigned c1, unsigned r1)
+        {
+            // small enough to just do it:
+            if (c1 - c0 <= 1 && r1 - r0 <= 1)
+            {
+                exact(c0, r0), exact(c1, r0), exact(c0, r1), exact(c1, r1);
+                return;
+            }
+
+            unsigned cm = (c0 + c1) / 2, rm = (r0 + r1) / 2;
+
+            bool ok =
+                c1 - c0 <= max_cell_size &&
+                r1 - r0 <= max_cell_size &&
+                exact(c0, r0) && exact(c1, r0) && exact(c0, r1) && exact(c1, r1) &&
+                withinTolerance(c0, r0, c1, r1, cm, rm) &&
+                withinTolerance(c0, r0, c1, r1, cm, r0) &&
+                withinTolerance(c0, r0, c1, r1, cm, r1) &&
+                withinTolerance(c0, r0, c1, r1, c0, rm) &&
+                withinTolerance(c0, r0, c1, r1, c1, rm);
+
+            if (ok)
+            {
+                for (unsigned r = r0; r <= r1; ++r)
+                {
+                    for (unsigned c = c0; c <= c1; ++c)
+                    {
+                        unsigned i = r * cols + c;
+                        if (state[i] == PENDING)
+                        {
+                            auto p = interpolate(c0, r0, c1, r1, c, r);
+                            X(i) = p.x, Y(i) = p.y, Z(i) = p.z;
+                            state[i] = INTERPOLATED;
+                        }
+                    }
+                }
+            }
+            else
+            {
+                // split along each axis that has room; cells share their edges.
+                if (c1 - c0 > 1 && r1 - r0 > 1)
+                {
+                    process(c0, r0, cm, rm);
+                    process(cm, r0, c1, rm);
+                    process(c0, rm, cm, r1);
+                    process(cm, rm, c1, r1);
+                }
+                else if (c1 - c0 > 1)
+                {
+                    process(c0, r0, cm, r1);
+                    process(cm, r0, c1, r1);
+                }
+                else
+                {
+                    process(c0, r0, c1, rm);
+                    process(c0, rm, c1, r1);
+                }
+            }
+        }
+    };
+}
+
+bool
+SRSOperation::forwardGrid(void* handle, double* x, double* y, double* z, std::size_t stride, unsigned cols, unsigned rows) const
+{
+    if (!handle)
+        return false;
+
+    // exact path:
+    if (_gridErrorTolerance <= 0.0 || cols < 3 || rows < 3)
+        return forward(handle, x, y, z, stride, (std::size_t)cols * rows);
+
+    GridApproximation grid;
+    grid.transform = [&](double& px, double& py, double& pz) { return forward(handle, px, py, pz); };
+    grid.x = x, grid.y = y, grid.z = z;
+    grid.stride = stride;
+    grid.cols = cols;
+    grid.tolerance = _gridErrorTolerance;
+    grid.state.assign((std::size_t)cols * rows, GridApproximation::PENDING);
+    grid.input.resize((std::size_t)cols * rows);
+    for (unsigned i = 0; i < grid.input.size(); ++i)
+        grid.input[i] = glm::dvec3(grid.X(i), grid.Y(i), grid.Z(i));
+
+    grid.process(0, 0, cols - 1, rows - 1);
+
+    return std::find(grid.state.begin(), grid.state.end(), GridApproximation::FAILED) == grid.state.end();
+}
+
 bool
 SRSOperation::inverse(void* handle, double& x, double& y, double& z) const
 {
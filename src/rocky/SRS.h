@@ -228,6 +228,29 @@ namespace ROCKY_NAMESPACE
                 &inout[0][0], &inout[0][1], &inout[0][2], sizeof(DVEC3), count);
         }
 
+        //! Maximum error allowed when transforming regular grids with transformGrid(),
+        //! in the units of the target SRS. When greater than zero, transformGrid()
+        //! transforms a coarse lattice exactly and interpolates inside each cell,
+        //! subdividing wherever the interpolation strays from the exact result by
+        //! more than this amount. Zero (the default) transforms every point exactly.
+        void setGridErrorTolerance(double value) {
+            _gridErrorTolerance = value;
+        }
+        double gridErrorTolerance() const {
+            return _gridErrorTolerance;
+        }
+
+        //! Transform a regular grid of 3-vectors in place. The points must be laid
+        //! out row by row (cols x rows) and be evenly spaced along each axis.
+        //! Much faster than transformArray() for smooth operations when a grid
+        //! error tolerance is set.
+        //! @return True if all transformations succeeded
+        template<typename DVEC3>
+        bool transformGrid(DVEC3* inout, unsigned cols, unsigned rows) const {
+            return _nop ? true : forwardGrid(get_handle(),
+                &inout[0][0], &inout[0][1], &inout[0][2], sizeof(DVEC3), cols, rows);
+        }
+
         //! Inverse-transform a 3-vector
         //! @return True is the transformation succeeded
         template<typename DVEC3A, typename DVEC3B>
@@ -277,6 +300,7 @@ namespace ROCKY_NAMESPACE
         SRS _from;
         SRS _to;
         bool _nop = false;
+        double _gridErrorTolerance = 0.0;
         mutable std::string _lastError;
 
         void* get_handle() const;
@@ -285,6 +309,7 @@ namespace ROCKY_NAMESPACE
 
         bool forward(void* handle, double* x, double* y, double* z, std::size_t stride, std::size_t count) const;
         bool inverse(void* handle, double* x, double* y, double* z, std::size_t stride, std::size_t count) const;
+        bool forwardGrid(void* handle, double* x, double* y, double* z, std::size_t stride, unsigned cols, unsigned rows) const;
         friend class SRS;
     };
 }
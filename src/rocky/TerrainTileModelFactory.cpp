@@ -8,6 +8,7 @@
 #include "Metrics.h"
 #include "ElevationLayer.h"
 #include "ImageLayer.h"
+#include "Threading.h"
 
 #define LC "[TerrainTileModelFactory] "
 
@@ -150,41 +151,79 @@ TerrainTileModelFactory::createTileModel(
     model.key = key;
     model.revision = map->revision();
 
-    // assemble all the components:
-    addColorLayers(model, map, key, manifest, io, false);
-
     unsigned border = 0u;
-    addElevation(model, map, key, manifest, border, io);
+
+    if (fetchScheduler)
+    {
+        // fetch the elevation in the background while we do the color layers.
+        auto elevation = util::job::dispatch(
+            [this, map, key, manifest, border, io](Cancelable&)
+            {
+                TerrainTileModel temp;
+                addElevation(temp, map, key, manifest, border, io);
+                return std::move(temp.elevation);
+            }, {
+                "fetch elevation " + key.str(),
+                nullptr,
+                fetchScheduler,
+                nullptr
+            });
+
+        addColorLayers(model, map, key, manifest, io, false);
+
+        // Always wait, since the job refers to this factory and our IOOptions.
+        model.elevation = elevation.join();
+    }
+    else
+    {
+        // assemble all the components:
+        addColorLayers(model, map, key, manifest, io, false);
+
+        addElevation(model, map, key, manifest, border, io);
+    }
 
     return std::move(model);
 }
 
 namespace
 {
-    void addImageLayer(const TileKey& requested_key, std::shared_ptr<ImageLayer> layer, bool fallback, TerrainTileModel& model, const IOOptions& io)
+    struct ImageFetch
     {
         Result<GeoImage> result;
+        TileKey key;
+    };
 
-        TileKey key = requested_key;
+    ImageFetch fetchImage(const TileKey& requested_key, std::shared_ptr<ImageLayer> layer, bool fallback, const IOOptions& io)
+    {
+        ImageFetch fetch;
+
+        fetch.key = requested_key;
         if (fallback)
         {
-            for (; key.valid() && !result.value.valid(); key.makeParent())
+            for (; fetch.key.valid() && !fetch.result.value.valid() && !io.canceled(); fetch.key.makeParent())
             {
-                result = layer->createImage(key, io);
+                fetch.result = layer->createImage(fetch.key, io);
             }
         }
         else
         {
-            result = layer->createImage(key, io);
+            fetch.result = layer->createImage(fetch.key, io);
         }
 
+        return fetch;
+    }
+
+    void addImageLayer(ImageFetch& fetch, std::shared_ptr<ImageLayer> layer, TerrainTileModel& model)
+    {
+        auto& result = fetch.result;
+
         if (result.value.valid())
         {
             TerrainTileModel::ColorLayer m;            
             m.layer = layer;
             m.revision = layer->revision();
             m.image = result.value;
-            m.key = key;
+            m.key = fetch.key;
             model.colorLayers.emplace_back(std::move(m));
             if (layer->isDynamic())
             {
@@ -242,7 +281,8 @@ TerrainTileModelFactory::addColorLayers(
     {
         // if only one layer intersects we will not need to composite
         // so just get the raw data for this key if there is any.
-        addImageLayer(key, intersecting_layers.front(), false, model, io);
+        auto fetch = fetchImage(key, intersecting_layers.front(), false, io);
+        addImageLayer(fetch, intersecting_layers.front(), model);
     }
 
     else if (intersecting_layers.size() > 1)
@@ -262,9 +302,52 @@ TerrainTileModelFactory::addColorLayers(
 
         if (data_maybe)
         {
-            for (auto layer : intersecting_layers)
+            std::vector<ImageFetch> fetches(intersecting_layers.size());
+
+            if (fetchScheduler)
+            {
+                // Fan out: fetch all layers but the first in the background
+                // and the first one here, so the tile waits for the slowest
+                // layer instead of the sum of them all. Always wait for every
+                // job since the IOOptions refer to our caller's cancelable;
+                // they will see a cancelation and return quickly.
+                std::vector<util::Future<ImageFetch>> futures;
+                for (unsigned i = 1; i < intersecting_layers.size(); ++i)
+                {
+                    auto layer = intersecting_layers[i];
+                    futures.emplace_back(util::job::dispatch(
+                        [key, layer, io](Cancelable&) { return fetchImage(key, layer, true, io); }, {
+                            "fetch image " + key.str(),
+                            nullptr,
+                            fetchScheduler,
+                            nullptr
+                        }));
+                }
+
+                fetches[0] = fetchImage(key, intersecting_layers[0], true, io);
+
+                for (unsigned i = 1; i < intersecting_layers.size(); ++i)
+                {
+                    fetches[i] = futures[i - 1].join();
+                }
+            }
+            else
+            {
+                for (unsigned i = 0; i < intersecting_layers.size(); ++i)
+                {
+                    fetches[i] = fetchImage(key, intersecting_layers[i], true, io);
+                }
+            }
+
+            if (io.canceled())
+            {
+                return;
+            }
+
+            // add them in layer order:
+            for (unsigned i = 0; i < intersecting_layers.size(); ++i)
             {
-                addImageLayer(key, layer, true, model, io);
+                addImageLayer(fetches[i], intersecting_layers[i], model);
             }
 
             // now composite them.
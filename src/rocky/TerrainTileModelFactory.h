@@ -16,6 +16,10 @@ namespace ROCKY_NAMESPACE
     class ElevationLayer;
     class IOControl;
 
+    namespace util {
+        class job_scheduler;
+    }
+
     /**
      * Builds a TerrainTileModel from a map frame.
      */
@@ -25,6 +29,12 @@ namespace ROCKY_NAMESPACE
         //! Whether to composite all color layers into one
         bool compositeColorLayers = true;
 
+        //! Scheduler in which to fetch the layers of a tile in parallel.
+        //! If null, layers are fetched one after the other in the calling
+        //! thread. Don't use the scheduler that calls createTileModel; its
+        //! workers would block waiting on their own queue.
+        util::job_scheduler* fetchScheduler = nullptr;
+
     public:
         TerrainTileModelFactory();
 
@@ -13,6 +13,7 @@
 #include <climits>
 #include <mutex>
 #include <iomanip>
+#include <algorithm>
 
 #ifdef _WIN32
 #   include <Windows.h>
@@ -364,6 +365,20 @@ Semaphore::join(Cancelable& p)
 }
 
 
+bool
+Semaphore::join(std::chrono::steady_clock::duration timeout)
+{
+    std::unique_lock lock(_m);
+    return _cv.wait_for(
+        lock,
+        timeout,
+        [this]() {
+            return _count == 0;
+        }
+    );
+}
+
+
 #undef LC
 #define LC "[job_group]"
 
@@ -384,7 +399,24 @@ job_group::join()
 {
     if (_sema != nullptr && _sema.use_count() > 1)
     {
-        _sema->join();
+        // A worker thread that blocks on a group of sub-jobs would hold a
+        // thread hostage while those sub-jobs wait in the queue. In work-stealing
+        // mode, help run them instead of sleeping.
+        job_scheduler* scheduler = job_scheduler::current();
+        if (scheduler && scheduler->getWorkStealing())
+        {
+            while (_sema->count() > 0)
+            {
+                if (!scheduler->help())
+                {
+                    _sema->join(std::chrono::milliseconds(1));
+                }
+            }
+        }
+        else
+        {
+            _sema->join();
+        }
     }
 }
 
@@ -422,11 +454,130 @@ job::scheduler_dispatch(std::function<bool()> delegate, const job& config)
 
 #define ROCKY_SCHEDULER_DEFAULT_SIZE 2u
 
+// how often to re-evaluate queued job priorities by default (about once per frame)
+#define ROCKY_SCHEDULER_DEFAULT_PRIORITY_REFRESH std::chrono::milliseconds(16)
+
+// maximum number of worker threads that get a local deque in work-stealing mode
+#define ROCKY_SCHEDULER_MAX_LOCAL_QUEUES 128u
+
+namespace
+{
+    // scheduler and local deque slot of the calling worker thread
+    thread_local job_scheduler* t_scheduler = nullptr;
+    thread_local int t_localQueue = -1;
+}
+
+/**
+ * Lock-free work-stealing deque (Chase & Lev, with the memory orderings
+ * from Le et al. 2013, "Correct and Efficient Work-Stealing for Weak Memory
+ * Models"). Only the owning worker calls push() and pop(); any thread may
+ * call steal(). Buffers that are outgrown stay alive until the deque is
+ * destroyed, since a thief may still be reading one.
+ */
+struct job_scheduler::LocalQueue
+{
+    struct Buffer
+    {
+        Buffer(std::int64_t c) : capacity(c), slots(new std::atomic<QueuedJob*>[c]) { }
+        const std::int64_t capacity;
+        std::unique_ptr<std::atomic<QueuedJob*>[]> slots;
+        inline QueuedJob* get(std::int64_t i) const {
+            return slots[i & (capacity - 1)].load(std::memory_order_relaxed);
+        }
+        inline void put(std::int64_t i, QueuedJob* item) {
+            slots[i & (capacity - 1)].store(item, std::memory_order_relaxed);
+        }
+    };
+
+    std::atomic<std::int64_t> top = 0;
+    std::atomic<std::int64_t> bottom = 0;
+    std::atomic<Buffer*> buffer = nullptr;
+    std::vector<std::unique_ptr<Buffer>> buffers; // owner thread only
+    std::atomic<bool> owned = false;
+
+    void push(QueuedJob* item)
+    {
+        std::int64_t b = bottom.load(std::memory_order_relaxed);
+        std::int64_t t = top.load(std::memory_order_acquire);
+        Buffer* a = buffer.load(std::memory_order_relaxed);
+        if (a == nullptr || b - t > a->capacity - 1)
+        {
+            // grow (power of two) and copy the live range:
+            auto bigger = std::make_unique<Buffer>(a ? a->capacity * 2 : 256);
+            for (std::int64_t i = t; i < b; ++i)
+                bigger->put(i, a->get(i));
+            a = bigger.get();
+            buffers.emplace_back(std::move(bigger));
+            buffer.store(a, std::memory_order_release);
+        }
+        a->put(b, item);
+        std::atomic_thread_fence(std::memory_order_release);
+        bottom.store(b + 1, std::memory_order_relaxed);
+    }
+
+    QueuedJob* pop()
+    {
+        std::int64_t b = bottom.load(std::memory_order_relaxed) - 1;
+        Buffer* a = buffer.load(std::memory_order_relaxed);
+        bottom.store(b, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        std::int64_t t = top.load(std::memory_order_relaxed);
+
+        QueuedJob* item = nullptr;
+        if (t <= b)
+        {
+            item = a->get(b);
+            if (t == b)
+            {
+                // last item; race against thieves for it
+                if (!top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+                    item = nullptr;
+                bottom.store(b + 1, std::memory_order_relaxed);
+            }
+        }
+        else
+        {
+            bottom.store(b + 1, std::memory_order_relaxed);
+        }
+        return item;
+    }
+
+    QueuedJob* steal()
+    {
+        std::int64_t t = top.load(std::memory_order_acquire);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        std::int64_t b = bottom.load(std::memory_order_acquire);
+
+        QueuedJob* item = nullptr;
+        if (t < b)
+        {
+            Buffer* a = buffer.load(std::memory_order_acquire);
+            item = a->get(t);
+            if (!top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+                return nullptr; // lost the race; caller may retry
+        }
+        return item;
+    }
+
+    bool empty() const
+    {
+        return bottom.load(std::memory_order_acquire) <= top.load(std::memory_order_acquire);
+    }
+};
+
 job_scheduler::job_scheduler(const std::string& name, unsigned concurrency) :
     _name(name),
+    _priorityRefreshInterval(ROCKY_SCHEDULER_DEFAULT_PRIORITY_REFRESH),
+    _lastPriorityRefresh(std::chrono::steady_clock::now()),
     _targetConcurrency(concurrency),
     _done(false)
 {
+    // allocate the local deques up front so that thieves never race
+    // against a resize of the container
+    _localQueues.resize(ROCKY_SCHEDULER_MAX_LOCAL_QUEUES);
+    for (auto& queue : _localQueues)
+        queue = std::make_unique<LocalQueue>();
+
     // find a slot in the stats
     _metrics = &job_metrics::_singleton.scheduler(_name);
     startThreads();
@@ -501,13 +652,95 @@ job_scheduler::setConcurrency(const std::string& name, unsigned value)
     }
 }
 
+void
+job_scheduler::setPriorityRefreshInterval(std::chrono::steady_clock::duration value)
+{
+    std::unique_lock lock(_queueMutex);
+    _priorityRefreshInterval = value;
+}
+
+std::chrono::steady_clock::duration
+job_scheduler::getPriorityRefreshInterval() const
+{
+    std::unique_lock lock(_queueMutex);
+    return _priorityRefreshInterval;
+}
+
+void
+job_scheduler::setWorkStealing(bool value)
+{
+    _workStealing = value;
+}
+
+bool
+job_scheduler::getWorkStealing() const
+{
+    return _workStealing;
+}
+
+job_scheduler*
+job_scheduler::current()
+{
+    return t_scheduler;
+}
+
+void
+job_scheduler::refreshPriorities()
+{
+    for (auto& queuedjob : _queue)
+    {
+        queuedjob._priority = queuedjob._job.priority != nullptr ?
+            queuedjob._job.priority() :
+            0.0f;
+    }
+
+    std::make_heap(_queue.begin(), _queue.end());
+
+    _lastPriorityRefresh = std::chrono::steady_clock::now();
+}
+
 void
 job_scheduler::cancelAll()
 {
     std::unique_lock lock(_queueMutex);
+    discardQueuedJobs();
+}
+
+void
+job_scheduler::discardQueuedJobs()
+{
+    unsigned count = 0u;
+
+    // release group semaphores so that job_group.join() will not deadlock
+    auto discard = [&count](QueuedJob& queuedjob)
+    {
+        if (queuedjob._groupsema != nullptr)
+            queuedjob._groupsema->release();
+        ++count;
+    };
+
+    for (auto& queuedjob : _queue)
+        discard(queuedjob);
     _queue.clear();
-    _metrics->canceled += _metrics->pending;
-    _metrics->pending = 0;
+
+    // steal() is safe from any thread, so use it to empty the local deques
+    for (unsigned i = 0; i < _localQueuesUsed; ++i)
+    {
+        auto& queue = *_localQueues[i];
+        QueuedJob* item;
+        while ((item = queue.steal()) != nullptr || !queue.empty())
+        {
+            if (item)
+            {
+                _localPending--;
+                discard(*item);
+                delete item;
+            }
+        }
+    }
+
+    _metrics->pending -= count;
+    _metrics->canceled += count;
 }
 
 void
@@ -521,15 +754,43 @@ job_scheduler::dispatch(const job& job, std::function<bool()>& delegate)
         sema->acquire();
     }
 
-    if (_targetConcurrency > 0)
+    if (_targetConcurrency > 0 && _workStealing && t_scheduler == this && t_localQueue >= 0)
     {
+        // dispatched from one of our own workers: push to its local deque.
+        // (count it first, so a concurrent discardQueuedJobs() can't
+        // take the counters below zero)
+        _metrics->pending++;
+        _localPending++;
+        _localQueues[t_localQueue]->push(new QueuedJob(job, delegate, sema, 0.0f, 0));
+
+        // wake a sleeping worker so it can steal. Acquiring the mutex orders
+        // this against a worker that is between its predicate check and wait().
+        if (_sleepers > 0)
+        {
+            std::unique_lock lock(_queueMutex);
+            _block.notify_one();
+        }
+    }
+    else if (_targetConcurrency > 0)
+    {
+        // evaluate the initial priority outside the lock
+        float priority = job.priority != nullptr ? job.priority() : 0.0f;
+
         std::unique_lock lock(_queueMutex);
         if (!_done)
         {
-            _queue.emplace_back(job, delegate, sema);
+            _queue.emplace_back(job, delegate, sema, priority, _nextSeq++);
+            std::push_heap(_queue.begin(), _queue.end());
             _metrics->pending++;
             _block.notify_one();
         }
+        else
+        {
+            // shutting down
+            if (sema)
+                sema->release();
+            _metrics->canceled++;
+        }
     }
     else
     {
@@ -543,92 +804,117 @@ job_scheduler::dispatch(const job& job, std::function<bool()>& delegate)
     }
 }
 
+bool
+job_scheduler::takeLocal(QueuedJob& out)
+{
+    QueuedJob* item = nullptr;
+
+    // our own deque first (LIFO, the most recently spawned sub-job):
+    if (t_scheduler == this && t_localQueue >= 0)
+    {
+        item = _localQueues[t_localQueue]->pop();
+    }
+
+    // then try to steal (FIFO, the oldest job) from a peer:
+    if (item == nullptr)
+    {
+        unsigned count = _localQueuesUsed;
+        unsigned start = t_localQueue >= 0 ? (unsigned)t_localQueue + 1u : 0u;
+        for (unsigned i = 0; i < count && item == nullptr; ++i)
+        {
+            auto& victim = *_localQueues[(start + i) % count];
+            if (!victim.empty())
+                item = victim.steal();
+        }
+    }
+
+    if (item)
+    {
+        _localPending--;
+        out = std::move(*item);
+        delete item;
+        return true;
+    }
+    return false;
+}
+
+bool
+job_scheduler::help()
+{
+    QueuedJob next;
+    if (_localPending > 0 && takeLocal(next))
+    {
+        execute(next);
+        return true;
+    }
+    return false;
+}
+
 void
-job_scheduler::run()
+job_scheduler::execute(QueuedJob& next)
 {
-    // cap the number of jobs to run (applies to TRAVERSAL modes only)
-    int jobsLeftToRun = INT_MAX;
+    _metrics->running++;
+    _metrics->pending--;
+
+    bool job_executed = next._delegate();
+
+    if (!job_executed)
+    {
+        _metrics->canceled++;
+        //Log::info() << "Job " << next._job.name << " canceled" << std::endl;
+    }
+
+    // release the group semaphore if necessary
+    if (next._groupsema != nullptr)
+    {
+        next._groupsema->release();
+    }
 
+    _metrics->running--;
+}
+
+void
+job_scheduler::run()
+{
     while (!_done)
     {
         QueuedJob next;
 
-        bool have_next = false;
+        // local deques (work-stealing mode) take precedence over the shared queue
+        bool have_next = _localPending > 0 && takeLocal(next);
+
+        if (!have_next)
         {
             std::unique_lock lock(_queueMutex);
-            
+
+            _sleepers++;
             _block.wait(lock, [this] {
-                return _queue.empty() == false || _done == true;
+                return _queue.empty() == false || _localPending > 0 || _done == true;
                 });
+            _sleepers--;
 
             if (!_queue.empty() && !_done)
             {
-                // Find the highest priority item in the queue.
-                // Note: We could use std::partial_sort or std::nth_element,
-                // but benchmarking proves that a simple brute-force search
-                // is always the fastest.
-                // (Benchmark: https://stackoverflow.com/a/20365638/4218920)
-                // Also note: it is indeed possible for the results of 
-                // priority() to change during the search. We don't care.
-                int index = -1;
-                float highest_priority = -FLT_MAX;
-                for (unsigned i = 0; i < _queue.size(); ++i)
+                // Priorities are dynamic (e.g. camera distance) so we re-evaluate
+                // them all in one batch when the refresh interval expires, instead
+                // of calling every priority function on every pop.
+                // Between refreshes the heap pops in O(log n) using cached values.
+                if (std::chrono::steady_clock::now() - _lastPriorityRefresh >= _priorityRefreshInterval)
                 {
-                    float priority = _queue[i]._job.priority != nullptr ?
-                        _queue[i]._job.priority() :
-                        0.0f;
-
-                    if (index < 0 || priority > highest_priority)
-                    {
-                        index = i;
-                        highest_priority = priority;
-                    }
+                    refreshPriorities();
                 }
-                if (index < 0)
-                    index = 0;
 
-                next = std::move(_queue[index]);
+                // take the highest priority item off the top of the heap:
+                std::pop_heap(_queue.begin(), _queue.end());
+                next = std::move(_queue.back());
+                _queue.pop_back();
                 have_next = true;
-                
-                // move the last element into the empty position:
-                if (index < _queue.size()-1)
-                {
-                    _queue[index] = std::move(_queue.back());
-                }
-
-                // and remove the last element.
-                _queue.erase(_queue.end() - 1);
             }
         }
 
         if (have_next)
         {
-            _metrics->running++;
-            _metrics->pending--;
-
-            auto t0 = std::chrono::steady_clock::now();
-
-            bool job_executed = next._delegate();
-
-            auto duration = std::chrono::steady_clock::now() - t0;
-
-            if (job_executed)
-            {
-                jobsLeftToRun--;
-            }
-            else
-            {
-                _metrics->canceled++;
-                //Log::info() << "Job " << next._job.name << " canceled" << std::endl;
-            }
-
-            // release the group semaphore if necessary
-            if (next._groupsema != nullptr)
-            {
-                next._groupsema->release();
-            }
-
-            _metrics->running--;
+            execute(next);
         }
 
         // See if we no longer need this thread because the
@@ -658,7 +944,39 @@ job_scheduler::startThreads()
         _threads.push_back(std::thread([this]
             {
                 util::setThreadName(_name.c_str());
+
+                // claim a local deque for work-stealing mode
+                t_scheduler = this;
+                for (unsigned i = 0; i < _localQueues.size() && t_localQueue < 0; ++i)
+                {
+                    bool expected = false;
+                    if (_localQueues[i]->owned.compare_exchange_strong(expected, true))
+                    {
+                        t_localQueue = (int)i;
+                        unsigned used = _localQueuesUsed;
+                        while (used < i + 1 && !_localQueuesUsed.compare_exchange_weak(used, i + 1));
+                    }
+                }
+
                 run();
+
+                if (t_localQueue >= 0)
+                {
+                    // hand any leftover jobs to the peers before giving up the deque
+                    auto& queue = *_localQueues[t_localQueue];
+                    QueuedJob* item;
+                    while (!_done && (item = queue.pop()) != nullptr)
+                    {
+                        std::unique_lock lock(_queueMutex);
+                        _localPending--;
+                        _queue.emplace_back(std::move(*item));
+                        _queue.back()._seq = _nextSeq++;
+                        std::push_heap(_queue.begin(), _queue.end());
+                        _block.notify_one();
+                        delete item;
+                    }
+                    queue.owned = false;
+                }
             }
         ));
     }
@@ -671,17 +989,7 @@ void job_scheduler::stopThreads()
     // Clear out the queue
     {
         std::unique_lock lock(_queueMutex);
-
-        // reset any group semaphores so that job_group.join()
-        // will not deadlock.
-        for (auto& queuedjob : _queue)
-        {
-            if (queuedjob._groupsema != nullptr)
-            {
-                queuedjob._groupsema->reset();
-            }
-        }
-        _queue.clear();
+        discardQueuedJobs();
 
         // wake up all threads so they can exit
         _block.notify_all();
@@ -697,6 +1005,12 @@ void job_scheduler::stopThreads()
     }
 
     _threads.clear();
+
+    // discard anything the workers queued on their way out
+    {
+        std::unique_lock lock(_queueMutex);
+        discardQueuedJobs();
+    }
 }
 
 const std::vector<std::shared_ptr<job_metrics::scheduler_metrics>>&
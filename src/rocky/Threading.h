@@ -66,8 +66,8 @@ namespace ROCKY_NAMESPACE { namespace util
 
         //! Block until the event is set or the timout expires.
         //! Return true if the event has set, otherwise false.
-        template<typename T>
-        inline bool wait(std::chrono::duration<T> timeout) {
+        template<typename Rep, typename Period>
+        inline bool wait(std::chrono::duration<Rep, Period> timeout) {
             if (!_set) {
                 std::unique_lock<std::mutex> lock(_m);
                 if (!_set)
@@ -101,7 +101,7 @@ namespace ROCKY_NAMESPACE { namespace util
     protected:
         std::mutex _m; // do not use Mutex, we never want tracking
         std::condition_variable_any _cond;
-        bool _set;
+        std::atomic_bool _set;
     };
 
     /**
@@ -188,7 +188,7 @@ namespace ROCKY_NAMESPACE { namespace util
         T join() const {
             while (
                 !empty() &&
-                !_shared->ev.wait(std::chrono::milliseconds(1)));
+                !_shared->_ev.wait(std::chrono::milliseconds(1)));
             return value();
         }
 
@@ -199,7 +199,8 @@ namespace ROCKY_NAMESPACE { namespace util
             {
                 _shared->_ev.wait(std::chrono::milliseconds(1));
             }
-            return value();
+            // the result is still being written if the wait was canceled
+            return available() ? value() : T();
         }
 
         //! Release reference to a promise, resetting this future to its default state
@@ -351,6 +352,10 @@ namespace ROCKY_NAMESPACE { namespace util
         //! (It must first have left zero)
         void join(Cancelable& cancelable);
 
+        //! Block until the semaphore count returns to zero or the
+        //! timeout expires. Return true if the count reached zero.
+        bool join(std::chrono::steady_clock::duration timeout);
+
     private:
         int _count;
         std::condition_variable_any _cv;
@@ -399,6 +404,8 @@ namespace ROCKY_NAMESPACE { namespace util
         job_group(const std::string& name);
 
         //! Block until all jobs dispatched under this group are complete.
+        //! When called from a worker thread of a work-stealing scheduler,
+        //! the caller runs queued jobs while it waits.
         void join();
 
         //! Block until all jobs dispatched under this group are complete,
@@ -449,7 +456,10 @@ namespace ROCKY_NAMESPACE { namespace util
      *       job_scheduler::get("myPool"),  // which scheduler (thread pool) to run job in
      *       "job group name"               // group to run job in
      *     });
-     *       
+     *
+     * A job dispatched from inside another job (i.e., from a worker thread) on a
+     * scheduler in work-stealing mode goes to that worker's local deque instead
+     * of the shared queue; see job_scheduler::setWorkStealing.
      */
     struct ROCKY_EXPORT job
     {
@@ -584,6 +594,25 @@ namespace ROCKY_NAMESPACE { namespace util
         //! Discard all queued jobs
         void cancelAll();
 
+        //! How often to re-evaluate the priority functions of queued jobs.
+        //! Priorities are cached when a job is queued and refreshed in one batch
+        //! whenever this interval elapses; zero means refresh before every pop.
+        void setPriorityRefreshInterval(std::chrono::steady_clock::duration value);
+
+        //! How often queued job priorities get re-evaluated
+        std::chrono::steady_clock::duration getPriorityRefreshInterval() const;
+
+        //! Enable or disable work-stealing mode (default is off).
+        //! In this mode every worker thread owns a lock-free deque. Jobs that are
+        //! dispatched from one of this scheduler's worker threads go to that
+        //! worker's deque and ignore priority; idle workers steal from their
+        //! peers. Jobs dispatched from any other thread still go through the
+        //! shared priority queue.
+        void setWorkStealing(bool value);
+
+        //! Whether work-stealing mode is enabled
+        bool getWorkStealing() const;
+
         //! Schedule an asynchronous task on this scheduler
         //! Use job::dispatch to run jobs (usually no need to call this directly)
         //! @param job Job details
@@ -612,25 +641,66 @@ namespace ROCKY_NAMESPACE { namespace util
         //! Join and destroy all threads in this scheduler
         void stopThreads();
 
+        //! Drop every queued job, releasing its group semaphore and
+        //! counting it as canceled. Call with _queueMutex locked.
+        void discardQueuedJobs();
+
+        //! Re-evaluate the priority of every queued job and rebuild the heap.
+        //! Call with _queueMutex locked.
+        void refreshPriorities();
+
+        struct QueuedJob;
+        struct LocalQueue;
+
+        //! Pop a job from the calling worker's own deque, or steal one from a peer.
+        bool takeLocal(QueuedJob& out);
+
+        //! Run one job from the local deques on the calling worker thread.
+        //! Returns false if there was nothing to run.
+        bool help();
+
+        //! Run a dequeued job and update the metrics.
+        void execute(QueuedJob& job);
+
+        //! The scheduler owning the calling worker thread, or nullptr
+        static job_scheduler* current();
+
         struct QueuedJob {
             QueuedJob() { }
-            QueuedJob(const job& job, const std::function<bool()>& delegate, std::shared_ptr<Semaphore> sema) :
-                _job(job), _delegate(delegate), _groupsema(sema) { }
+            QueuedJob(const job& job, const std::function<bool()>& delegate, std::shared_ptr<Semaphore> sema, float priority, std::uint64_t seq) :
+                _job(job), _delegate(delegate), _groupsema(sema), _priority(priority), _seq(seq) { }
             job _job;
             std::function<bool()> _delegate;
             std::shared_ptr<Semaphore> _groupsema;
+            float _priority = 0.0f; // cached result of _job.priority()
+            std::uint64_t _seq = 0; // FIFO tie-breaker for equal priorities
+            // heap ordering: highest cached priority first, then oldest first
             bool operator < (const QueuedJob& rhs) const {
-                float lp = _job.priority ? _job.priority() : -FLT_MAX;
-                float rp = rhs._job.priority ? rhs._job.priority() : -FLT_MAX;
-                return lp < rp;
+                return _priority < rhs._priority || (_priority == rhs._priority && _seq > rhs._seq);
             }
         };
 
         // pool name
         std::string _name;
-        // queued operations to run asynchronously
+        // queued operations to run asynchronously, kept as a max-heap on cached priority
         using Queue = std::vector<QueuedJob>;
         Queue _queue;
+        // next job sequence number
+        std::uint64_t _nextSeq = 0;
+        // cadence at which queued priorities are re-evaluated
+        std::chrono::steady_clock::duration _priorityRefreshInterval;
+        // last time queued priorities were re-evaluated
+        std::chrono::steady_clock::time_point _lastPriorityRefresh;
+        // per-worker deques for work-stealing mode (fixed size, never reallocated)
+        std::vector<std::unique_ptr<LocalQueue>> _localQueues;
+        // number of deque slots ever claimed by a worker (thieves scan this many)
+        std::atomic<unsigned> _localQueuesUsed = 0u;
+        // number of jobs sitting in the local deques
+        std::atomic<int> _localPending = 0;
+        // number of workers blocked waiting for work
+        std::atomic<int> _sleepers = 0;
+        // whether dispatches from worker threads go to local deques
+        std::atomic<bool> _workStealing = false;
         // protect access to the queue
         mutable std::mutex _queueMutex;
         mutable std::mutex _quitMutex;
@@ -650,6 +720,7 @@ namespace ROCKY_NAMESPACE { namespace util
         static std::unordered_map<std::string, std::shared_ptr<job_scheduler>> _schedulers;
 
         friend struct job;
+        friend class job_group;
     };
 
 } } // namepsace rocky::util
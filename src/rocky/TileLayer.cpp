@@ -5,10 +5,15 @@
  */
 #include "TileLayer.h"
 #include "TileKey.h"
+#include "Image.h"
 #include "Map.h"
+#include "Utils.h"
 #include "rtree.h"
 #include "json.h"
 
+#include <cstring>
+#include <sstream>
+
 using namespace ROCKY_NAMESPACE;
 using namespace ROCKY_NAMESPACE::util;
 
@@ -17,6 +22,79 @@ using namespace ROCKY_NAMESPACE::util;
 namespace
 {
     using DataExtentsIndex = RTree<DataExtent, double, 2>;
+
+    // header preceding the pixel data of an image in the cache
+    struct CachedImageHeader
+    {
+        char magic[4] = { 'R', 'K', 'I', 'M' };
+        std::uint32_t compressed = 0;
+        std::uint32_t format = 0;
+        std::uint32_t width = 0;
+        std::uint32_t height = 0;
+        std::uint32_t depth = 0;
+    };
+
+    std::string makeTileCacheKey(const TileKey& key)
+    {
+        return key.profile().getHorizSignature() + "/" + key.str();
+    }
+
+    std::string encodeCachedImage(const Image* image)
+    {
+        CachedImageHeader header;
+        header.format = (std::uint32_t)image->pixelFormat();
+        header.width = image->width();
+        header.height = image->height();
+        header.depth = image->depth();
+
+        std::string pixels(image->data<char>(), image->sizeInBytes());
+
+#if defined(ZLIB_FOUND)
+        std::ostringstream buf;
+        if (ZLibCompressor().compress(pixels, buf))
+        {
+            header.compressed = 1;
+            pixels = buf.str();
+        }
+#endif
+
+        std::string data(sizeof(header), '\0');
+        std::memcpy(&data[0], &header, sizeof(header));
+        data.append(pixels);
+        return data;
+    }
+
+    shared_ptr<Image> decodeCachedImage(const std::string& data)
+    {
+        CachedImageHeader header, expected;
+        if (data.size() < sizeof(header))
+            return nullptr;
+
+        std::memcpy(&header, data.data(), sizeof(header));
+        if (std::memcmp(header.magic, expected.magic, sizeof(header.magic)) != 0 ||
+            header.format >= Image::NUM_PIXEL_FORMATS)
+            return nullptr;
+
+        std::string pixels = data.substr(sizeof(header));
+
+        if (header.compressed)
+        {
+#if defined(ZLIB_FOUND)
+            std::istringstream in(pixels);
+            if (!ZLibCompressor().decompress(in, pixels))
+                return nullptr;
+#else
+            return nullptr;
+#endif
+        }
+
+        auto image = Image::create((Image::PixelFormat)header.format, header.width, header.height, header.depth);
+        if (pixels.size() != image->sizeInBytes())
+            return nullptr;
+
+        std::memcpy(image->data<char>(), pixels.data(), pixels.size());
+        return image;
+    }
 }
 
 TileLayer::TileLayer() :
@@ -110,7 +188,7 @@ TileLayer::openImplementation(const IOOptions& io)
     auto result = super::openImplementation(io);
     if (result.ok())
     {
-        //todo
+        establishCacheSettings();
     }
     return result;
 }
@@ -188,7 +266,87 @@ TileLayer::openForWriting()
 void
 TileLayer::establishCacheSettings()
 {
-    //nop
+    if (_cacheid.has_value() && !_cacheid.value().empty())
+    {
+        _runtimeCacheId = _cacheid.value();
+    }
+    else
+    {
+        // Derive the ID from the serialized configuration, less any
+        // properties that do not affect the data itself.
+        auto j = parse_json(to_json());
+        j.erase("name");
+        j.erase("open");
+        j.erase("attribution");
+        j.erase("l2_cache_size");
+        j.erase("cache_id");
+        _runtimeCacheId = util::hashToString(j.dump());
+    }
+
+    _runtimeCachePolicy.clear();
+    if (hints().cachePolicy.has_value())
+    {
+        _runtimeCachePolicy = hints().cachePolicy.value();
+    }
+}
+
+CachePolicy
+TileLayer::effectiveCachePolicy() const
+{
+    CachePolicy policy = cachePolicy();
+    policy.mergeAndOverride(_runtimeCachePolicy);
+    return policy;
+}
+
+shared_ptr<Image>
+TileLayer::readCachedImage(const TileKey& key, bool& expired, const IOOptions& io) const
+{
+    expired = false;
+
+    auto cache = io.services.cache ? io.services.cache() : nullptr;
+    if (!cache || _runtimeCacheId.empty())
+        return nullptr;
+
+    auto policy = effectiveCachePolicy();
+    if (!policy.isCacheReadable())
+        return nullptr;
+
+    auto r = cache->read(_runtimeCacheId, makeTileCacheKey(key));
+    if (r.status.failed())
+        return nullptr;
+
+    auto image = decodeCachedImage(r.value.data);
+    if (image)
+    {
+        expired = policy.isExpired(r.value.lastModified);
+    }
+    else
+    {
+        // unreadable record; drop it so it gets rewritten
+        cache->remove(_runtimeCacheId, makeTileCacheKey(key));
+    }
+
+    return image;
+}
+
+void
+TileLayer::writeCachedImage(const TileKey& key, const Image* image, const IOOptions& io) const
+{
+    if (!image || !image->valid() || io.canceled())
+        return;
+
+    auto cache = io.services.cache ? io.services.cache() : nullptr;
+    if (!cache || _runtimeCacheId.empty())
+        return;
+
+    if (!effectiveCachePolicy().isCacheWriteable())
+        return;
+
+    auto status = cache->write(_runtimeCacheId, makeTileCacheKey(key), encodeCachedImage(image));
+    if (status.failed())
+    {
+        Log()->warn("[TileLayer] \"" + name().value() + "\" cache write failed: " + status.message);
+    }
 }
 
 const Profile&
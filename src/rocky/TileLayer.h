@@ -164,6 +164,21 @@ namespace ROCKY_NAMESPACE
         // cache key for metadata
         std::string getMetadataKey(const Profile&) const;
 
+        //! Cache policy in effect for this layer: the user policy
+        //! combined with any policy the layer established at runtime.
+        CachePolicy effectiveCachePolicy() const;
+
+        //! Reads the image for a tile key from the cache, if there is one.
+        //! @param key Tile key to read
+        //! @param expired Set to true if the record is older than the cache policy allows
+        //! @param io IO options providing the cache service
+        //! @return Cached image, or nullptr if there is none
+        shared_ptr<Image> readCachedImage(const TileKey& key, bool& expired, const IOOptions& io) const;
+
+        //! Writes the image for a tile key to the cache, if there is one
+        //! and the cache policy allows it.
+        void writeCachedImage(const TileKey& key, const Image* image, const IOOptions& io) const;
+
         optional<unsigned> _minLevel = 0;
         optional<unsigned> _maxLevel = 23;
         optional<double> _minResolution;
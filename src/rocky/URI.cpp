@@ -6,10 +6,15 @@
 #include "URI.h"
 #include "Utils.h"
 #include "Instance.h"
+#include "Threading.h"
 #include <typeinfo>
 #include <fstream>
 #include <sstream>
 #include <cstdlib>
+#include <algorithm>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
 
 #ifdef HTTPLIB_FOUND
 #ifdef OPENSSL_FOUND
@@ -119,7 +124,195 @@ namespace
         return true;
     }
 
-    IOResult<HTTPResponse> http_get(const HTTPRequest& request, unsigned max_attempts)
+    URI::HTTPMetrics& http_metrics()
+    {
+        static URI::HTTPMetrics metrics;
+        return metrics;
+    }
+
+    // Remote reads in progress, so that concurrent reads of the same
+    // location can share a single fetch.
+    struct InFlightReads
+    {
+        // Outcome of a shared read. A leader whose own read was canceled
+        // still resolves, with leaderCanceled set, so its waiters wake up
+        // and try again instead of waiting on a result that never comes.
+        struct Outcome
+        {
+            Result<Content> result;
+            bool leaderCanceled = false;
+        };
+
+        std::mutex mutex;
+        std::unordered_map<std::string, util::Future<Outcome>> reads;
+    };
+
+    InFlightReads& inFlightReads()
+    {
+        static InFlightReads inFlight;
+        return inFlight;
+    }
+
+#ifdef HTTPLIB_FOUND
+    /**
+     * Pool of persistent HTTP clients, keyed by protocol/host/port, shared
+     * by all threads. Each client holds one keep-alive connection and is
+     * used by one request at a time.
+     */
+    class HTTPConnectionPool
+    {
+    public:
+        struct Host
+        {
+            struct Idle
+            {
+                std::unique_ptr<httplib::Client> client;
+                std::chrono::steady_clock::time_point lastUsed;
+            };
+
+            std::mutex mutex;
+            std::condition_variable released;
+            std::vector<Idle> idle; // back is most recently used
+            unsigned inFlight = 0u;
+        };
+
+        //! Exclusive use of a client for the duration of one request.
+        //! The client returns to the pool on destruction if keep() was called.
+        class Lease
+        {
+        public:
+            Lease(HTTPConnectionPool& pool, Host* host, std::unique_ptr<httplib::Client> client) :
+                _pool(pool), _host(host), _client(std::move(client)) { }
+
+            Lease(Lease&& rhs) :
+                _pool(rhs._pool), _host(rhs._host), _client(std::move(rhs._client)), _keep(rhs._keep) {
+                rhs._host = nullptr;
+            }
+
+            ~Lease() {
+                if (!_keep)
+                    _client = nullptr;
+                if (_host)
+                    _pool.release(*_host, std::move(_client));
+            }
+
+            //! False if the request was canceled while waiting for a connection
+            explicit operator bool() const { return _client != nullptr; }
+
+            httplib::Client* operator -> () { return _client.get(); }
+
+            //! Return the connection to the pool for reuse
+            void keep() { _keep = true; }
+
+        private:
+            HTTPConnectionPool& _pool;
+            Host* _host;
+            std::unique_ptr<httplib::Client> _client;
+            bool _keep = false;
+        };
+
+        //! Take a client for a host, waiting if the host has too many requests in flight.
+        Lease acquire(Host& host, const std::string& proto_host_port, const Cancelable& cancelable)
+        {
+            auto s = settings();
+            auto now = std::chrono::steady_clock::now();
+
+            std::unique_lock lock(host.mutex);
+
+            while (host.inFlight >= std::max(1u, s.maxRequestsPerHost))
+            {
+                host.released.wait_for(lock, 10ms);
+                if (cancelable.canceled())
+                    return Lease(*this, nullptr, nullptr);
+            }
+            ++host.inFlight;
+
+            // discard connections that have been idle too long; the server
+            // has probably closed them already.
+            host.idle.erase(
+                std::remove_if(host.idle.begin(), host.idle.end(),
+                    [&](const Host::Idle& i) { return now - i.lastUsed > s.idleTimeout; }),
+                host.idle.end());
+
+            if (!host.idle.empty())
+            {
+                auto client = std::move(host.idle.back().client);
+                host.idle.pop_back();
+                ++http_metrics().connectionsReused;
+                return Lease(*this, &host, std::move(client));
+            }
+
+            lock.unlock();
+
+            auto client = std::make_unique<httplib::Client>(proto_host_port);
+
+            // follow redirects
+            client->set_follow_location(true);
+
+            // disable cert verification
+            client->enable_server_certificate_verification(false);
+
+            // keep the connection open for the next request unless pooling is off
+            client->set_keep_alive(s.maxIdleConnectionsPerHost > 0u);
+
+            ++http_metrics().connectionsOpened;
+            return Lease(*this, &host, std::move(client));
+        }
+
+        //! Return a client to the pool. Pass nullptr to drop a failed client.
+        void release(Host& host, std::unique_ptr<httplib::Client> client)
+        {
+            auto s = settings();
+            {
+                std::scoped_lock lock(host.mutex);
+                --host.inFlight;
+
+                if (client && s.maxIdleConnectionsPerHost > 0u)
+                {
+                    if (host.idle.size() >= s.maxIdleConnectionsPerHost)
+                        host.idle.erase(host.idle.begin());
+
+                    host.idle.push_back({ std::move(client), std::chrono::steady_clock::now() });
+                }
+            }
+            host.released.notify_one();
+        }
+
+        Host& host(const std::string& proto_host_port)
+        {
+            std::scoped_lock lock(_mutex);
+            auto& h = _hosts[proto_host_port];
+            if (!h)
+                h = std::make_unique<Host>();
+            return *h;
+        }
+
+        URI::HTTPPoolSettings settings() const
+        {
+            std::scoped_lock lock(_mutex);
+            return _settings;
+        }
+
+        void setSettings(const URI::HTTPPoolSettings& value)
+        {
+            std::scoped_lock lock(_mutex);
+            _settings = value;
+        }
+
+    private:
+        mutable std::mutex _mutex;
+        std::unordered_map<std::string, std::unique_ptr<Host>> _hosts;
+        URI::HTTPPoolSettings _settings;
+    };
+
+    HTTPConnectionPool& connectionPool()
+    {
+        static HTTPConnectionPool pool;
+        return pool;
+    }
+#endif
+
+    IOResult<HTTPResponse> http_get(const HTTPRequest& request, const IOOptions& io)
     {
 #ifndef HTTPLIB_FOUND
         return Status(Status::ServiceUnavailable);
@@ -142,31 +335,41 @@ namespace
 
         HTTPResponse response;
 
+        auto& pool = connectionPool();
+        auto& metrics = http_metrics();
+        auto& host = pool.host(proto_host_port);
+
         try
         {
-            httplib::Client client(proto_host_port);
-
-            // follow redirects
-            client.set_follow_location(true);
-
-            // disable cert verification
-            client.enable_server_certificate_verification(false);
-
-            max_attempts = std::max(1u, max_attempts);
+            unsigned max_attempts = std::max(1u, io.maxNetworkAttempts);
 
             for(;;)
             {
+                auto client = pool.acquire(host, proto_host_port, io);
+                if (!client)
+                {
+                    return Status(Status::ResourceUnavailable, "Canceled");
+                }
+
                 util::timer timer;
 
-                auto r = client.Get(path, params, headers);
+                auto r = client->Get(path, params, headers);
+
+                auto us = (std::uint64_t)(timer.seconds() * 1e6);
+                ++metrics.requests;
+                metrics.totalLatencyUs += us;
+                for (auto prev = metrics.maxLatencyUs.load(); us > prev && !metrics.maxLatencyUs.compare_exchange_weak(prev, us); );
 
                 if (httpDebug)
                 {
-                    Log()->info(LC "(" + std::to_string(r->status) + ") HTTP GET " + request.url + " (" + std::to_string(timer.seconds()) + "s)");
+                    Log()->info(LC "(" + std::to_string(r ? r->status : -1) + ") HTTP GET " + request.url + " (" + std::to_string(timer.seconds()) + "s)");
                 }
 
                 if (r.error() != httplib::Error::Success)
                 {
+                    // the lease drops the failed connection instead of reusing it
+                    ++metrics.failures;
+
                     // retry on a missing connection
                     if (r.error() == httplib::Error::Connection && (--max_attempts > 0))
                     {
@@ -178,6 +381,8 @@ namespace
                     return Status(Status::ServiceUnavailable, httplib::to_string(r.error()));
                 }
 
+                client.keep();
+
                 if (r->status == 404)
                 {
                     return Status(Status::ResourceUnavailable, httplib::status_message(r->status));
@@ -206,6 +411,32 @@ namespace
         return std::move(response);
 #endif
     }
+
+    IOResult<Content> read_from_server(const std::string& url, const IOOptions& io)
+    {
+        HTTPRequest request{ url };
+        auto r = http_get(request, io);
+        if (r.status.failed())
+        {
+            return IOResult<Content>::propagate(r);
+        }
+
+        std::string contentType;
+
+        auto i = r.value.headers.find("Content-Type");
+        if (i != r.value.headers.end())
+            contentType = i->second;
+        else
+            contentType = inferContentTypeFromFileExtension(url);
+
+        if (contentType.empty())
+            contentType = inferContentTypeFromData(r.value.data);
+
+        return Content{
+            contentType,
+            std::move(r.value.data)
+        };
+    }
 }
 
 //------------------------------------------------------------------------
@@ -296,16 +527,11 @@ URI::URI(const std::string& location, const URIContext& context)
 IOResult<Content>
 URI::read(const IOOptions& io) const
 {
-    auto cached = io.services.contentCache->get(full());
+    auto bin = io.property("layer");
+
+    auto cached = io.services.contentCache->get(full(), bin);
     if (cached.status.ok())
     {
-        if (httpDebug)
-        {
-            Log()->info("Cache hit, ratio = "
-                + std::to_string(100.0f * (float)io.services.contentCache->hits / (float)io.services.contentCache->gets)
-                + "%");
-        }
-
         return cached.value;
     }
 
@@ -327,28 +553,76 @@ URI::read(const IOOptions& io) const
 
     else if (containsServerAddress(full()))
     {
-        HTTPRequest request{ full() };
-        auto r = http_get(request, io.maxNetworkAttempts);
-        if (r.status.failed())
+        // Coalesce concurrent reads of the same location: the first caller
+        // fetches the content and the others wait for its result.
+        auto& inFlight = inFlightReads();
+        util::Future<InFlightReads::Outcome> fetch;
+        for (;;)
         {
-            return IOResult<Content>::propagate(r);
+            bool leader = false;
+            {
+                std::scoped_lock lock(inFlight.mutex);
+                auto i = inFlight.reads.find(full());
+                if (i == inFlight.reads.end())
+                {
+                    fetch = util::Future<InFlightReads::Outcome>();
+                    inFlight.reads.emplace(full(), fetch);
+                    leader = true;
+                }
+                else
+                {
+                    fetch = i->second;
+                }
+            }
+
+            if (leader)
+                break;
+
+            ++http_metrics().requestsCoalesced;
+
+            auto outcome = fetch.join(io);
+            if (fetch.available() && !outcome.leaderCanceled)
+            {
+                if (outcome.result.status.failed())
+                    return IOResult<Content>(outcome.result.status);
+                return outcome.result.value;
+            }
+
+            if (io.canceled())
+            {
+                IOResult<Content> canceled(Status(Status::ResourceUnavailable, "Canceled"));
+                canceled.ioCode = IOResult<Content>::RESULT_CANCELED;
+                return canceled;
+            }
+
+            // the leading read was canceled before it finished; try again.
         }
 
-        std::string contentType;
+        auto r = read_from_server(full(), io);
 
-        auto i = r.value.headers.find("Content-Type");
-        if (i != r.value.headers.end())
-            contentType = i->second;
+        if (r.status.ok())
+        {
+            io.services.contentCache->put(full(), r.value, bin);
+        }
+
+        // A read that failed because it was canceled says nothing about the
+        // content, so tell the waiters to try again themselves.
+        InFlightReads::Outcome outcome;
+        if (r.status.ok())
+            outcome.result = r.value;
+        else if (io.canceled())
+            outcome.leaderCanceled = true;
         else
-            contentType = inferContentTypeFromFileExtension(full());
+            outcome.result = r.status;
 
-        if (contentType.empty())
-            contentType = inferContentTypeFromData(r.value.data);
+        {
+            std::scoped_lock lock(inFlight.mutex);
+            inFlight.reads.erase(full());
+        }
 
-        content = {
-            contentType,
-            r.value.data
-        };
+        fetch.resolve(outcome);
+
+        return r;
     }
     else
     {
@@ -357,11 +631,35 @@ URI::read(const IOOptions& io) const
             util::make_string() << "Cannot open \"" << full() << "\""));
     }
 
-    io.services.contentCache->put(full(), Result<Content>(content));
+    io.services.contentCache->put(full(), content, bin);
 
     return content;
 }
 
+void
+URI::setHTTPPoolSettings(const HTTPPoolSettings& value)
+{
+#ifdef HTTPLIB_FOUND
+    connectionPool().setSettings(value);
+#endif
+}
+
+URI::HTTPPoolSettings
+URI::httpPoolSettings()
+{
+#ifdef HTTPLIB_FOUND
+    return connectionPool().settings();
+#else
+    return { };
+#endif
+}
+
+const URI::HTTPMetrics&
+URI::httpMetrics()
+{
+    return http_metrics();
+}
+
 bool
 URI::isRemote() const
 {
@@ -8,6 +8,8 @@
 #include <rocky/Common.h>
 #include <rocky/IOTypes.h>
 
+#include <atomic>
+#include <chrono>
 #include <iostream>
 #include <string>
 
@@ -64,6 +66,41 @@ namespace ROCKY_NAMESPACE
         //! Whether HTTPS support is available
         static bool supportsHTTPS();
 
+        //! Settings for the persistent HTTP connections that all threads
+        //! share when reading from the same host.
+        struct HTTPPoolSettings
+        {
+            //! Maximum number of idle connections to keep open per host;
+            //! zero disables keep-alive.
+            unsigned maxIdleConnectionsPerHost = 8u;
+
+            //! Idle connections unused for this long are closed
+            std::chrono::steady_clock::duration idleTimeout = std::chrono::seconds(30);
+
+            //! Maximum number of concurrent requests to one host;
+            //! additional requests wait for a connection to free up.
+            unsigned maxRequestsPerHost = 8u;
+        };
+
+        //! Configure the HTTP connection pool
+        static void setHTTPPoolSettings(const HTTPPoolSettings&);
+        static HTTPPoolSettings httpPoolSettings();
+
+        //! Running totals for HTTP requests
+        struct HTTPMetrics
+        {
+            std::atomic<std::uint64_t> requests = { 0 };
+            std::atomic<std::uint64_t> failures = { 0 };
+            std::atomic<std::uint64_t> connectionsOpened = { 0 };
+            std::atomic<std::uint64_t> connectionsReused = { 0 };
+            std::atomic<std::uint64_t> requestsCoalesced = { 0 }; // served by another caller's request
+            std::atomic<std::uint64_t> totalLatencyUs = { 0 };
+            std::atomic<std::uint64_t> maxLatencyUs = { 0 };
+        };
+
+        //! HTTP request metrics since startup
+        static const HTTPMetrics& httpMetrics();
+
         //! Holds a stream for reading content data.
         struct ROCKY_EXPORT Stream
         {
@@ -1,10 +1,14 @@
 #pragma once
 #include "rtree.h"
 #include <cmath>
+#include <cfloat>
 #include <climits>
+#include <algorithm>
+#include <vector>
 #include <map>
 #include <unordered_map>
 #include <iterator>
+#include <list>
 #include <set>
 #include <unordered_set>
 
@@ -742,6 +746,554 @@ namespace weemesh
         }
     };
 
+    // compact triangle record for flat_mesh_t. Corners live in the
+    // mesh's vertex arrays and are referenced by index only.
+    struct flat_triangle_t
+    {
+        unsigned i0, i1, i2; // indices
+        UID seq; // creation order
+        vert_t::value_type a_min[2]; // bbox min
+        vert_t::value_type a_max[2]; // bbox max
+        bool is_2d_degenerate;
+        bool alive;
+    };
+
+    // Index-based mesh that produces the same triangulation as mesh_t, up
+    // until the 16-bit vertex limit. When either mesh runs out of vertices
+    // it stops partway through a segment, and which triangles it had cut by
+    // then depends on the order its spatial index visits them, so from that
+    // point on the two cover the same area with somewhat different triangles.
+    // Vertices are stored as separate coordinate arrays, triangles in a
+    // vector whose freed slots are recycled, and a uniform grid over the
+    // triangle bounding boxes replaces the R-tree for point and segment
+    // location.
+    struct flat_mesh_t
+    {
+        // vertices
+        std::vector<vert_t::value_type> xs, ys, zs;
+        std::vector<int> markers;
+
+        // triangles; check "alive" when iterating
+        std::vector<flat_triangle_t> triangles;
+
+        vert_t::value_type epsilon = DEFAULT_EPSILON;
+
+        struct vert_key_hash {
+            std::size_t operator()(const std::pair<vert_t::value_type, vert_t::value_type>& k) const {
+                std::size_t h = std::hash<vert_t::value_type>()(k.first);
+                return h ^ (std::hash<vert_t::value_type>()(k.second) + 0x9e3779b9 + (h << 6) + (h >> 2));
+            }
+        };
+
+        // vertices are unique in XY, like mesh_t's vert_table_t
+        std::unordered_map<std::pair<vert_t::value_type, vert_t::value_type>, int, vert_key_hash> _vert_lut;
+
+        std::vector<UID> _free;
+        std::size_t _num_alive = 0;
+        UID _seqgen = 0;
+        int _num_edits = 0;
+        int _boundary_marker = 1;
+        int _constraint_marker = 16;
+        int _has_elevation_marker = 4;
+
+        // spatial grid; each cell lists the triangles whose bbox overlaps it.
+        // Boxes outside the grid clamp to the border cells, so the grid
+        // never needs to cover the whole mesh to stay correct.
+        struct grid_t
+        {
+            vert_t::value_type xmin = 0, ymin = 0, inv_w = 0, inv_h = 0;
+            int cols = 0, rows = 0;
+            std::vector<std::vector<UID>> cells;
+
+            inline void range(const vert_t::value_type* a_min, const vert_t::value_type* a_max,
+                int& c0, int& r0, int& c1, int& r1) const
+            {
+                c0 = cell(a_min[0] - xmin, inv_w, cols);
+                r0 = cell(a_min[1] - ymin, inv_h, rows);
+                c1 = cell(a_max[0] - xmin, inv_w, cols);
+                r1 = cell(a_max[1] - ymin, inv_h, rows);
+            }
+
+            static inline int cell(vert_t::value_type offset, vert_t::value_type inv_size, int count)
+            {
+                return (int)clamp(std::floor(offset * inv_size), 0.0, (vert_t::value_type)(count - 1));
+            }
+        } _grid;
+
+        std::vector<UID> _stamps; // per triangle, for de-duplicating grid hits
+        UID _query = 0;
+
+        // number of triangles per grid cell that triggers a finer grid
+        const std::size_t max_triangles_per_cell = 8;
+
+        const double one_third = 1.0 / 3.0;
+
+        void set_boundary_marker(int value)
+        {
+            _boundary_marker = value;
+        }
+
+        void set_constraint_marker(int value)
+        {
+            _constraint_marker = value;
+        }
+
+        void set_has_elevation_marker(int value)
+        {
+            _has_elevation_marker = value;
+        }
+
+        // number of live triangles
+        std::size_t num_triangles() const
+        {
+            return _num_alive;
+        }
+
+        // number of vertices
+        std::size_t num_verts() const
+        {
+            return xs.size();
+        }
+
+        // copy of a vertex by its index
+        vert_t get_vertex(unsigned i) const
+        {
+            return vert_t(xs[i], ys[i], zs[i]);
+        }
+
+        // find the marker for a vertex index
+        int get_marker(int i)
+        {
+            return markers[i];
+        }
+
+        // the triangle as a triangle_t, for its geometric tests
+        triangle_t get_corners(const flat_triangle_t& tri) const
+        {
+            triangle_t t;
+            t.uid = tri.seq;
+            t.i0 = tri.i0, t.i1 = tri.i1, t.i2 = tri.i2;
+            t.p0 = get_vertex(tri.i0);
+            t.p1 = get_vertex(tri.i1);
+            t.p2 = get_vertex(tri.i2);
+            return t;
+        }
+
+        // delete triangle from the mesh
+        void remove_triangle(UID uid)
+        {
+            auto& tri = triangles[uid];
+            if (!tri.alive)
+                return;
+
+            if (!_grid.cells.empty())
+                grid_remove(uid);
+
+            tri.alive = false;
+            _free.push_back(uid);
+            --_num_alive;
+
+            ++_num_edits;
+        }
+
+        // add new triangle to the mesh from 3 indices; returns -1 if the
+        // indices do not form a triangle
+        int add_triangle(int i0, int i1, int i2)
+        {
+            if (i0 == i1 || i1 == i2 || i2 == i0)
+                return -1;
+
+            UID uid;
+            if (!_free.empty())
+            {
+                uid = _free.back();
+                _free.pop_back();
+            }
+            else
+            {
+                uid = (UID)triangles.size();
+                triangles.emplace_back();
+                _stamps.push_back(0);
+            }
+
+            vert_t p0 = get_vertex(i0), p1 = get_vertex(i1), p2 = get_vertex(i2);
+
+            flat_triangle_t& tri = triangles[uid];
+            tri.i0 = i0;
+            tri.i1 = i1;
+            tri.i2 = i2;
+            tri.seq = _seqgen++;
+            tri.a_min[0] = std::min(p0.x, std::min(p1.x, p2.x));
+            tri.a_min[1] = std::min(p0.y, std::min(p1.y, p2.y));
+            tri.a_max[0] = std::max(p0.x, std::max(p1.x, p2.x));
+            tri.a_max[1] = std::max(p0.y, std::max(p1.y, p2.y));
+            tri.alive = true;
+
+            // same test as mesh_t::add_triangle
+            tri.is_2d_degenerate =
+                same_vert(p0, p1, epsilon) ||
+                same_vert(p1, p2, epsilon) ||
+                same_vert(p2, p0, epsilon) ||
+                same_vert((p1 - p0).normalize2d(), (p2 - p0).normalize2d(), epsilon) ||
+                same_vert((p2 - p1).normalize2d(), (p0 - p1).normalize2d(), epsilon) ||
+                same_vert((p0 - p2).normalize2d(), (p1 - p2).normalize2d(), epsilon);
+
+            ++_num_alive;
+            if (!_grid.cells.empty())
+                grid_insert(uid);
+
+            ++_num_edits;
+
+            return (int)uid;
+        }
+
+        // Add a new vertex (or lookup a matching one) and return its index.
+        // If the vertex already exists, update its marker if necessary.
+        int get_or_create_vertex(const vert_t& input, int marker)
+        {
+            auto i = _vert_lut.find({ input.x, input.y });
+            if (i != _vert_lut.end())
+            {
+                markers[i->second] |= marker;
+                return i->second;
+            }
+            else if (xs.size() + 1 < 0xFFFF)
+            {
+                int index = (int)xs.size();
+                xs.push_back(input.x);
+                ys.push_back(input.y);
+                zs.push_back(input.z);
+                markers.push_back(marker);
+                _vert_lut.emplace(std::make_pair(input.x, input.y), index);
+                return index;
+            }
+            else
+            {
+                return -1;
+            }
+        }
+
+        template<class T>
+        int get_or_create_vertex_from_vec3(const T& vec, int marker) {
+            return get_or_create_vertex(vert_t(vec.x, vec.y, vec.z), marker);
+        }
+
+        // fetch the index of each triangle that intersects the bounding box,
+        // in creation order
+        unsigned get_triangles(vert_t::value_type xmin, vert_t::value_type ymin, vert_t::value_type xmax, vert_t::value_type ymax,
+            std::vector<UID>& output)
+        {
+            vert_t::value_type a_min[2] = { xmin, ymin };
+            vert_t::value_type a_max[2] = { xmax, ymax };
+            search(a_min, a_max, output);
+            return output.size();
+        }
+
+        // insert a point into the mesh, cutting triangles as necessary
+        void insert(const vert_t& vert, int marker)
+        {
+            vert_t::value_type a_min[2] = { vert.x, vert.y };
+            vert_t::value_type a_max[2] = { vert.x, vert.y };
+
+            std::vector<UID> uids;
+            search(a_min, a_max, uids);
+
+            for (auto uid : uids)
+            {
+                if (!triangles[uid].alive || triangles[uid].is_2d_degenerate)
+                    continue;
+
+                auto tri = get_corners(triangles[uid]);
+                if (tri.contains_2d(vert, epsilon))
+                {
+                    inside_split(uid, tri, vert, nullptr, marker);
+                    // dont't break -- could split two triangles if on edge.
+                }
+            }
+        }
+
+        // insert a segment into the mesh, cutting triangles as necessary
+        void insert(const segment_t& seg, int marker)
+        {
+            vert_t::value_type a_min[2];
+            vert_t::value_type a_max[2];
+            a_min[0] = std::min(seg.first.x, seg.second.x);
+            a_min[1] = std::min(seg.first.y, seg.second.y);
+            a_max[0] = std::max(seg.first.x, seg.second.x);
+            a_max[1] = std::max(seg.first.y, seg.second.y);
+
+            // working set, same as in mesh_t::insert; split triangles append
+            // their replacements, which are visited later in the same pass
+            std::vector<UID> work;
+            search(a_min, a_max, work);
+
+            for (std::size_t k = 0; k < work.size(); ++k)
+            {
+                UID uid = work[k];
+                if (!triangles[uid].alive || triangles[uid].is_2d_degenerate)
+                    continue;
+
+                // by value: adding triangles may reallocate the vector
+                const triangle_t tri = get_corners(triangles[uid]);
+
+                if (tri.contains_2d(seg.first, epsilon))
+                {
+                    if (inside_split(uid, tri, seg.first, &work, marker))
+                        continue;
+                }
+
+                if (tri.contains_2d(seg.second, epsilon))
+                {
+                    if (inside_split(uid, tri, seg.second, &work, marker))
+                        continue;
+                }
+
+                // try each edge in turn; (a, b) is the crossed edge and c
+                // the opposite corner.
+                const unsigned edges[3][3] = {
+                    { tri.i0, tri.i1, tri.i2 },
+                    { tri.i1, tri.i2, tri.i0 },
+                    { tri.i2, tri.i0, tri.i1 } };
+
+                bool split = false;
+                for (int e = 0; e < 3 && !split; ++e)
+                {
+                    unsigned a = edges[e][0], b = edges[e][1], c = edges[e][2];
+                    vert_t out;
+                    vert_t::value_type u;
+
+                    segment_t edge(get_vertex(a), get_vertex(b));
+                    if (!seg.intersect(edge, out, u) || tri.is_vertex(out, epsilon))
+                        continue;
+
+                    int new_marker = marker;
+                    if ((markers[a] & _boundary_marker) && (markers[b] & _boundary_marker))
+                        new_marker |= _boundary_marker;
+
+                    int new_i = get_or_create_vertex(out, new_marker);
+                    if (new_i < 0)
+                        return;
+
+                    int new_tris = 0;
+
+                    int new_uid = add_triangle(new_i, c, a);
+                    if (new_uid >= 0) {
+                        markers[c] |= _constraint_marker;
+                        markers[a] |= _constraint_marker;
+                        work.push_back(new_uid);
+                        ++new_tris;
+                    }
+
+                    new_uid = add_triangle(new_i, b, c);
+                    if (new_uid >= 0) {
+                        markers[b] |= _constraint_marker;
+                        markers[c] |= _constraint_marker;
+                        work.push_back(new_uid);
+                        ++new_tris;
+                    }
+
+                    if (new_tris > 0)
+                    {
+                        if (marker_not_set(new_i, _has_elevation_marker) &&
+                            marker_is_set(a, _has_elevation_marker) && marker_is_set(b, _has_elevation_marker))
+                        {
+                            auto z0 = zs[a], z1 = zs[b];
+                            zs[new_i] = z0 + u * (z1 - z0);
+                            set_marker(new_i, _has_elevation_marker);
+                        }
+
+                        remove_triangle(uid);
+                        split = true;
+                    }
+                }
+            }
+        }
+
+        // inserts point "p" into the interior of triangle "uid",
+        // adds three new triangles, and removes the original triangle.
+        // return true if a split actual happened
+        bool inside_split(UID uid, const triangle_t& tri, const vert_t& p, std::vector<UID>* work, int new_marker)
+        {
+            int new_i = get_or_create_vertex(p, new_marker);
+            if (new_i < 0)
+                return false;
+
+            if (tri.is_vertex(new_i))
+                return false;
+
+            vert_t bary(1, 1, 1);
+            if (tri.get_barycentric(p, bary, epsilon) == false)
+                return false;
+
+            int new_uid;
+            int new_tris = 0;
+
+            if (!equivalent(bary[2], 0.0, epsilon)) {
+                new_uid = add_triangle(tri.i0, tri.i1, new_i);
+                if (new_uid >= 0 && work) {
+                    markers[tri.i0] |= _constraint_marker;
+                    markers[tri.i1] |= _constraint_marker;
+                    work->push_back(new_uid);
+                    ++new_tris;
+                }
+            }
+
+            if (!equivalent(bary[0], 0.0, epsilon)) {
+                new_uid = add_triangle(tri.i1, tri.i2, new_i);
+                if (new_uid >= 0 && work) {
+                    markers[tri.i1] |= _constraint_marker;
+                    markers[tri.i2] |= _constraint_marker;
+                    work->push_back(new_uid);
+                    ++new_tris;
+                }
+            }
+
+            if (!equivalent(bary[1], 0.0, epsilon)) {
+                new_uid = add_triangle(tri.i2, tri.i0, new_i);
+                if (new_uid >= 0 && work) {
+                    markers[tri.i2] |= _constraint_marker;
+                    markers[tri.i0] |= _constraint_marker;
+                    work->push_back(new_uid);
+                    ++new_tris;
+                }
+            }
+
+            if (new_tris > 0)
+            {
+                if (marker_not_set(new_i, _has_elevation_marker) &&
+                    marker_is_set(tri.i0, _has_elevation_marker) &&
+                    marker_is_set(tri.i1, _has_elevation_marker) &&
+                    marker_is_set(tri.i2, _has_elevation_marker))
+                {
+                    zs[new_i] =
+                        zs[tri.i0] * bary[0] +
+                        zs[tri.i1] * bary[1] +
+                        zs[tri.i2] * bary[2];
+
+                    set_marker(new_i, _has_elevation_marker);
+                }
+
+                remove_triangle(uid);
+            }
+
+            return (new_tris > 0);
+        }
+
+        vert_t point_on_edge_closest_to(const edge_t& edge, const vert_t& p) const {
+            vert_t e1 = get_vertex(edge._i0);
+            vert_t e2 = get_vertex(edge._i1);
+            vert_t qp = e2 - e1;
+            vert_t xp = p - e1;
+            double u = xp.dot2d(qp) / qp.dot2d(qp);
+            if (u < 0.0) return e1;
+            else if (u > 1.0) return e2;
+            else return e1 + qp * u;
+        }
+
+        // live triangles whose bbox overlaps the query box, in creation
+        // order so that edits happen in a deterministic sequence
+        void search(const vert_t::value_type* a_min, const vert_t::value_type* a_max, std::vector<UID>& output)
+        {
+            output.clear();
+
+            if (_grid.cells.empty() || _num_alive > max_triangles_per_cell * _grid.cells.size())
+                build_grid();
+
+            if (++_query == 0)
+            {
+                std::fill(_stamps.begin(), _stamps.end(), 0);
+                _query = 1;
+            }
+
+            int c0, r0, c1, r1;
+            _grid.range(a_min, a_max, c0, r0, c1, r1);
+
+            for (int r = r0; r <= r1; ++r)
+            {
+                for (int c = c0; c <= c1; ++c)
+                {
+                    for (auto uid : _grid.cells[r * _grid.cols + c])
+                    {
+                        if (_stamps[uid] == _query)
+                            continue;
+                        _stamps[uid] = _query;
+
+                        auto& tri = triangles[uid];
+                        if (tri.a_max[0] >= a_min[0] && tri.a_min[0] <= a_max[0] &&
+                            tri.a_max[1] >= a_min[1] && tri.a_min[1] <= a_max[1])
+                        {
+                            output.push_back(uid);
+                        }
+                    }
+                }
+            }
+
+            std::sort(output.begin(), output.end(), [this](UID a, UID b) {
+                return triangles[a].seq < triangles[b].seq; });
+        }
+
+        // (re)size the grid to the live triangles and populate it
+        void build_grid()
+        {
+            vert_t::value_type a_min[2] = { DBL_MAX, DBL_MAX };
+            vert_t::value_type a_max[2] = { -DBL_MAX, -DBL_MAX };
+            for (auto& tri : triangles)
+            {
+                if (!tri.alive) continue;
+                a_min[0] = std::min(a_min[0], tri.a_min[0]);
+                a_min[1] = std::min(a_min[1], tri.a_min[1]);
+                a_max[0] = std::max(a_max[0], tri.a_max[0]);
+                a_max[1] = std::max(a_max[1], tri.a_max[1]);
+            }
+
+            int side = clamp((int)std::sqrt((double)_num_alive), 1, 1024);
+            vert_t::value_type w = a_max[0] - a_min[0], h = a_max[1] - a_min[1];
+
+            _grid.cols = _grid.rows = side;
+            _grid.xmin = _num_alive > 0 ? a_min[0] : 0.0;
+            _grid.ymin = _num_alive > 0 ? a_min[1] : 0.0;
+            _grid.inv_w = w > 0.0 ? (double)side / w : 0.0;
+            _grid.inv_h = h > 0.0 ? (double)side / h : 0.0;
+            _grid.cells.assign(side * side, {});
+
+            for (UID uid = 0; uid < triangles.size(); ++uid)
+            {
+                if (triangles[uid].alive)
+                    grid_insert(uid);
+            }
+        }
+
+        void grid_insert(UID uid)
+        {
+            auto& tri = triangles[uid];
+            int c0, r0, c1, r1;
+            _grid.range(tri.a_min, tri.a_max, c0, r0, c1, r1);
+            for (int r = r0; r <= r1; ++r)
+                for (int c = c0; c <= c1; ++c)
+                    _grid.cells[r * _grid.cols + c].push_back(uid);
+        }
+
+        void grid_remove(UID uid)
+        {
+            auto& tri = triangles[uid];
+            int c0, r0, c1, r1;
+            _grid.range(tri.a_min, tri.a_max, c0, r0, c1, r1);
+            for (int r = r0; r <= r1; ++r)
+            {
+                for (int c = c0; c <= c1; ++c)
+                {
+                    auto& cell = _grid.cells[r * _grid.cols + c];
+                    auto i = std::find(cell.begin(), cell.end(), uid);
+                    if (i != cell.end())
+                    {
+                        *i = cell.back();
+                        cell.pop_back();
+                    }
+                }
+            }
+        }
+    };
+
     // a graph node
     struct node_t
     {
@@ -61,6 +61,40 @@ namespace
             }
         }
     }
+
+    // Parent of a render graph that times its record traversal, so we can
+    // report a per-view breakdown of the frame's record time.
+    class RecordTimer : public vsg::Inherit<vsg::Group, RecordTimer>
+    {
+    public:
+        RecordTimer(vsg::ref_ptr<vsg::RenderGraph> renderGraph)
+        {
+            addChild(renderGraph);
+
+            if (!renderGraph->children.empty())
+            {
+                auto view = renderGraph->children[0].cast<vsg::View>();
+                if (view)
+                {
+                    viewID = view->viewID;
+                    hasView = true;
+                }
+            }
+        }
+
+        std::uint32_t viewID = 0;
+        bool hasView = false;
+        mutable std::chrono::microseconds elapsed{ 0 };
+
+        using vsg::Group::traverse;
+
+        void traverse(vsg::RecordTraversal& rt) const override
+        {
+            auto start = std::chrono::steady_clock::now();
+            vsg::Group::traverse(rt);
+            elapsed = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start);
+        }
+    };
 }
 
 Application::Application(int& argc, char** argv) :
@@ -72,7 +106,7 @@ Application::Application(int& argc, char** argv) :
     _debuglayer = commandLine.read({ "--debug" });
     _apilayer = commandLine.read({ "--api" });
     _vsync = !commandLine.read({ "--novsync" });
-    //_multithreaded = commandLine.read({ "--mt" });
+    _multithreaded = commandLine.read({ "--mt" });
 
     viewer = vsg::Viewer::create();
 
@@ -272,11 +306,6 @@ Application::addWindow(vsg::ref_ptr<vsg::WindowTraits> traits)
 
         result.resolve(window);
 
-        //if (_multithreaded)
-        //{
-        //    viewer->setupThreading();
-        //}
-
         if (_viewerRealized)
         {
             _viewerDirty = true;
@@ -337,19 +366,12 @@ Application::addView(
         auto iter = _commandGraphByWindow.find(window);
         if (iter != _commandGraphByWindow.end())
         {
-            commandgraph = iter->second;
-
             if (view->children.empty())
             {
                 view->addChild(root);
             }
 
-            auto rendergraph = vsg::RenderGraph::create(window, view);
-            rendergraph->setClearValues({ {0.1f, 0.12f, 0.15f, 1.0f} });
-            commandgraph->addChild(rendergraph);
-
-            auto& viewdata = _viewData[view];
-            viewdata.parentRenderGraph = rendergraph;
+            commandgraph = attachView(window, view);
 
             displayConfiguration.windows[window].emplace_back(view);
         }
@@ -392,6 +414,38 @@ Application::getWindow(vsg::ref_ptr<vsg::View> view)
     return {};
 }
 
+vsg::ref_ptr<vsg::CommandGraph>
+Application::attachView(vsg::ref_ptr<vsg::Window> window, vsg::ref_ptr<vsg::View> view)
+{
+    auto commandgraph = getCommandGraph(window);
+
+    // When multithreaded, each view after the window's first one records
+    // into its own command graph so VSG can record them in parallel.
+    if (_multithreaded && !commandgraph->children.empty())
+    {
+        commandgraph = vsg::CommandGraph::create(window);
+        _viewCommandGraphs.push_back(commandgraph);
+
+        // Views on the same window now record the terrain concurrently too.
+        mapNode->terrainSettings().supportMultiThreadedRecord = true;
+    }
+
+    auto rendergraph = vsg::RenderGraph::create(window, view);
+    rendergraph->setClearValues({ {0.1f, 0.12f, 0.15f, 1.0f} });
+
+    auto timer = RecordTimer::create(rendergraph);
+    commandgraph->addChild(timer);
+    _recordTimers.push_back(timer);
+
+    // remember so we can remove it later
+    auto& viewdata = _viewData[view];
+    viewdata.parentRenderGraph = rendergraph;
+    viewdata.commandGraph = commandgraph;
+    viewdata.recordTimer = timer;
+
+    return commandgraph;
+}
+
 void
 Application::addViewAfterViewerIsRealized(
     vsg::ref_ptr<vsg::Window> window,
@@ -409,19 +463,22 @@ Application::addViewAfterViewerIsRealized(
     }
 
     // find the command graph for this window:
-    auto commandgraph = getCommandGraph(window);
-    if (commandgraph)
+    vsg::ref_ptr<vsg::CommandGraph> commandgraph;
+    if (getCommandGraph(window))
     {
         // new view needs a new rendergraph:
-        auto rendergraph = vsg::RenderGraph::create(window, view);
-        rendergraph->setClearValues({ {0.1f, 0.12f, 0.15f, 1.0f} });
-        commandgraph->addChild(rendergraph);
+        commandgraph = attachView(window, view);
 
-        activateRenderGraph(rendergraph, window, viewer);
+        if (commandgraph == getCommandGraph(window))
+        {
+            activateRenderGraph(_viewData[view].parentRenderGraph, window, viewer);
+        }
+        else
+        {
+            // a new command graph means new record tasks, so rebuild the viewer.
+            _viewerDirty = true;
+        }
 
-        // remember so we can remove it later
-        auto& viewdata = _viewData[view];
-        viewdata.parentRenderGraph = rendergraph;
         displayConfiguration.windows[window].emplace_back(view);
 
         // Add a manipulator - we might not do this by default - check back.
@@ -448,17 +505,25 @@ Application::removeView(vsg::ref_ptr<vsg::View> view)
         auto window = getWindow(view);
         ROCKY_SOFT_ASSERT_AND_RETURN(window != nullptr, void());
 
-        auto commandgraph = getCommandGraph(window);
-        ROCKY_SOFT_ASSERT_AND_RETURN(commandgraph, void());
-
         // find the rendergraph hosting the view:
         auto vd = _viewData.find(view);
         ROCKY_SOFT_ASSERT_AND_RETURN(vd != _viewData.end(), void());
-        auto& rendergraph = vd->second.parentRenderGraph;
+        auto& commandgraph = vd->second.commandGraph;
+        ROCKY_SOFT_ASSERT_AND_RETURN(commandgraph, void());
+        auto& timer = vd->second.recordTimer;
 
         // remove the rendergraph from the command graph.
         auto& rps = commandgraph->children;
-        rps.erase(std::remove(rps.begin(), rps.end(), rendergraph), rps.end());
+        rps.erase(std::remove(rps.begin(), rps.end(), timer), rps.end());
+        _recordTimers.erase(std::remove(_recordTimers.begin(), _recordTimers.end(), timer), _recordTimers.end());
+
+        // a view with its own command graph takes the command graph with it.
+        if (commandgraph != getCommandGraph(window))
+        {
+            auto& cgs = _viewCommandGraphs;
+            cgs.erase(std::remove(cgs.begin(), cgs.end(), commandgraph), cgs.end());
+            _viewerDirty = _viewerRealized;
+        }
 
         // remove it from our tracking tables.
         _viewData.erase(view);
@@ -515,11 +580,28 @@ Application::addPreRenderGraph(vsg::ref_ptr<vsg::Window> window, vsg::ref_ptr<vs
         ROCKY_SOFT_ASSERT_AND_RETURN(commandGraph, void());
         ROCKY_SOFT_ASSERT_AND_RETURN(commandGraph->children.size() > 0, void());
 
-        // Insert the pre-render graph into the command graph.
-        commandGraph->children.insert(commandGraph->children.begin(), renderGraph);
+        auto timer = RecordTimer::create(renderGraph);
+        _recordTimers.push_back(timer);
+
+        if (_multithreaded)
+        {
+            // Record the pre-render graph in parallel in its own command graph,
+            // submitted ahead of the window's views.
+            auto preRenderCommandGraph = vsg::CommandGraph::create(window);
+            preRenderCommandGraph->addChild(timer);
+            _preRenderCommandGraphs.push_back(preRenderCommandGraph);
+
+            // new record tasks; the rebuilt viewer will compile it.
+            _viewerDirty = _viewerRealized;
+        }
+        else
+        {
+            // Insert the pre-render graph into the command graph.
+            commandGraph->children.insert(commandGraph->children.begin(), timer);
 
-        // hook it up.
-        activateRenderGraph(renderGraph, window, viewer);
+            // hook it up.
+            activateRenderGraph(renderGraph, window, viewer);
+        }
     };
 
     if (_viewerRealized)
@@ -541,14 +623,23 @@ Application::setupViewer(vsg::ref_ptr<vsg::Viewer> viewer)
     // This sets up the internal tasks that will, for each command graph, record
     // a scene graph and submit the results to the renderer each frame. Also sets
     // up whatever's necessary to present the resulting swapchain to the device.
-    vsg::CommandGraphs commandGraphs;
+    // Pre-render graphs go first, since the views may use their results.
+    vsg::CommandGraphs commandGraphs(_preRenderCommandGraphs);
     for (auto iter : _commandGraphByWindow)
     {
         commandGraphs.push_back(iter.second);
     }
+    commandGraphs.insert(commandGraphs.end(), _viewCommandGraphs.begin(), _viewCommandGraphs.end());
 
     viewer->assignRecordAndSubmitTaskAndPresentation(commandGraphs);
 
+    // Record each command graph in its own thread. Every view (and pre-render
+    // graph) has its own command graph in this mode, so views record in parallel.
+    if (_multithreaded)
+    {
+        viewer->setupThreading();
+    }
+
 
 #if 1
     // Configure a descriptor pool size that's appropriate for terrain
@@ -684,6 +775,14 @@ Application::frame()
     stats.record = std::chrono::duration_cast<std::chrono::microseconds>(t_present - t_record);
     stats.present = std::chrono::duration_cast<std::chrono::microseconds>(t_end - t_present);
 
+    stats.viewRecord.clear();
+    for (auto& node : _recordTimers)
+    {
+        auto timer = static_cast<RecordTimer*>(node.get());
+        if (timer->hasView)
+            stats.viewRecord[timer->viewID] = timer->elapsed;
+    }
+
     return viewer->active();
 }
 
@@ -73,6 +73,10 @@ namespace ROCKY_NAMESPACE
             std::chrono::microseconds present;
             double memory;
 
+            //! Record time of each render graph (main views and pre-render
+            //! graphs), by view ID. When record is multithreaded these
+            //! overlap, so they may add up to more than "record".
+            std::map<std::uint32_t, std::chrono::microseconds> viewRecord;
         };
         Stats stats;
 
@@ -90,6 +94,12 @@ namespace ROCKY_NAMESPACE
         struct ViewData
         {
             vsg::ref_ptr<vsg::RenderGraph> parentRenderGraph;
+
+            //! Command graph that records this view
+            vsg::ref_ptr<vsg::CommandGraph> commandGraph;
+
+            //! Node timing the record traversal of parentRenderGraph
+            vsg::ref_ptr<vsg::Group> recordTimer;
         };
 
         //! Adds a window to the application. This may happen asynchronously
@@ -153,13 +163,20 @@ namespace ROCKY_NAMESPACE
         bool _apilayer = false;
         bool _debuglayer = false;
         bool _vsync = true;
-        bool _multithreaded = true;
+        bool _multithreaded = false;
         bool _viewerRealized = false;
         bool _viewerDirty = false;
 
         void realize();
 
         std::map<vsg::ref_ptr<vsg::Window>, vsg::ref_ptr<vsg::CommandGraph>> _commandGraphByWindow;
+
+        // When multithreaded, each additional view and each pre-render graph
+        // gets its own command graph so VSG can record them in parallel.
+        vsg::CommandGraphs _preRenderCommandGraphs;
+        vsg::CommandGraphs _viewCommandGraphs;
+
+        std::vector<vsg::ref_ptr<vsg::Group>> _recordTimers;
         
         std::map<vsg::ref_ptr<vsg::View>, ViewData> _viewData;
         
@@ -176,6 +193,8 @@ namespace ROCKY_NAMESPACE
         vsg::ref_ptr<vsg::CommandGraph> getCommandGraph(vsg::ref_ptr<vsg::Window> window);
         vsg::ref_ptr<vsg::Window> getWindow(vsg::ref_ptr<vsg::View> view);
 
+        vsg::ref_ptr<vsg::CommandGraph> attachView(vsg::ref_ptr<vsg::Window> window, vsg::ref_ptr<vsg::View> view);
+
         void addManipulator(vsg::ref_ptr<vsg::Window> window, vsg::ref_ptr<vsg::View>);
     };
 
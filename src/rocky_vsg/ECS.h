@@ -10,11 +10,15 @@
 #include <rocky_vsg/engine/Utils.h>
 #include <vsg/vk/Context.h>
 #include <vsg/app/RecordTraversal.h>
+#include <vsg/ui/FrameStamp.h>
 #include <vsg/utils/GraphicsPipelineConfigurator.h>
 #include <vsg/commands/Commands.h>
 #include <vsg/nodes/Node.h>
 #include <entt/entt.hpp>
 #include <vector>
+#include <unordered_map>
+#include <algorithm>
+#include <mutex>
 #include <chrono>
 
 namespace ROCKY_NAMESPACE
@@ -75,6 +79,8 @@ namespace ROCKY_NAMESPACE
         };
     }
 
+    struct Transform;
+
     namespace ECS
     {
         using time_point = std::chrono::steady_clock::time_point;
@@ -173,6 +179,12 @@ namespace ROCKY_NAMESPACE
 
         /**
         * Base class for a ECS Component that exposes a list of VSG commands.
+        *
+        * The systems only look at a component again when it is added or when
+        * it is patched. After changing "active" (or the flag active_ptr points
+        * to), anything featureMask() depends on, or calling something that
+        * sets nodeDirty, call registry.patch<T>(entity) (or ECS::patch below)
+        * so the change takes effect.
         */
         class ROCKY_VSG_EXPORT NodeComponent : public Component
         {
@@ -216,6 +228,15 @@ namespace ROCKY_NAMESPACE
             }
         };
 
+        //! Patches each of the component types T that the entity has, which
+        //! tells their systems to re-examine it (see NodeComponent).
+        template<class... T>
+        inline void patch(entt::registry& registry, entt::entity entity)
+        {
+            if (registry.valid(entity))
+                ((registry.all_of<T>(entity) ? (void)registry.patch<T>(entity) : (void)0), ...);
+        }
+
 
         /**
         * Helper class for making systems that operate on Component types
@@ -231,15 +252,13 @@ namespace ROCKY_NAMESPACE
         {
         public:
             //! Construct the system helper object.
-            VSG_SystemHelper(entt::registry& registry_) :
-                registry(registry_) { }
+            inline VSG_SystemHelper(entt::registry& registry_);
 
             //! Destruct the helper, expressly destroying any Vulkan objects
             //! that it created immediately
-            ~VSG_SystemHelper()
-            {
-                pipelines.clear();
-            }
+            inline ~VSG_SystemHelper();
+
+            VSG_SystemHelper(const VSG_SystemHelper&) = delete;
 
             // ECS entity registry reference
             entt::registry& registry;
@@ -266,6 +285,52 @@ namespace ROCKY_NAMESPACE
             inline void accept(vsg::ConstVisitor& v) const;
             inline void compile(vsg::Context&);
             inline void record(vsg::RecordTraversal&) const;
+
+        private:
+            // Cached record information for one component
+            struct Entry
+            {
+                const T* component;
+                Transform* transform;
+                entt::entity entity;
+                int render_set; // index of the render set listing it, or -1
+                std::size_t slot; // position in that render set
+            };
+
+            // Every component in the registry, rebuilt only when a component
+            // or a Transform is added or removed:
+            mutable std::vector<Entry> _entries;
+            mutable std::unordered_map<entt::entity, std::size_t> _entry_index;
+            mutable bool _entries_dirty = true;
+
+            // Entities patched since the last refresh. Only these get
+            // re-examined, so a frame without changes does no per-component work.
+            mutable std::vector<entt::entity> _changed;
+
+            // Visible components sorted by pipeline:
+            mutable std::vector<std::vector<Entry*>> _render_sets;
+
+            mutable std::uint64_t _last_refresh_frame = ~0ull;
+            mutable std::mutex _refresh_mutex;
+
+            void invalidate(entt::registry&, entt::entity) {
+                std::scoped_lock lock(_refresh_mutex);
+                _entries_dirty = true;
+            }
+
+            void changed(entt::registry&, entt::entity entity) {
+                std::scoped_lock lock(_refresh_mutex);
+                // once more changes pile up than there are components (e.g. nothing
+                // is recording this system), a full rebuild is cheaper anyway
+                if (_entries_dirty || _changed.size() > _entries.size()) {
+                    _entries_dirty = true;
+                    _changed.clear();
+                }
+                else _changed.push_back(entity);
+            }
+
+            inline void refresh() const;
+            inline void update(Entry& entry) const;
         };
     }
 
@@ -289,14 +354,20 @@ namespace ROCKY_NAMESPACE
 
         //! Returns true if the push succeeded (and a pop will be required)
         inline bool push(vsg::RecordTraversal& rt, const vsg::dmat4& m) 
+        {
+            return push(rt, m, CullContext::get(rt));
+        }
+
+        //! Same as above, with a cull context already fetched for the view
+        inline bool push(vsg::RecordTraversal& rt, const vsg::dmat4& m, const CullContext& context)
         {
             if (node)
             {
-                return node->push(rt, m * local_matrix);
+                return node->push(rt, m * local_matrix, context);
             }
             else if (parent)
             {
-                return parent->push(rt, m * local_matrix);
+                return parent->push(rt, m * local_matrix, context);
             }
             else return false;
         }
@@ -399,55 +470,160 @@ namespace ROCKY_NAMESPACE
         auto view = registry.view<T>();
         view.each([&](const auto entity, auto& component)
             {
-                component.node->accept(compiler);
+                if (component.node)
+                    component.node->accept(compiler);
             });
     }
 
     template<class T>
-    inline void ECS::VSG_SystemHelper<T>::record(vsg::RecordTraversal& rt) const
+    inline ECS::VSG_SystemHelper<T>::VSG_SystemHelper(entt::registry& registry_) :
+        registry(registry_)
     {
-        ROCKY_PROFILE_FUNCTION();
-
-        const vsg::dmat4 identity_matrix = vsg::dmat4(1.0);
+        // Track structural changes so we only rebuild the record lists when needed,
+        // and patched components so we only re-examine those.
+        registry.on_construct<T>().template connect<&VSG_SystemHelper<T>::invalidate>(*this);
+        registry.on_destroy<T>().template connect<&VSG_SystemHelper<T>::invalidate>(*this);
+        registry.on_update<T>().template connect<&VSG_SystemHelper<T>::changed>(*this);
+        registry.on_construct<Transform>().template connect<&VSG_SystemHelper<T>::invalidate>(*this);
+        registry.on_destroy<Transform>().template connect<&VSG_SystemHelper<T>::invalidate>(*this);
+    }
 
-        // Get an optimized view of all this system's components:
-        auto view = registry.view<T>();
+    template<class T>
+    inline ECS::VSG_SystemHelper<T>::~VSG_SystemHelper()
+    {
+        registry.on_construct<T>().template disconnect<&VSG_SystemHelper<T>::invalidate>(*this);
+        registry.on_destroy<T>().template disconnect<&VSG_SystemHelper<T>::invalidate>(*this);
+        registry.on_update<T>().template disconnect<&VSG_SystemHelper<T>::changed>(*this);
+        registry.on_construct<Transform>().template disconnect<&VSG_SystemHelper<T>::invalidate>(*this);
+        registry.on_destroy<Transform>().template disconnect<&VSG_SystemHelper<T>::invalidate>(*this);
 
-        using Entry = struct {
-            const T& component;
-            entt::entity entity;
-        };
+        pipelines.clear();
+    }
 
-        // Sort components into render sets by pipeline.
+    template<class T>
+    inline void ECS::VSG_SystemHelper<T>::refresh() const
+    {
         // If this system doesn't support multiple pipelines, just 
         // store them all together
-        std::vector<std::vector<Entry>> render_set(!pipelines.empty() ? pipelines.size() : 1);
+        std::size_t num_render_sets = !pipelines.empty() ? pipelines.size() : 1;
+        if (_render_sets.size() != num_render_sets)
+        {
+            _render_sets.resize(num_render_sets);
+            _entries_dirty = true;
+        }
 
-        view.each([&](const entt::entity entity, const T& component)
-            {
-                // Is the component visible?
-                if (*component.active_ptr)
+        // Re-collect the components if any were added or removed.
+        // This is the only place we do per-entity registry lookups.
+        if (_entries_dirty)
+        {
+            _entries.clear();
+            _entry_index.clear();
+            registry.view<T>().each([&](const entt::entity entity, const T& component)
                 {
-                    // Does it have a VSG node? If so, queue it up under the
-                    // appropriate pipeline.
-                    if (component.node)
-                    {
-                        auto& rs = !pipelines.empty() ? render_set[component.featureMask()] : render_set[0];
-                        rs.emplace_back(Entry{ component, entity });
-                    }
+                    _entry_index[entity] = _entries.size();
+                    _entries.emplace_back(Entry{ &component, registry.try_get<Transform>(entity), entity, -1, 0 });
+                });
 
-                    if (!component.node || component.nodeDirty)
-                    {
-                        entities_to_initialize.push_back(entity);
-                    }
-                }
-            });
+            for (auto& rs : _render_sets)
+                rs.clear();
+
+            for (auto& entry : _entries)
+                update(entry);
+
+            _changed.clear();
+            _entries_dirty = false;
+        }
+
+        // Otherwise only re-examine the components that were patched.
+        else if (!_changed.empty())
+        {
+            std::sort(_changed.begin(), _changed.end());
+            _changed.erase(std::unique(_changed.begin(), _changed.end()), _changed.end());
+
+            for (auto entity : _changed)
+            {
+                auto i = _entry_index.find(entity);
+                if (i != _entry_index.end())
+                    update(_entries[i->second]);
+            }
+
+            _changed.clear();
+        }
+    }
+
+    template<class T>
+    inline void ECS::VSG_SystemHelper<T>::update(Entry& entry) const
+    {
+        auto& component = *entry.component;
+        int render_set = -1;
+
+        // Is the component visible?
+        if (*component.active_ptr)
+        {
+            // Does it have a VSG node? If so, it goes under the
+            // appropriate pipeline.
+            if (component.node)
+            {
+                render_set = !pipelines.empty() ? component.featureMask() : 0;
+            }
+
+            // Queue it up for VSG initialization if necessary:
+            if (!component.node || component.nodeDirty)
+            {
+                entities_to_initialize.push_back(entry.entity);
+            }
+        }
+
+        if (render_set != entry.render_set)
+        {
+            // move it to its new render set. Order within a render set
+            // doesn't matter, so swap the last one into the vacated slot.
+            if (entry.render_set >= 0)
+            {
+                auto& rs = _render_sets[entry.render_set];
+                rs[entry.slot] = rs.back();
+                rs[entry.slot]->slot = entry.slot;
+                rs.pop_back();
+            }
+
+            if (render_set >= 0)
+            {
+                auto& rs = _render_sets[render_set];
+                entry.slot = rs.size();
+                rs.push_back(&entry);
+            }
+
+            entry.render_set = render_set;
+        }
+    }
+
+    template<class T>
+    inline void ECS::VSG_SystemHelper<T>::record(vsg::RecordTraversal& rt) const
+    {
+        ROCKY_PROFILE_FUNCTION();
+
+        const vsg::dmat4 identity_matrix = vsg::dmat4(1.0);
+
+        // Bring the render sets up to date, once per frame no matter
+        // how many views record this system.
+        {
+            std::scoped_lock lock(_refresh_mutex);
+            auto frame = rt.getFrameStamp()->frameCount;
+            if (frame != _last_refresh_frame)
+            {
+                refresh();
+                _last_refresh_frame = frame;
+            }
+        }
+
+        // Per-view culling data, resolved once for all components:
+        auto& context = CullContext::get(rt);
 
         // Time to record all visible components.
         // For each pipeline:
-        for (int p = 0; p < render_set.size(); ++p)
+        for (int p = 0; p < _render_sets.size(); ++p)
         {
-            if (!render_set[p].empty())
+            if (!_render_sets[p].empty())
             {
                 // Bind the Graphics Pipeline for this render set, if there is one:
                 if (!pipelines.empty())
@@ -457,20 +633,23 @@ namespace ROCKY_NAMESPACE
 
                 // Them record each component.
                 // If the component has a transform apply it too.
-                for (auto& e : render_set[p])
+                for (auto* e : _render_sets[p])
                 {
-                    auto* xform = registry.try_get<Transform>(e.entity);
-                    if (xform)
+                    // (the node may have been released since it was last patched)
+                    if (!e->component->node)
+                        continue;
+
+                    if (e->transform)
                     {
-                        if (xform->push(rt, identity_matrix))
+                        if (e->transform->push(rt, identity_matrix, context))
                         {
-                            e.component.node->accept(rt);
-                            xform->pop(rt);
+                            e->component->node->accept(rt);
+                            e->transform->pop(rt);
                         }
                     }
                     else
                     {
-                        e.component.node->accept(rt);
+                        e->component->node->accept(rt);
                     }
                 }
             }
@@ -527,6 +706,12 @@ namespace ROCKY_NAMESPACE
                 component.nodeDirty = false;
             }
 
+            // re-examine them now that their nodes exist
+            {
+                std::scoped_lock lock(_refresh_mutex);
+                _changed.insert(_changed.end(), entities_to_initialize.begin(), entities_to_initialize.end());
+            }
+
             // reset the list for the next frame
             entities_to_initialize.clear();
         }
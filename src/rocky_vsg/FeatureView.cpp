@@ -7,6 +7,7 @@
 #include "Mesh.h"
 #include "engine/Runtime.h"
 #include <rocky/weemesh.h>
+#include <algorithm>
 
 using namespace ROCKY_NAMESPACE;
 
@@ -195,7 +196,7 @@ namespace
         }
 
         // start with a weemesh covering the feature extent.
-        weemesh::mesh_t m;
+        weemesh::flat_mesh_t m;
         int marker = 0;
         double xspan = gnomonic_scale * resolution_degrees * 3.14159 / 180.0;
         double yspan = gnomonic_scale * resolution_degrees * 3.14159 / 180.0;
@@ -238,40 +239,38 @@ namespace
         }
 
         // next we need to remove all the exterior triangles.
-        std::unordered_set<weemesh::triangle_t*> insiders;
-        std::unordered_set<weemesh::triangle_t*> outsiders;
+        std::vector<bool> inside(m.triangles.size(), false);
         Geometry::const_iterator remove_iter(local_geom, false);
         while (remove_iter.hasMore())
         {
             auto& part = remove_iter.next();
 
-            for (auto& tri_iter : m.triangles)
+            for (unsigned t = 0; t < m.triangles.size(); ++t)
             {
-                weemesh::triangle_t& tri = tri_iter.second;
-                auto c = (tri.p0 + tri.p1 + tri.p2) * (1.0 / 3.0); // centroid
-                bool inside = part.contains(c.x, c.y);
-                if (inside)
-                    insiders.insert(&tri);
-                else
-                    outsiders.insert(&tri);
+                auto& tri = m.triangles[t];
+                if (tri.alive && !inside[t])
+                {
+                    auto c = (m.get_vertex(tri.i0) + m.get_vertex(tri.i1) + m.get_vertex(tri.i2)) * (1.0 / 3.0); // centroid
+                    inside[t] = part.contains(c.x, c.y);
+                }
             }
         }
-        for (auto tri : outsiders)
+        for (unsigned t = 0; t < m.triangles.size(); ++t)
         {
-            if (insiders.count(tri) == 0)
-            {
-                m.remove_triangle(*tri);
-            }
+            if (!inside[t])
+                m.remove_triangle(t);
         }
 
-        for (auto& v : m.verts)
-            v.z += fake_z_offset;
+        weemesh::vert_array_t verts;
+        verts.reserve(m.num_verts());
+        for (unsigned i = 0; i < m.num_verts(); ++i)
+            verts.emplace_back(m.xs[i], m.ys[i], m.zs[i] + fake_z_offset);
 
         // Back to geographic:
-        gnomonic_to_geo(m.verts.begin(), m.verts.end(), centroid, gnomonic_scale);
+        gnomonic_to_geo(verts.begin(), verts.end(), centroid, gnomonic_scale);
 
         // And into the final projection:
-        feature_to_ecef.transformRange(m.verts.begin(), m.verts.end());
+        feature_to_ecef.transformRange(verts.begin(), verts.end());
 
         auto color = styles.mesh_function(feature).color;
 
@@ -283,15 +282,53 @@ namespace
 
         for (auto& tri : m.triangles)
         {
-            temp.verts[0] = m.verts[tri.second.i0];
-            temp.verts[1] = m.verts[tri.second.i1];
-            temp.verts[2] = m.verts[tri.second.i2];
-            mesh.add(temp);
+            if (tri.alive)
+            {
+                temp.verts[0] = verts[tri.i0];
+                temp.verts[1] = verts[tri.i1];
+                temp.verts[2] = verts[tri.i2];
+                mesh.add(temp);
+            }
         }
     }
 }
 
 
+namespace
+{
+    // Compiles one feature into a line or a mesh, creating whichever it needs.
+    // Returns false if the feature's geometry type isn't supported.
+    bool compile_feature(const Feature& feature, const StyleSheet& styles, std::optional<Line>& line, std::optional<Mesh>& mesh)
+    {
+        if (feature.geometry.type == Geometry::Type::LineString ||
+            feature.geometry.type == Geometry::Type::MultiLineString)
+        {
+            if (!line.has_value())
+                line.emplace();
+            compile_feature_to_lines(feature, styles, line.value());
+        }
+        else if (feature.geometry.type == Geometry::Type::Polygon)
+        {
+            if (!mesh.has_value())
+                mesh.emplace();
+            compile_polygon_feature_with_weemesh(feature, feature.geometry, styles, mesh.value());
+        }
+        else if (feature.geometry.type == Geometry::Type::MultiPolygon)
+        {
+            if (!mesh.has_value())
+                mesh.emplace();
+            for (auto& part : feature.geometry.parts)
+                compile_polygon_feature_with_weemesh(feature, part, styles, mesh.value());
+        }
+        else
+        {
+            return false;
+        }
+        return true;
+    }
+}
+
+
 FeatureView::FeatureView()
 {
     //nop
@@ -312,39 +349,224 @@ FeatureView::generate(entt::registry& registry, Runtime& runtime, bool keep_feat
 {
     entt::entity entity = registry.create();
 
+    std::optional<Line> line;
+    std::optional<Mesh> mesh;
+
     for (auto& feature : features)
     {
-        if (feature.geometry.type == Geometry::Type::LineString ||
-            feature.geometry.type == Geometry::Type::MultiLineString)
+        if (!compile_feature(feature, styles, line, mesh))
         {
-            auto& geom = registry.get_or_emplace<Line>(entity);
-            compile_feature_to_lines(feature, styles, geom);
-            geom.active_ptr = &active;
+            Log()->warn("FeatureView no support for " + Geometry::typeToString(feature.geometry.type));
         }
-        else
-        if (feature.geometry.type == Geometry::Type::Polygon)
+    }
+
+    if (line.has_value())
+    {
+        auto& geom = registry.emplace<Line>(entity, std::move(line.value()));
+        geom.active_ptr = &active;
+    }
+
+    if (mesh.has_value())
+    {
+        auto& geom = registry.emplace<Mesh>(entity, std::move(mesh.value()));
+        geom.active_ptr = &active;
+    }
+
+    next_entity = entity;
+  
+    if (!keep_features)
+        features.clear();
+}
+
+
+FeatureLoader::FeatureLoader()
+{
+    util::job_scheduler::get(compileSchedulerName)->setConcurrency(4);
+}
+
+FeatureLoader::~FeatureLoader()
+{
+    cancel();
+}
+
+Status
+FeatureLoader::load(std::shared_ptr<FeatureSource> source, const IOOptions& in_io)
+{
+    ROCKY_SOFT_ASSERT_AND_RETURN(source, Status(Status::ConfigurationError, "Missing feature source"));
+
+    cancel();
+    _handedOver = 0;
+
+    auto shared = std::make_shared<Shared>();
+    _shared = shared;
+
+    auto sheet = std::make_shared<const StyleSheet>(styles);
+    auto chunk_size = std::max((std::size_t)1, chunkSize);
+    auto max_in_flight = std::max(1u, maxChunksInFlight);
+    auto compile_scheduler = util::job_scheduler::get(compileSchedulerName);
+
+    // Tessellates one chunk of features into a line and a mesh.
+    auto dispatch_chunk = [shared, sheet, compile_scheduler](std::vector<Feature>&& features)
         {
-            auto& geom = registry.get_or_emplace<Mesh>(entity);
-            compile_polygon_feature_with_weemesh(feature, feature.geometry, styles, geom);
-            geom.active_ptr = &active;
-        }
-        else if (feature.geometry.type == Geometry::Type::MultiPolygon)
+            auto input = std::make_shared<std::vector<Feature>>(std::move(features));
+
+            auto compile = [input, sheet](Cancelable& c) -> std::shared_ptr<Chunk>
+                {
+                    auto chunk = std::make_shared<Chunk>();
+                    for (auto& feature : *input)
+                    {
+                        if (c.canceled())
+                            return {};
+
+                        if (compile_feature(feature, *sheet, chunk->line, chunk->mesh))
+                            ++chunk->features;
+                    }
+                    return chunk;
+                };
+
+            std::scoped_lock lock(shared->mutex);
+            shared->chunks.emplace_back(util::job::dispatch(compile,
+                util::job{ "rocky::FeatureLoader compile", nullptr, compile_scheduler }));
+        };
+
+    // Reads features in chunks, never running more than max_in_flight ahead of update().
+    auto read = [source, in_io, shared, chunk_size, max_in_flight, dispatch_chunk](Cancelable& c) mutable -> bool
         {
-            auto& geom = registry.get_or_emplace<Mesh>(entity);
-            for (auto& part : feature.geometry.parts)
+            IOOptions io(in_io);
+            auto iter = source->iterate(io);
+            if (!iter)
+                return false;
+
+            std::vector<Feature> features;
+            features.reserve(chunk_size);
+
+            while (iter->hasMore() && !c.canceled())
             {
-                compile_polygon_feature_with_weemesh(feature, part, styles, geom);
-                geom.active_ptr = &active;
+                auto& feature = iter->next();
+                if (!feature.valid())
+                    continue;
+
+                features.emplace_back(feature);
+                ++shared->read;
+
+                if (features.size() == chunk_size)
+                {
+                    {
+                        std::unique_lock lock(shared->mutex);
+                        while (shared->chunks.size() >= max_in_flight && !c.canceled())
+                            shared->slotAvailable.wait_for(lock, std::chrono::milliseconds(10));
+                    }
+
+                    if (c.canceled())
+                        break;
+
+                    dispatch_chunk(std::move(features));
+                    features = { };
+                    features.reserve(chunk_size);
+                }
             }
+
+            if (!features.empty() && !c.canceled())
+            {
+                dispatch_chunk(std::move(features));
+            }
+
+            return true;
+        };
+
+    _reader = util::job::dispatch(read,
+        util::job{ "rocky::FeatureLoader read", nullptr, util::job_scheduler::get(readSchedulerName) });
+
+    return StatusOK;
+}
+
+std::size_t
+FeatureLoader::update(entt::registry& registry)
+{
+    ROCKY_PROFILE_FUNCTION();
+
+    if (!_shared)
+        return 0;
+
+    auto start = std::chrono::steady_clock::now();
+    std::size_t count = 0;
+
+    for (;;)
+    {
+        std::shared_ptr<Chunk> chunk;
+        {
+            std::scoped_lock lock(_shared->mutex);
+            auto& chunks = _shared->chunks;
+            auto iter = std::find_if(chunks.begin(), chunks.end(), [](auto& f) { return f.available(); });
+            if (iter == chunks.end())
+                break;
+            chunk = iter->value();
+            chunks.erase(iter);
         }
-        else
+        _shared->slotAvailable.notify_one();
+
+        if (chunk)
         {
-            Log()->warn("FeatureView no support for " + Geometry::typeToString(feature.geometry.type));
+            auto entity = registry.create();
+
+            if (chunk->line.has_value())
+            {
+                auto& line = registry.emplace<Line>(entity, std::move(chunk->line.value()));
+                line.active_ptr = &active;
+            }
+
+            if (chunk->mesh.has_value())
+            {
+                auto& mesh = registry.emplace<Mesh>(entity, std::move(chunk->mesh.value()));
+                mesh.active_ptr = &active;
+            }
+
+            entities.emplace_back(entity);
+            count += chunk->features;
         }
+
+        if (std::chrono::steady_clock::now() - start >= budget)
+            break;
     }
 
-    next_entity = entity;
-  
-    if (!keep_features)
-        features.clear();
+    _handedOver += count;
+    return count;
+}
+
+bool
+FeatureLoader::done() const
+{
+    if (!_shared || !_reader.available())
+        return false;
+
+    std::scoped_lock lock(_shared->mutex);
+    return _shared->chunks.empty();
+}
+
+void
+FeatureLoader::cancel()
+{
+    // abandoning the futures cancels the jobs behind them
+    _reader.abandon();
+
+    if (_shared)
+    {
+        std::scoped_lock lock(_shared->mutex);
+        _shared->chunks.clear();
+    }
+    _shared = nullptr;
+}
+
+FeatureLoader::Stats
+FeatureLoader::stats() const
+{
+    Stats result;
+    result.handedOver = _handedOver;
+    if (_shared)
+    {
+        result.read = _shared->read;
+        std::scoped_lock lock(_shared->mutex);
+        result.chunksInFlight = _shared->chunks.size();
+    }
+    return result;
 }
@@ -5,8 +5,12 @@
  */
 #pragma once
 #include <rocky/Feature.h>
+#include <rocky/Threading.h>
 #include <optional>
 #include <functional>
+#include <deque>
+#include <mutex>
+#include <condition_variable>
 #include <rocky_vsg/Line.h>
 #include <rocky_vsg/Mesh.h>
 #include <rocky_vsg/Icon.h>
@@ -22,6 +26,8 @@ namespace ROCKY_NAMESPACE
         std::optional<MeshStyle> mesh;
         std::optional<IconStyle> icon;
 
+        //! Per-feature mesh style. Note: FeatureLoader calls this
+        //! from worker threads.
         std::function<MeshStyle(const Feature&)> mesh_function;
     };
 
@@ -48,7 +54,8 @@ namespace ROCKY_NAMESPACE
             Runtime& runtime,
             bool keep_features = false);
 
-        //! Whether to render this component
+        //! Whether to render this component. After changing it, patch the
+        //! Line and Mesh on next_entity (see ECS::patch).
         bool active = true;
 
     public:
@@ -61,4 +68,97 @@ namespace ROCKY_NAMESPACE
         //! Construct a view to display a single moved feature)
         FeatureView(Feature&& value);
     };
+
+    /**
+    * FeatureLoader streams features from a FeatureSource into the registry
+    * without stalling the frame. One background job reads the source in
+    * chunks; each chunk goes to a worker job that tessellates its lines and
+    * polygons; and update() hands the finished chunks to the registry, one
+    * entity per chunk, within a time budget. At most maxChunksInFlight
+    * chunks exist between the reader and the registry, so a large source
+    * is never resident all at once.
+    */
+    class ROCKY_VSG_EXPORT FeatureLoader
+    {
+    public:
+        //! Styles to use when compiling features
+        StyleSheet styles;
+
+        //! Number of features per chunk (and per entity)
+        std::size_t chunkSize = 500;
+
+        //! Maximum number of chunks being tessellated or waiting for update()
+        unsigned maxChunksInFlight = 16;
+
+        //! Time update() may spend handing chunks to the registry
+        std::chrono::microseconds budget = std::chrono::microseconds(2000);
+
+        //! Whether to render the loaded features. After changing it, patch
+        //! the Line and Mesh on each of the entities (see ECS::patch).
+        bool active = true;
+
+        //! Entities created so far
+        std::vector<entt::entity> entities;
+
+        //! Name of the job scheduler that reads the feature source
+        std::string readSchedulerName = "rocky.features.read";
+
+        //! Name of the job scheduler that tessellates chunks
+        std::string compileSchedulerName = "rocky.features";
+
+    public:
+        //! Construct a loader
+        FeatureLoader();
+
+        //! Destruct, canceling any pending work
+        ~FeatureLoader();
+
+        FeatureLoader(const FeatureLoader&) = delete;
+        FeatureLoader& operator=(const FeatureLoader&) = delete;
+
+        //! Start reading and tessellating features in the background.
+        //! Uses a copy of the current styles.
+        Status load(std::shared_ptr<FeatureSource> source, const IOOptions& io);
+
+        //! Hand finished chunks to the registry until the budget runs out.
+        //! Call once per frame from the thread that owns the registry.
+        //! @return Number of features handed over
+        std::size_t update(entt::registry& registry);
+
+        //! Whether all features were read, tessellated, and handed over
+        bool done() const;
+
+        //! Stop loading and discard any pending work
+        void cancel();
+
+        //! Loader statistics
+        struct Stats
+        {
+            std::size_t read = 0;
+            std::size_t handedOver = 0;
+            std::size_t chunksInFlight = 0;
+        };
+        Stats stats() const;
+
+    private:
+        struct Chunk
+        {
+            std::optional<Line> line;
+            std::optional<Mesh> mesh;
+            std::size_t features = 0;
+        };
+
+        // state shared with the background jobs
+        struct Shared
+        {
+            std::mutex mutex;
+            std::condition_variable slotAvailable;
+            std::deque<util::Future<std::shared_ptr<Chunk>>> chunks;
+            std::atomic<std::size_t> read = { 0 };
+        };
+
+        std::shared_ptr<Shared> _shared;
+        util::Future<bool> _reader;
+        std::size_t _handedOver = 0;
+    };
 }
@@ -11,8 +11,7 @@ using namespace ROCKY_NAMESPACE;
 
 GeoTransform::GeoTransform()
 {
-    // force creation of the first viewlocal data structure
-    _viewlocal[0].dirty = true;
+    // view-local data starts out dirty and is filled in when recorded
 }
 
 void
@@ -28,8 +27,10 @@ GeoTransform::setPosition(const GeoPoint& position_)
 void
 GeoTransform::dirty()
 {
-    for (auto& view : _viewlocal)
-        view.dirty = true;
+    ++revision;
+
+    for (std::uint32_t i = 0; i < _viewlocal.size(); ++i)
+        _viewlocal[i].dirty = true;
 }
 
 void
@@ -45,20 +46,25 @@ GeoTransform::accept(vsg::RecordTraversal& record) const
 
 bool
 GeoTransform::push(vsg::RecordTraversal& record, const vsg::dmat4& local_matrix) const
+{
+    return push(record, local_matrix, CullContext::get(record));
+}
+
+bool
+GeoTransform::push(vsg::RecordTraversal& record, const vsg::dmat4& local_matrix, const CullContext& context) const
 {
     auto state = record.getState();
 
     // update the view-local data if necessary:
-    auto& view = _viewlocal[record.getState()->_commandBuffer->viewID];
+    auto& view = _viewlocal[context.viewID];
     if (view.dirty || local_matrix != view.local_matrix)
     {
-        SRS worldSRS;
-        if (record.getValue("worldsrs", worldSRS))
+        if (context.worldSRS.valid())
         {
-            if (position.transform(worldSRS, view.worldPos))
+            if (position.transform(context.worldSRS, view.worldPos))
             {
                 view.matrix =
-                    to_vsg(worldSRS.localToWorldMatrix(glm::dvec3(view.worldPos.x, view.worldPos.y, view.worldPos.z))) *
+                    to_vsg(context.worldSRS.localToWorldMatrix(glm::dvec3(view.worldPos.x, view.worldPos.y, view.worldPos.z))) *
                     local_matrix;
             }
         }
@@ -68,14 +74,10 @@ GeoTransform::push(vsg::RecordTraversal& record, const vsg::dmat4& local_matrix)
     }
 
     // horizon cull, if active:
-    if (horizonCulling)
+    if (horizonCulling && context.horizon)
     {
-        std::shared_ptr<Horizon> horizon;
-        if (state->getValue("horizon", horizon))
-        {
-            if (!horizon->isVisible(view.matrix[3][0], view.matrix[3][1], view.matrix[3][2], bound.radius))
-                return false;
-        }
+        if (!context.horizon->isVisible(view.matrix[3][0], view.matrix[3][1], view.matrix[3][2], bound.radius))
+            return false;
     }
 
     // replicates RecordTraversal::accept(MatrixTransform&):
@@ -7,6 +7,7 @@
 
 #include <rocky_vsg/Common.h>
 #include <rocky_vsg/engine/ViewLocal.h>
+#include <rocky_vsg/engine/CullContext.h>
 #include <rocky/GeoPoint.h>
 #include <vsg/nodes/CullGroup.h>
 #include <vsg/nodes/Transform.h>
@@ -44,6 +45,9 @@ namespace ROCKY_NAMESPACE
         //! whether horizon culling is active
         bool horizonCulling = true;
 
+        //! Incremented by dirty(), so observers can detect a change cheaply
+        Revision revision = 0;
+
     public:
         //! Construct an invalid geotransform
         GeoTransform();
@@ -68,6 +72,10 @@ namespace ROCKY_NAMESPACE
 
         bool push(vsg::RecordTraversal&, const vsg::dmat4& m) const;
 
+        //! Same as push(), using a cull context the caller already fetched
+        //! with CullContext::get. Use this when recording many transforms.
+        bool push(vsg::RecordTraversal&, const vsg::dmat4& m, const CullContext& context) const;
+
         void pop(vsg::RecordTraversal&) const;
 
     protected:
@@ -17,6 +17,8 @@ Icon::Icon()
 void
 Icon::dirty()
 {
+    ++revision;
+
     if (bindCommand)
     {
         // update the UBO with the new style data.
@@ -73,12 +73,16 @@ namespace ROCKY_NAMESPACE
         //! Image to use for the icon texture
         std::shared_ptr<Image> image;
 
+        //! Incremented by dirty()
+        Revision revision = 0;
+
         //! serialize as JSON string
         JSON to_json() const override;
 
         //! Call after changing the style or image
         void dirty();
 
+        //! Call after changing the image, then patch the Icon in the registry
         void dirtyImage();
 
     public: // NodeComponent
@@ -40,6 +40,8 @@ Label::Label()
 void
 Label::dirty()
 {
+    ++revision;
+
     if (node)
     {
         if (style.font != appliedStyle.font ||
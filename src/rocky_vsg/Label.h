@@ -35,7 +35,11 @@ namespace ROCKY_NAMESPACE
         //! Label style; call dirty() to apply
         LabelStyle style;
 
-        //! Apply changes
+        //! Incremented by dirty()
+        Revision revision = 0;
+
+        //! Apply changes. Patch the Label in the registry afterwards so
+        //! the system rebuilds it.
         void dirty() override;
 
         //! serialize as JSON string
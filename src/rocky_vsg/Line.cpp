@@ -31,6 +31,15 @@ Line::dirty()
     }
 }
 
+vsg::ref_ptr<LineGeometry>
+Line::pushDynamic(unsigned capacity)
+{
+    auto geom = LineGeometry::create();
+    geom->setCapacity(capacity);
+    geometries.push_back(geom);
+    return geom;
+}
+
 void
 Line::initializeNode(const ECS::NodeComponent::Params& params)
 {
@@ -27,29 +27,54 @@ namespace ROCKY_NAMESPACE
 
     /**
     * Renders a line or linestring geometry.
+    *
+    * By default the geometry is static: push all the points, then compile.
+    * Call setCapacity() before compiling to make it dynamic instead; the
+    * GPU storage is allocated once for that many points and used as a ring
+    * buffer, so push_back() and pop_front() work after compilation and
+    * upload only the pages of vertices they touch.
     */
     class ROCKY_VSG_EXPORT LineGeometry : public vsg::Inherit<vsg::Geometry, LineGeometry>
     {
     public:
+        //! Number of points in each upload page of a dynamic geometry
+        static constexpr unsigned page_size = 64;
+
         //! Construct a new line string geometry node
         LineGeometry();
 
+        //! Make this geometry dynamic, with storage for this many points.
+        //! Once full, each push_back() replaces the oldest point.
+        //! Call before adding any points.
+        void setCapacity(unsigned points);
+
+        //! Maximum number of points in a dynamic geometry, or 0 if static
+        unsigned capacity() const { return _capacity; }
+
         //! Adds a vertex to the end of the line string
         void push_back(const vsg::vec3& vert);
 
+        //! Removes the first vertex of a dynamic line string
+        void pop_front();
+
         //! Number of verts comprising this line string
         unsigned numVerts() const;
 
-        //! The first vertex in the line string to render
+        //! The first point in the line string to render
         void setFirst(unsigned value);
 
-        //! Number of vertices in the line string to render
+        //! Number of points in the line string to render
         void setCount(unsigned value);
 
-        //! Recompile the geometry after making changes.
-        //! TODO: just make it dynamic instead
+        //! Compile the geometry. A static geometry must be
+        //! recompiled after making changes; a dynamic one need not.
         void compile(vsg::Context&) override;
 
+        //! Reports every page of a dynamic geometry to the resource collector
+        void accept(vsg::ConstVisitor&) const override;
+
+        using Inherit::accept;
+
     protected:
         vsg::vec4 _defaultColor = { 1,1,1,1 };
         std::vector<vsg::vec3> _current;
@@ -57,6 +82,19 @@ namespace ROCKY_NAMESPACE
         std::vector<vsg::vec3> _next;
         std::vector<vsg::vec4> _colors;
         vsg::ref_ptr<vsg::DrawIndexed> _drawCommand;
+
+        // dynamic (ring buffer) mode
+        unsigned _capacity = 0;
+        unsigned _first = 0;
+        unsigned _size = 0;
+        std::vector<vsg::ref_ptr<vsg::vec3Array>> _currentPages;
+        std::vector<vsg::ref_ptr<vsg::vec3Array>> _previousPages;
+        std::vector<vsg::ref_ptr<vsg::vec3Array>> _nextPages;
+        std::vector<vsg::ref_ptr<vsg::vec4Array>> _colorPages;
+        vsg::BufferInfoList _pageBuffers; // every page of every attribute, attribute-major
+
+        void write(std::vector<vsg::ref_ptr<vsg::vec3Array>>& pages, unsigned point, const vsg::vec3& value);
+        void compileDynamic(vsg::Context&);
     };
 
     /**
@@ -99,6 +137,14 @@ namespace ROCKY_NAMESPACE
         template<class VEC3_ITER>
         inline void push(VEC3_ITER begin, VEC3_ITER end);
 
+        //! Pushes a new, empty dynamic sub-geometry with room for this many
+        //! points, for line strings that change every frame like live tracks.
+        //! Append to it with push_back() at any time; no dirty() needed.
+        //! @param capacity Maximum number of points; once full, appending
+        //!   a point drops the oldest one
+        //! @return The new sub-geometry
+        vsg::ref_ptr<LineGeometry> pushDynamic(unsigned capacity);
+
         //! Applies changes to the dynanmic "style"
         void dirty();
 
@@ -4,6 +4,7 @@
  * MIT License
  */
 #include "MapNode.h"
+#include "engine/CullContext.h"
 #include "engine/Utils.h"
 #include "json.h"
 #include <rocky/Horizon.h>
@@ -164,18 +165,31 @@ MapNode::accept(vsg::RecordTraversal& rv) const
 {
     ROCKY_PROFILE_FUNCTION();
 
+    // Resolve the per-view cull context once, so everything under
+    // this node can read it without any lookups.
+    auto& context = CullContext::get(rv);
+    context.viewID = rv.getState()->_commandBuffer->viewID;
+    context.viewMatrix = rv.getState()->modelviewMatrixStack.top();
+    context.eye = vsg::inverse(context.viewMatrix) * vsg::dvec3(0, 0, 0);
+
+    if (context.worldSRS != worldSRS())
+    {
+        context.worldSRS = worldSRS();
+    }
+
     if (worldSRS().isGeocentric())
     {
-        std::shared_ptr<Horizon> horizon;
-        rv.getState()->getValue("horizon", horizon);
-        if (!horizon)
+        if (!context.horizon)
         {
-            horizon = std::make_shared<Horizon>(worldSRS().ellipsoid());
-            rv.getState()->setValue("horizon", horizon);
+            context.horizon = std::make_shared<Horizon>(worldSRS().ellipsoid());
+            rv.getState()->setValue("horizon", context.horizon);
         }
 
-        auto eye = vsg::inverse(rv.getState()->modelviewMatrixStack.top()) * vsg::dvec3(0, 0, 0);
-        horizon->setEye(to_glm(eye));
+        context.horizon->setEye(to_glm(context.eye));
+    }
+    else
+    {
+        context.horizon = nullptr;
     }
 
     rv.setValue("worldsrs", worldSRS());
@@ -17,8 +17,6 @@ namespace ROCKY_NAMESPACE
     * Transform that lets you set an object's size in pixels rather than
     * scene units (e.g. meters). Good for text or other billboarded
     * screen-space geometry.
-    *
-    * This won't work great for multi-threaded record traversals..
     */
     class ROCKY_VSG_EXPORT PixelScaleTransform : public vsg::Inherit<vsg::Transform, PixelScaleTransform>
     {
@@ -29,29 +27,38 @@ namespace ROCKY_NAMESPACE
 
         void accept(vsg::RecordTraversal& rt) const override
         {
-            // Calculate the scale factor that will scale geometry from pixel space to model space
+            // Calculate the scale factor that will scale geometry from pixel space to model space.
+            // The matrix is view-dependent, so keep it on the stack; views may record in parallel.
             auto& state = *rt.getState();
             auto& viewport = state._commandBuffer->viewDependentState->viewportData->at(0);
             double d = state.lodDistance(vsg::dsphere(0.0, 0.0, 0.0, 0.5)) / viewport[3]; // vp height
-            matrix = vsg::scale(d);
+            vsg::dmat4 matrix = vsg::scale(d);
+
+            auto& mv = state.modelviewMatrixStack.top();
 
             if (unrotate)
             {
                 vsg::dquat rotation;
-                auto& mv = state.modelviewMatrixStack.top();
                 get_rotation_from_matrix(mv, rotation);
                 matrix = matrix * vsg::rotate(vsg::inverse(rotation));
             }
-            rt.apply(*this);
+
+            // replicates RecordTraversal::accept(MatrixTransform&):
+            state.modelviewMatrixStack.push(mv * matrix);
+            state.dirty = true;
+            state.pushFrustum();
+
+            traverse(rt);
+
+            state.popFrustum();
+            state.modelviewMatrixStack.pop();
+            state.dirty = true;
         };
 
+        //! Outside of a record traversal there is no view, so no pixel scale
         vsg::dmat4 transform(const vsg::dmat4& mv) const override
         {
-            return mv * matrix;
+            return mv;
         }
-
-
-    private:
-        mutable vsg::dmat4 matrix;
     };
 }
@@ -22,6 +22,7 @@ TerrainSettings::TerrainSettings(const JSON& conf)
     get_to(j, "min_seconds_before_unload", minSecondsBeforeUnload);
     get_to(j, "min_frames_before_unload", minFramesBeforeUnload);
     get_to(j, "min_tiles_before_unload", minResidentTilesBeforeUnload);
+    get_to(j, "update_budget", updateBudget);
     get_to(j, "cast_shadows", castShadows);
     get_to(j, "tile_pixel_size", tilePixelSize);
     get_to(j, "skirt_ratio", skirtRatio);
@@ -29,6 +30,8 @@ TerrainSettings::TerrainSettings(const JSON& conf)
     get_to(j, "normalize_edges", normalizeEdges);
     get_to(j, "morph_terrain", morphTerrain);
     get_to(j, "morph_imagery", morphImagery);
+    get_to(j, "compress_textures", compressTextures);
+    get_to(j, "compression_quality", compressionQuality);
     get_to(j, "concurrency", concurrency);
 }
 
@@ -46,6 +49,7 @@ TerrainSettings::to_json() const
     set(j, "min_seconds_before_unload", minSecondsBeforeUnload);
     set(j, "min_frames_before_unload", minFramesBeforeUnload);
     set(j, "min_tiles_before_unload", minResidentTilesBeforeUnload);
+    set(j, "update_budget", updateBudget);
     set(j, "cast_shadows", castShadows);
     set(j, "tile_pixel_size", tilePixelSize);
     set(j, "skirt_ratio", skirtRatio);
@@ -53,6 +57,8 @@ TerrainSettings::to_json() const
     set(j, "normalize_edges", normalizeEdges);
     set(j, "morph_terrain", morphTerrain);
     set(j, "morph_imagery", morphImagery);
+    set(j, "compress_textures", compressTextures);
+    set(j, "compression_quality", compressionQuality);
     set(j, "concurrency", concurrency);
     return j.dump();
 }
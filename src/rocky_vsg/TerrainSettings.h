@@ -60,6 +60,12 @@ namespace ROCKY_NAMESPACE
         //! Maximum number of terrain tiles to unload/expire each frame.
         optional<unsigned> maxTilesToUnloadPerFrame = ~0;
 
+        //! Time, in milliseconds, the terrain may spend each frame merging new
+        //! tile data, launching tile requests, and expiring unused tiles.
+        //! Work that doesn't fit carries over to later frames, most important
+        //! tiles first. At least one of each kind of work runs every frame.
+        optional<float> updateBudget = 4.0f;
+
         //! Minimum number of terrain tiles to keep in memory before expiring usused data
         optional<unsigned> minResidentTilesBeforeUnload = 0;
 
@@ -92,6 +98,16 @@ namespace ROCKY_NAMESPACE
         //! This feature is not available when using screen-space error LOD
         optional<bool> morphImagery = false;
 
+        //! Whether to compress terrain imagery to a GPU block format (BC1, or
+        //! BC3 for imagery with transparency) with mipmaps on the loading
+        //! threads. Color textures take 4-8x less GPU memory and upload
+        //! bandwidth, at some cost in quality and loading time.
+        optional<bool> compressTextures = false;
+
+        //! Encoder effort when compressTextures is on, from 0 (fastest)
+        //! to 1 (best quality).
+        optional<float> compressionQuality = 0.5f;
+
         //! Target concurrency of terrain data loading operations.
         optional<unsigned> concurrency = 4;
 
@@ -0,0 +1,21 @@
+/**
+ * rocky c++
+ * Copyright 2023 Pelican Mapping
+ * MIT License
+ */
+#include "CullContext.h"
+#include "ViewLocal.h"
+#include <rocky/Horizon.h>
+
+using namespace ROCKY_NAMESPACE;
+
+namespace
+{
+    util::ViewLocal<CullContext> g_cullContexts;
+}
+
+CullContext&
+CullContext::get(std::uint32_t viewID)
+{
+    return g_cullContexts[viewID];
+}
@@ -0,0 +1,61 @@
+/**
+ * rocky c++
+ * Copyright 2023 Pelican Mapping
+ * MIT License
+ */
+#pragma once
+
+#include <rocky_vsg/Common.h>
+#include <rocky/SRS.h>
+#include <vsg/app/RecordTraversal.h>
+#include <vsg/maths/mat4.h>
+#include <vsg/vk/State.h>
+#include <vsg/vk/CommandBuffer.h>
+
+namespace ROCKY_NAMESPACE
+{
+    class Horizon;
+
+    /**
+    * Per-view information that culling code needs during a record traversal.
+    * The MapNode fills it in once per view per frame, and cullable objects
+    * (GeoTransform, terrain tiles) read it by view ID instead of doing
+    * string-keyed lookups on the vsg::State.
+    *
+    * Fetch it once and pass it down when recording many objects:
+    *
+    *   auto& context = CullContext::get(record);
+    *   for(auto& xform : xforms)
+    *       xform->push(record, matrix, context);
+    */
+    struct ROCKY_VSG_EXPORT CullContext
+    {
+        //! View this context belongs to
+        std::uint32_t viewID = 0;
+
+        //! Horizon for this view, or nullptr if the map is not geocentric
+        std::shared_ptr<Horizon> horizon;
+
+        //! SRS of the rendered world
+        SRS worldSRS;
+
+        //! View matrix (the modelview matrix at the MapNode)
+        vsg::dmat4 viewMatrix;
+
+        //! Eye position in world coordinates
+        vsg::dvec3 eye;
+
+        //! Context for the view with the given ID
+        static CullContext& get(std::uint32_t viewID);
+
+        //! Context for the view that a state is recording
+        static inline CullContext& get(const vsg::State* state) {
+            return get(state->_commandBuffer->viewID);
+        }
+
+        //! Context for the view that a traversal is recording
+        static inline CullContext& get(vsg::RecordTraversal& record) {
+            return get(record.getState());
+        }
+    };
+}
@@ -0,0 +1,522 @@
+/**
+ * rocky c++
+ * Copyright 2023 Pelican Mapping
+ * MIT License
+ */
+#include "IconInstancer.h"
+#include "Runtime.h"
+#include "Utils.h"
+#include "PipelineState.h"
+#include <rocky_vsg/GeoTransform.h>
+#include <rocky/Color.h>
+
+#include <vsg/core/Array3D.h>
+#include <vsg/maths/transform.h>
+#include <vsg/state/BindDescriptorSet.h>
+#include <vsg/state/DescriptorBuffer.h>
+#include <vsg/state/DescriptorImage.h>
+#include <vsg/nodes/StateGroup.h>
+
+using namespace ROCKY_NAMESPACE;
+
+#define LC "[IconInstancer] "
+
+#define VERT_SHADER "shaders/rocky.icon.instanced.vert"
+#define FRAG_SHADER "shaders/rocky.icon.instanced.frag"
+
+#define INSTANCE_SET 0 // must match layout(set=X) in the shader
+#define INSTANCE_BINDING 1 // must match the layout(binding=X) of the instance buffer
+#define TEXTURE_BINDING 2 // must match the layout(binding=X) of the texture array
+#define BATCH_BINDING 3 // must match the layout(binding=X) of the batch uniform
+
+namespace
+{
+    vsg::ref_ptr<vsg::ShaderSet> createShaderSet(Runtime& runtime)
+    {
+        vsg::ref_ptr<vsg::ShaderSet> shaderSet;
+
+        // load shaders
+        auto vertexShader = vsg::ShaderStage::read(
+            VK_SHADER_STAGE_VERTEX_BIT,
+            "main",
+            vsg::findFile(VERT_SHADER, runtime.searchPaths),
+            runtime.readerWriterOptions);
+
+        auto fragmentShader = vsg::ShaderStage::read(
+            VK_SHADER_STAGE_FRAGMENT_BIT,
+            "main",
+            vsg::findFile(FRAG_SHADER, runtime.searchPaths),
+            runtime.readerWriterOptions);
+
+        if (!vertexShader || !fragmentShader)
+        {
+            return { };
+        }
+
+        vsg::ShaderStages shaderStages{ vertexShader, fragmentShader };
+
+        shaderSet = vsg::ShaderSet::create(shaderStages);
+
+        // per-instance data (no vertex attributes; the shader builds the quad)
+        shaderSet->addUniformBinding(
+            "instances", "",
+            INSTANCE_SET, INSTANCE_BINDING,
+            VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1, VK_SHADER_STAGE_VERTEX_BIT, {});
+
+        // one layer per icon image
+        shaderSet->addUniformBinding(
+            "icon_textures", "",
+            INSTANCE_SET, TEXTURE_BINDING,
+            VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 1, VK_SHADER_STAGE_FRAGMENT_BIT, {});
+
+        // batch anchor and ellipsoid for horizon culling
+        shaderSet->addUniformBinding(
+            "batch", "",
+            INSTANCE_SET, BATCH_BINDING,
+            VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 1, VK_SHADER_STAGE_VERTEX_BIT, {});
+
+        // We need VSG's view-dependent data:
+        PipelineUtils::addViewDependentData(shaderSet, VK_SHADER_STAGE_VERTEX_BIT);
+
+        // Note: 128 is the maximum size required by the Vulkan spec so don't increase it
+        shaderSet->addPushConstantRange("pc", "", VK_SHADER_STAGE_VERTEX_BIT, 0, 128);
+
+        return shaderSet;
+    }
+}
+
+IconInstancer::IconInstancer(entt::registry& registry) :
+    _registry(registry)
+{
+    // An instance goes away with its Slot; the Slot goes away with the
+    // entity, or when the entity loses its Icon or its Transform.
+    _registry.on_destroy<Icon>().connect<&IconInstancer::removeSlot>(*this);
+    _registry.on_destroy<Transform>().connect<&IconInstancer::removeSlot>(*this);
+    _registry.on_destroy<Slot>().connect<&IconInstancer::releaseSlot>(*this);
+
+    _defaultImage = Image::create(Image::R8G8B8A8_UNORM, 1, 1);
+    _defaultImage->write(Color::Red, 0, 0);
+}
+
+IconInstancer::~IconInstancer()
+{
+    _registry.on_destroy<Icon>().disconnect<&IconInstancer::removeSlot>(*this);
+    _registry.on_destroy<Transform>().disconnect<&IconInstancer::removeSlot>(*this);
+    _registry.on_destroy<Slot>().disconnect<&IconInstancer::releaseSlot>(*this);
+
+    // the slots point into our batches:
+    _registry.clear<Slot>();
+}
+
+Status
+IconInstancer::initialize(Runtime& runtime)
+{
+    auto shaderSet = createShaderSet(runtime);
+
+    if (!shaderSet)
+    {
+        return Status(Status::ResourceUnavailable,
+            "Instanced icon shaders are missing or corrupt. "
+            "Did you set ROCKY_FILE_PATH to point at the rocky share folder?");
+    }
+
+    _config = vsg::GraphicsPipelineConfigurator::create(shaderSet);
+    _config->shaderHints = runtime.shaderCompileSettings;
+
+    _config->enableUniform("instances");
+    _config->enableTexture("icon_textures");
+    _config->enableUniform("batch");
+
+    PipelineUtils::enableViewDependentData(_config);
+
+    PipelineUtils::setOverlayStates(_config);
+
+    _config->init();
+
+    _pipelineCommands = vsg::Commands::create();
+    _pipelineCommands->addChild(_config->bindGraphicsPipeline);
+    _pipelineCommands->addChild(PipelineUtils::createViewDependentBindCommand(_config));
+
+    return StatusOK;
+}
+
+IconInstancer::Batch*
+IconInstancer::getOrCreateBatch(const Image& image)
+{
+    for (auto& batch : _batches)
+    {
+        if (batch->width == image.width() && batch->height == image.height() &&
+            (batch->layerOf.count(&image) > 0 || batch->layers.size() < max_layers))
+        {
+            return batch.get();
+        }
+    }
+
+    auto batch = std::make_unique<Batch>();
+    batch->width = image.width();
+    batch->height = image.height();
+    batch->batchData = vsg::vec4Array::create(2);
+    batch->batchData->properties.dataVariance = vsg::DYNAMIC_DATA;
+    _batches.emplace_back(std::move(batch));
+    return _batches.back().get();
+}
+
+std::uint32_t
+IconInstancer::acquire(Batch& batch, const std::shared_ptr<Image>& image, const vsg::dvec3& world)
+{
+    if (batch.layerOf.count(image.get()) == 0)
+    {
+        batch.layerOf[image.get()] = (std::uint32_t)batch.layers.size();
+        batch.layers.emplace_back(image);
+        batch.rebuild = true;
+    }
+
+    std::uint32_t index;
+    if (!batch.freeList.empty())
+    {
+        index = batch.freeList.back();
+        batch.freeList.pop_back();
+    }
+    else
+    {
+        if (batch.pages.empty())
+        {
+            // anchor the batch near its first icon, keeping float precision
+            // good for icons in the same region
+            batch.anchor = world;
+        }
+
+        index = 0;
+        for (auto& page : batch.pages)
+            index += page.count;
+
+        if (batch.pages.empty() || batch.pages.back().count == page_size)
+        {
+            Page page;
+            page.data = vsg::vec4Array::create(page_size * 2);
+            page.data->properties.dataVariance = vsg::DYNAMIC_DATA;
+            page.draw = vsg::Draw::create(6, 0, 0, 0);
+            batch.pages.emplace_back(std::move(page));
+            batch.rebuild = true;
+        }
+    }
+
+    auto& page = batch.pages[index / page_size];
+    page.count = std::max(page.count, index % page_size + 1);
+    ++_stats.instances;
+
+    return index;
+}
+
+void
+IconInstancer::free(Slot& slot)
+{
+    if (slot.batch)
+    {
+        auto& batch = *slot.batch;
+        auto& page = batch.pages[slot.index / page_size];
+
+        // hide it; the next new icon in this batch reuses the index
+        page.data->at((slot.index % page_size) * 2 + 1).z = 0.0f;
+        page.dirty = true;
+        batch.freeList.push_back(slot.index);
+        slot.batch = nullptr;
+        --_stats.instances;
+    }
+}
+
+void
+IconInstancer::removeSlot(entt::registry& registry, entt::entity entity)
+{
+    registry.remove<Slot>(entity);
+}
+
+void
+IconInstancer::releaseSlot(entt::registry& registry, entt::entity entity)
+{
+    free(registry.get<Slot>(entity));
+}
+
+void
+IconInstancer::write(Slot& slot, const Icon& icon, const GeoTransform& xform)
+{
+    glm::dvec3 world(0, 0, 0);
+    bool ok = false;
+
+    if (xform.position.srs() == _instanceSRS)
+    {
+        world = glm::dvec3(xform.position.x, xform.position.y, xform.position.z);
+        ok = true;
+    }
+    else
+    {
+        if (xform.position.srs() != _toWorldSource)
+        {
+            _toWorldSource = xform.position.srs();
+            _toWorld = _toWorldSource.to(_instanceSRS);
+        }
+        ok = _toWorld.transform(glm::dvec3(xform.position.x, xform.position.y, xform.position.z), world);
+    }
+
+    auto& batch = *slot.batch;
+    auto& page = batch.pages[slot.index / page_size];
+    auto offset = (slot.index % page_size) * 2;
+
+    page.data->at(offset) = vsg::vec4(
+        (float)(world.x - batch.anchor.x),
+        (float)(world.y - batch.anchor.y),
+        (float)(world.z - batch.anchor.z),
+        icon.style.size_pixels);
+
+    page.data->at(offset + 1) = vsg::vec4(
+        icon.style.rotation_radians,
+        (float)batch.layerOf[slot.image],
+        (ok && *icon.active_ptr) ? 1.0f : 0.0f,
+        0.0f);
+
+    page.dirty = true;
+}
+
+void
+IconInstancer::rebuild(Batch& batch, Runtime& runtime)
+{
+    ROCKY_PROFILE_FUNCTION();
+
+    // Texture array with one layer per image:
+    auto layers = (std::uint32_t)batch.layers.size();
+    auto texture = vsg::ubvec4Array3D::create(batch.width, batch.height, layers,
+        vsg::Data::Properties{ VK_FORMAT_R8G8B8A8_UNORM });
+    texture->properties.imageViewType = VK_IMAGE_VIEW_TYPE_2D_ARRAY;
+    texture->properties.origin = vsg::TOP_LEFT;
+
+    Image::Pixel pixel;
+    for (std::uint32_t k = 0; k < layers; ++k)
+    {
+        auto& image = *batch.layers[k];
+        for (unsigned t = 0; t < batch.height; ++t)
+        {
+            for (unsigned s = 0; s < batch.width; ++s)
+            {
+                image.read(pixel, s, t);
+                pixel = glm::clamp(pixel, 0.0f, 1.0f) * 255.0f;
+                texture->at(s, t, k) = vsg::ubvec4(
+                    (std::uint8_t)pixel.r, (std::uint8_t)pixel.g, (std::uint8_t)pixel.b, (std::uint8_t)pixel.a);
+            }
+        }
+    }
+
+    auto sampler = vsg::Sampler::create();
+    sampler->minFilter = VK_FILTER_LINEAR;
+    sampler->magFilter = VK_FILTER_LINEAR;
+    sampler->addressModeU = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+    sampler->addressModeV = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+    sampler->addressModeW = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+
+    auto textureDescriptor = vsg::DescriptorImage::create(
+        sampler, texture, TEXTURE_BINDING, 0, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER);
+
+    auto batchDescriptor = vsg::DescriptorBuffer::create(
+        batch.batchData, BATCH_BINDING, 0, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER);
+
+    // One descriptor set and draw per page:
+    auto node = vsg::Group::create();
+    for (auto& page : batch.pages)
+    {
+        vsg::Descriptors descriptors{
+            vsg::DescriptorBuffer::create(page.data, INSTANCE_BINDING, 0, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER),
+            textureDescriptor,
+            batchDescriptor };
+
+        auto stateGroup = vsg::StateGroup::create();
+        stateGroup->stateCommands.push_back(vsg::BindDescriptorSet::create(
+            VK_PIPELINE_BIND_POINT_GRAPHICS, _config->layout, INSTANCE_SET,
+            vsg::DescriptorSet::create(_config->layout->setLayouts.front(), descriptors)));
+        stateGroup->addChild(page.draw);
+        node->addChild(stateGroup);
+    }
+
+    if (batch.node)
+    {
+        runtime.dispose(batch.node);
+    }
+
+    runtime.compile(node);
+    batch.node = node;
+    batch.rebuild = false;
+}
+
+void
+IconInstancer::update(Runtime& runtime)
+{
+    ROCKY_PROFILE_FUNCTION();
+
+    _stats.pagesUploaded = 0;
+
+    // We need the world SRS from a record traversal before we can place anything.
+    {
+        std::scoped_lock lock(_worldSRSMutex);
+        if (_worldSRS != _instanceSRS)
+        {
+            _instanceSRS = _worldSRS;
+            _resync = true;
+        }
+    }
+
+    if (!_instanceSRS.valid())
+        return;
+
+    // New icons get a slot:
+    _newEntities.clear();
+    _registry.view<Icon, Transform>(entt::exclude<Slot>).each([&](const entt::entity entity, const Icon&, const Transform& xform)
+        {
+            if (xform.node)
+                _newEntities.emplace_back(entity);
+        });
+
+    for (auto entity : _newEntities)
+    {
+        _registry.emplace<Slot>(entity);
+    }
+
+    // Write any icons that changed since last frame:
+    _registry.view<Icon, Transform, Slot>().each([&](const entt::entity entity, const Icon& icon, const Transform& xform, Slot& slot)
+        {
+            if (!xform.node)
+            {
+                // lost its position; keep the slot but free the instance
+                free(slot);
+                return;
+            }
+
+            const auto& image = icon.image ? icon.image : _defaultImage;
+
+            if (slot.batch == nullptr || slot.image != image.get())
+            {
+                free(slot);
+
+                glm::dvec3 world(0, 0, 0);
+                xform.node->position.transform(_instanceSRS, world);
+
+                slot.batch = getOrCreateBatch(*image);
+                slot.index = acquire(*slot.batch, image, vsg::dvec3(world.x, world.y, world.z));
+                slot.image = image.get();
+                slot.transformRevision = -1;
+            }
+
+            bool active = *icon.active_ptr;
+
+            if (_resync ||
+                slot.transformRevision != xform.node->revision ||
+                slot.iconRevision != icon.revision ||
+                slot.active != active)
+            {
+                write(slot, icon, *xform.node);
+                slot.transformRevision = xform.node->revision;
+                slot.iconRevision = icon.revision;
+                slot.active = active;
+            }
+        });
+
+    _resync = false;
+
+    // Rebuild batches with new images or pages, and upload only the dirty pages.
+    _stats.batches = 0;
+    _stats.draws = 0;
+
+    for (auto& batch : _batches)
+    {
+        if (batch->pages.empty())
+            continue;
+
+        if (batch->rebuild)
+        {
+            auto& center = batch->batchData->at(0);
+            center = vsg::vec4(-batch->anchor.x, -batch->anchor.y, -batch->anchor.z, 0.0);
+
+            auto& inv_radii = batch->batchData->at(1);
+            if (_instanceSRS.isGeocentric())
+            {
+                auto& e = _instanceSRS.ellipsoid();
+                inv_radii = vsg::vec4(1.0 / e.semiMajorAxis(), 1.0 / e.semiMajorAxis(), 1.0 / e.semiMinorAxis(), 0.0);
+            }
+            else
+            {
+                inv_radii = vsg::vec4(0, 0, 0, 0);
+            }
+            batch->batchData->dirty();
+
+            rebuild(*batch, runtime);
+        }
+
+        for (auto& page : batch->pages)
+        {
+            page.draw->instanceCount = page.count;
+
+            if (page.dirty)
+            {
+                page.data->dirty();
+                page.dirty = false;
+                ++_stats.pagesUploaded;
+            }
+
+            if (page.count > 0)
+                ++_stats.draws;
+        }
+
+        ++_stats.batches;
+    }
+}
+
+void
+IconInstancer::compile(vsg::Context& context)
+{
+    if (_pipelineCommands)
+    {
+        _pipelineCommands->compile(context);
+    }
+
+    util::SimpleCompiler compiler(context);
+    for (auto& batch : _batches)
+    {
+        if (batch->node)
+            batch->node->accept(compiler);
+    }
+}
+
+void
+IconInstancer::record(vsg::RecordTraversal& rt) const
+{
+    ROCKY_PROFILE_FUNCTION();
+
+    auto& context = CullContext::get(rt);
+
+    // Remember the world SRS for the next update.
+    if (context.worldSRS.valid())
+    {
+        std::scoped_lock lock(_worldSRSMutex);
+        if (context.worldSRS != _worldSRS)
+            _worldSRS = context.worldSRS;
+    }
+
+    if (!_pipelineCommands || _stats.draws == 0)
+        return;
+
+    _pipelineCommands->accept(rt);
+
+    auto state = rt.getState();
+
+    for (auto& batch : _batches)
+    {
+        if (batch->node)
+        {
+            // Instance positions are relative to the anchor:
+            state->modelviewMatrixStack.push(state->modelviewMatrixStack.top() * vsg::translate(batch->anchor));
+            state->dirty = true;
+
+            batch->node->accept(rt);
+
+            state->modelviewMatrixStack.pop();
+            state->dirty = true;
+        }
+    }
+}
@@ -0,0 +1,130 @@
+/**
+ * rocky c++
+ * Copyright 2023 Pelican Mapping
+ * MIT License
+ */
+#pragma once
+#include <rocky_vsg/Icon.h>
+#include <rocky_vsg/ECS.h>
+#include <rocky/SRS.h>
+#include <vsg/commands/Draw.h>
+#include <map>
+#include <memory>
+#include <mutex>
+
+namespace ROCKY_NAMESPACE
+{
+    class Runtime;
+
+    /**
+     * Renders Icon components with GPU instancing. Icons whose images have
+     * the same dimensions share a batch: the images live in the layers of one
+     * texture array, and the icons in a per-instance storage buffer (position,
+     * style, texture layer). Each page of the storage buffer is one draw.
+     *
+     * Only icons with a Transform are drawn. The instance position comes
+     * from the Transform's GeoTransform node; local matrices and parent
+     * transforms are not applied.
+     *
+     * Used by IconSystemNode when IconSystemNode::instanced is set.
+     */
+    class ROCKY_VSG_EXPORT IconInstancer
+    {
+    public:
+        //! Number of instances in each storage buffer page
+        static constexpr std::uint32_t page_size = 4096;
+
+        //! Maximum number of distinct images in a batch
+        static constexpr std::uint32_t max_layers = 256;
+
+        //! Construct the instancer
+        IconInstancer(entt::registry& registry);
+
+        //! Destructor
+        ~IconInstancer();
+
+        IconInstancer(const IconInstancer&) = delete;
+
+        //! Create the graphics pipeline (once)
+        Status initialize(Runtime& runtime);
+
+        //! Bring the instance data up to date with the registry (once per frame)
+        void update(Runtime& runtime);
+
+        //! Compile the pipeline and batches
+        void compile(vsg::Context& context);
+
+        //! Record all batches
+        void record(vsg::RecordTraversal& rt) const;
+
+        //! Per-frame statistics
+        struct Stats
+        {
+            std::size_t instances = 0;
+            std::size_t batches = 0;
+            std::size_t draws = 0;
+            std::size_t pagesUploaded = 0;
+        };
+        Stats stats() const { return _stats; }
+
+    private:
+        // A slice of a batch's storage buffer, drawn with one command
+        struct Page
+        {
+            // 2 vec4s per instance; see rocky.icon.instanced.vert
+            vsg::ref_ptr<vsg::vec4Array> data;
+            vsg::ref_ptr<vsg::Draw> draw;
+            std::uint32_t count = 0; // high-water mark of used instances
+            bool dirty = false;
+        };
+
+        // All icons whose images share the same dimensions
+        struct Batch
+        {
+            std::uint32_t width = 0, height = 0;
+            std::vector<std::shared_ptr<Image>> layers;
+            std::map<const Image*, std::uint32_t> layerOf;
+            std::vector<Page> pages;
+            std::vector<std::uint32_t> freeList;
+            vsg::dvec3 anchor;
+            vsg::ref_ptr<vsg::vec4Array> batchData;
+            vsg::ref_ptr<vsg::Group> node;
+            bool rebuild = true;
+        };
+
+        // Registry component tying an entity to its instance
+        struct Slot
+        {
+            Batch* batch = nullptr;
+            std::uint32_t index = 0;
+            const Image* image = nullptr;
+            Revision transformRevision = -1;
+            Revision iconRevision = -1;
+            bool active = false;
+        };
+
+        entt::registry& _registry;
+        std::vector<std::unique_ptr<Batch>> _batches;
+        vsg::ref_ptr<vsg::GraphicsPipelineConfigurator> _config;
+        vsg::ref_ptr<vsg::Commands> _pipelineCommands;
+        Stats _stats;
+        std::shared_ptr<Image> _defaultImage;
+        std::vector<entt::entity> _newEntities;
+        bool _resync = false;
+
+        // world SRS, as seen by the most recent record traversal
+        mutable std::mutex _worldSRSMutex;
+        mutable SRS _worldSRS;
+        SRS _instanceSRS;
+        SRS _toWorldSource;
+        SRSOperation _toWorld;
+
+        Batch* getOrCreateBatch(const Image& image);
+        std::uint32_t acquire(Batch& batch, const std::shared_ptr<Image>& image, const vsg::dvec3& world);
+        void free(Slot& slot);
+        void removeSlot(entt::registry&, entt::entity);
+        void releaseSlot(entt::registry&, entt::entity);
+        void write(Slot& slot, const Icon& icon, const GeoTransform& xform);
+        void rebuild(Batch& batch, Runtime& runtime);
+    };
+}
@@ -112,31 +112,7 @@ IconSystemNode::initialize(Runtime& runtime)
 
         PipelineUtils::enableViewDependentData(c.config);
 
-        struct SetPipelineStates : public vsg::Visitor
-        {
-            int feature_mask;
-            SetPipelineStates(int feature_mask_) : feature_mask(feature_mask_) { }
-            void apply(vsg::Object& object) override {
-                object.traverse(*this);
-            }
-            void apply(vsg::RasterizationState& state) override {
-                state.cullMode = VK_CULL_MODE_NONE;
-            }
-            void apply(vsg::DepthStencilState& state) override {
-                state.depthCompareOp = VK_COMPARE_OP_ALWAYS;
-                state.depthTestEnable = VK_FALSE;
-                state.depthWriteEnable = VK_FALSE;
-            }
-            void apply(vsg::ColorBlendState& state) override {
-                state.attachments = vsg::ColorBlendState::ColorBlendAttachments{
-                    { true,
-                      VK_BLEND_FACTOR_SRC_ALPHA, VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA, VK_BLEND_OP_ADD,
-                      VK_BLEND_FACTOR_SRC_ALPHA, VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA, VK_BLEND_OP_ADD,
-                      VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT | VK_COLOR_COMPONENT_B_BIT | VK_COLOR_COMPONENT_A_BIT }
-                };
-            }
-        };
-        c.config->accept(SetPipelineStates(feature_mask));
+        PipelineUtils::setOverlayStates(c.config);
 
         c.config->init();
 
@@ -144,6 +120,37 @@ IconSystemNode::initialize(Runtime& runtime)
         c.commands->addChild(c.config->bindGraphicsPipeline);
         c.commands->addChild(PipelineUtils::createViewDependentBindCommand(c.config));
     }
+
+    auto instancerStatus = instancer.initialize(runtime);
+    if (instancerStatus.failed())
+    {
+        Log()->warn(instancerStatus.message);
+    }
+}
+
+void
+IconSystemNode::update(Runtime& runtime)
+{
+    if (instanced)
+        instancer.update(runtime);
+    else
+        helper.initializeNewComponents(runtime);
+}
+
+void
+IconSystemNode::compile(vsg::Context& context)
+{
+    helper.compile(context);
+    instancer.compile(context);
+}
+
+void
+IconSystemNode::traverse(vsg::RecordTraversal& rt) const
+{
+    if (instanced)
+        instancer.record(rt);
+    else
+        helper.record(rt);
 }
 
 int IconSystemNode::featureMask(const Icon& component)
@@ -6,6 +6,7 @@
 #pragma once
 #include <rocky_vsg/Icon.h>
 #include <rocky_vsg/ECS.h>
+#include <rocky_vsg/engine/IconInstancer.h>
 
 namespace ROCKY_NAMESPACE
 {
@@ -20,7 +21,11 @@ namespace ROCKY_NAMESPACE
     public:
         //! Construct the mesh renderer
         IconSystemNode(entt::registry& registry) :
-            helper(registry) { }
+            helper(registry), instancer(registry) { }
+
+        //! Draw icons with GPU instancing, a few draws for all of them,
+        //! instead of one draw per icon. See IconInstancer.
+        bool instanced = false;
 
         //! Features supported by this renderer
         enum Features
@@ -35,7 +40,19 @@ namespace ROCKY_NAMESPACE
         //! Initialize the system (once)
         void initialize(Runtime&) override;
 
-        ROCKY_VSG_SYSTEM_HELPER(Icon, helper);
+        //! Update the system (once per frame)
+        void update(Runtime&) override;
+
+        ECS::VSG_SystemHelper<Icon> helper;
+        IconInstancer instancer;
+
+        void accept(vsg::Visitor& v) override { helper.accept(v); }
+        void accept(vsg::ConstVisitor& v) const override { helper.accept(v); }
+        void compile(vsg::Context& context) override;
+        void traverse(vsg::RecordTraversal& rt) const override;
+
+    protected:
+        void initializeNewComponents(Runtime& runtime) override { helper.initializeNewComponents(runtime); }
     };
 
     /**
@@ -0,0 +1,664 @@
+/**
+ * rocky c++
+ * Copyright 2023 Pelican Mapping
+ * MIT License
+ */
+#include "LabelBatcher.h"
+#include "Runtime.h"
+#include "Utils.h"
+#include "PipelineState.h"
+#include <rocky_vsg/GeoTransform.h>
+
+#include <vsg/maths/transform.h>
+#include <vsg/state/BindDescriptorSet.h>
+#include <vsg/state/DescriptorBuffer.h>
+#include <vsg/state/DescriptorImage.h>
+#include <vsg/nodes/StateGroup.h>
+
+using namespace ROCKY_NAMESPACE;
+
+#define LC "[LabelBatcher] "
+
+#define VERT_SHADER "shaders/rocky.label.batched.vert"
+#define FRAG_SHADER "shaders/rocky.label.batched.frag"
+
+#define GLYPH_SET 0 // must match layout(set=X) in the shader
+#define GLYPH_BINDING 1 // must match the layout(binding=X) of the glyph buffer
+#define LABEL_BINDING 2 // must match the layout(binding=X) of the label buffer
+#define ATLAS_BINDING 3 // must match the layout(binding=X) of the font atlas
+#define BATCH_BINDING 4 // must match the layout(binding=X) of the batch uniform
+
+namespace
+{
+    vsg::ref_ptr<vsg::ShaderSet> createShaderSet(Runtime& runtime)
+    {
+        vsg::ref_ptr<vsg::ShaderSet> shaderSet;
+
+        // load shaders
+        auto vertexShader = vsg::ShaderStage::read(
+            VK_SHADER_STAGE_VERTEX_BIT,
+            "main",
+            vsg::findFile(VERT_SHADER, runtime.searchPaths),
+            runtime.readerWriterOptions);
+
+        auto fragmentShader = vsg::ShaderStage::read(
+            VK_SHADER_STAGE_FRAGMENT_BIT,
+            "main",
+            vsg::findFile(FRAG_SHADER, runtime.searchPaths),
+            runtime.readerWriterOptions);
+
+        if (!vertexShader || !fragmentShader)
+        {
+            return { };
+        }
+
+        vsg::ShaderStages shaderStages{ vertexShader, fragmentShader };
+
+        shaderSet = vsg::ShaderSet::create(shaderStages);
+
+        // per-glyph data (no vertex attributes; the shader builds the quads)
+        shaderSet->addUniformBinding(
+            "glyphs", "",
+            GLYPH_SET, GLYPH_BINDING,
+            VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1, VK_SHADER_STAGE_VERTEX_BIT, {});
+
+        // per-label data
+        shaderSet->addUniformBinding(
+            "labels", "",
+            GLYPH_SET, LABEL_BINDING,
+            VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1, VK_SHADER_STAGE_VERTEX_BIT, {});
+
+        // the font's signed-distance-field glyph atlas
+        shaderSet->addUniformBinding(
+            "font_atlas", "",
+            GLYPH_SET, ATLAS_BINDING,
+            VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 1, VK_SHADER_STAGE_FRAGMENT_BIT, {});
+
+        // batch anchor and ellipsoid for horizon culling
+        shaderSet->addUniformBinding(
+            "batch", "",
+            GLYPH_SET, BATCH_BINDING,
+            VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 1, VK_SHADER_STAGE_VERTEX_BIT, {});
+
+        // We need VSG's view-dependent data:
+        PipelineUtils::addViewDependentData(shaderSet, VK_SHADER_STAGE_VERTEX_BIT);
+
+        // Note: 128 is the maximum size required by the Vulkan spec so don't increase it
+        shaderSet->addPushConstantRange("pc", "", VK_SHADER_STAGE_VERTEX_BIT, 0, 128);
+
+        return shaderSet;
+    }
+
+    // Smallest glyph run that holds the number of glyphs. Powers of two
+    // keep the free lists reusable and never let a run straddle a page.
+    std::uint32_t runCapacity(std::uint32_t glyphs)
+    {
+        std::uint32_t capacity = 8;
+        while (capacity < glyphs)
+            capacity <<= 1;
+        return capacity;
+    }
+
+    bool sameLayout(const LabelStyle& a, const LabelStyle& b)
+    {
+        return
+            a.font == b.font &&
+            a.pointSize == b.pointSize &&
+            a.outlineSize == b.outlineSize &&
+            a.horizontalAlignment == b.horizontalAlignment &&
+            a.verticalAlignment == b.verticalAlignment;
+    }
+}
+
+LabelBatcher::LabelBatcher(entt::registry& registry) :
+    _registry(registry)
+{
+    // A label entry goes away with its Slot; the Slot goes away with the
+    // entity, or when the entity loses its Label or its Transform.
+    _registry.on_destroy<Label>().connect<&LabelBatcher::removeSlot>(*this);
+    _registry.on_destroy<Transform>().connect<&LabelBatcher::removeSlot>(*this);
+    _registry.on_destroy<Slot>().connect<&LabelBatcher::releaseSlot>(*this);
+}
+
+LabelBatcher::~LabelBatcher()
+{
+    _registry.on_destroy<Label>().disconnect<&LabelBatcher::removeSlot>(*this);
+    _registry.on_destroy<Transform>().disconnect<&LabelBatcher::removeSlot>(*this);
+    _registry.on_destroy<Slot>().disconnect<&LabelBatcher::releaseSlot>(*this);
+
+    // the slots point into our batches:
+    _registry.clear<Slot>();
+}
+
+Status
+LabelBatcher::initialize(Runtime& runtime)
+{
+    auto shaderSet = createShaderSet(runtime);
+
+    if (!shaderSet)
+    {
+        return Status(Status::ResourceUnavailable,
+            "Batched label shaders are missing or corrupt. "
+            "Did you set ROCKY_FILE_PATH to point at the rocky share folder?");
+    }
+
+    _config = vsg::GraphicsPipelineConfigurator::create(shaderSet);
+    _config->shaderHints = runtime.shaderCompileSettings;
+
+    _config->enableUniform("glyphs");
+    _config->enableUniform("labels");
+    _config->enableTexture("font_atlas");
+    _config->enableUniform("batch");
+
+    PipelineUtils::enableViewDependentData(_config);
+
+    PipelineUtils::setOverlayStates(_config);
+
+    _config->init();
+
+    _pipelineCommands = vsg::Commands::create();
+    _pipelineCommands->addChild(_config->bindGraphicsPipeline);
+    _pipelineCommands->addChild(PipelineUtils::createViewDependentBindCommand(_config));
+
+    return StatusOK;
+}
+
+LabelBatcher::Batch*
+LabelBatcher::getOrCreateBatch(vsg::ref_ptr<vsg::Font> font)
+{
+    for (auto& batch : _batches)
+    {
+        if (batch->font == font)
+            return batch.get();
+    }
+
+    auto batch = std::make_unique<Batch>();
+    batch->font = font;
+    batch->batchData = vsg::vec4Array::create(2);
+    batch->batchData->properties.dataVariance = vsg::DYNAMIC_DATA;
+    _batches.emplace_back(std::move(batch));
+    return _batches.back().get();
+}
+
+std::uint32_t
+LabelBatcher::acquireLabel(Batch& batch, const vsg::dvec3& world)
+{
+    std::uint32_t index;
+    if (!batch.freeLabels.empty())
+    {
+        index = batch.freeLabels.back();
+        batch.freeLabels.pop_back();
+    }
+    else
+    {
+        if (!batch.labelData)
+        {
+            // anchor the batch near its first label, keeping float precision
+            // good for labels in the same region
+            batch.anchor = world;
+        }
+
+        index = batch.labelEnd++;
+
+        if (!batch.labelData || index >= batch.labelData->size())
+        {
+            // grow the label buffer; the descriptors must follow it
+            auto size = (batch.labelData ? (std::uint32_t)batch.labelData->size() : 0u) + label_block_size;
+            auto data = vsg::vec4Array::create(size);
+            data->properties.dataVariance = vsg::DYNAMIC_DATA;
+            if (batch.labelData)
+                std::copy(batch.labelData->begin(), batch.labelData->end(), data->begin());
+            batch.labelData = data;
+            batch.rebuild = true;
+        }
+    }
+
+    ++_stats.labels;
+    return index;
+}
+
+std::uint32_t
+LabelBatcher::acquireRun(Batch& batch, std::uint32_t capacity)
+{
+    auto& freeList = batch.freeRuns[capacity];
+    if (!freeList.empty())
+    {
+        auto run = freeList.back();
+        freeList.pop_back();
+        return run;
+    }
+
+    // align to the capacity so the run stays inside one page
+    auto run = (batch.glyphEnd + capacity - 1) / capacity * capacity;
+    batch.glyphEnd = run + capacity;
+
+    while (batch.pages.size() * page_size < batch.glyphEnd)
+    {
+        Page page;
+        page.data = vsg::vec4Array::create(page_size * 3);
+        page.data->properties.dataVariance = vsg::DYNAMIC_DATA;
+        page.draw = vsg::Draw::create(6, 0, 0, 0);
+        batch.pages.emplace_back(std::move(page));
+        batch.rebuild = true;
+    }
+
+    auto& page = batch.pages[run / page_size];
+    page.count = std::max(page.count, run % page_size + capacity);
+
+    return run;
+}
+
+void
+LabelBatcher::freeRun(Batch& batch, std::uint32_t run, std::uint32_t capacity)
+{
+    auto& page = batch.pages[run / page_size];
+    auto* glyph = &page.data->at((run % page_size) * 3);
+    std::fill(glyph, glyph + capacity * 3, vsg::vec4(0, 0, 0, 0));
+    page.dirty = true;
+
+    batch.freeRuns[capacity].push_back(run);
+}
+
+void
+LabelBatcher::free(Slot& slot)
+{
+    if (slot.batch)
+    {
+        auto& batch = *slot.batch;
+
+        // hide it; the next new label in this batch reuses the entry
+        batch.labelData->at(slot.label).w = 0.0f;
+        batch.labelsDirty = true;
+        batch.freeLabels.push_back(slot.label);
+
+        if (slot.capacity > 0)
+        {
+            freeRun(batch, slot.run, slot.capacity);
+            slot.capacity = 0;
+        }
+
+        slot.batch = nullptr;
+        --_stats.labels;
+    }
+}
+
+void
+LabelBatcher::removeSlot(entt::registry& registry, entt::entity entity)
+{
+    registry.remove<Slot>(entity);
+}
+
+void
+LabelBatcher::releaseSlot(entt::registry& registry, entt::entity entity)
+{
+    free(registry.get<Slot>(entity));
+}
+
+void
+LabelBatcher::layout(Slot& slot, const Label& label)
+{
+    auto& batch = *slot.batch;
+    auto& font = *batch.font;
+
+    // glyphs needed, ignoring line breaks
+    std::uint32_t needed = 0;
+    for (auto c : label.text)
+        if (c != '\n') ++needed;
+    needed = std::min(needed, max_glyphs);
+
+    auto capacity = runCapacity(needed);
+    if (capacity != slot.capacity)
+    {
+        if (slot.capacity > 0)
+            freeRun(batch, slot.run, slot.capacity);
+
+        slot.run = acquireRun(batch, capacity);
+        slot.capacity = capacity;
+    }
+
+    auto& page = batch.pages[slot.run / page_size];
+    auto* glyphs = &page.data->at((slot.run % page_size) * 3);
+
+    // Lay out in font units, y-up, with the pen starting at the first baseline,
+    // following vsg::StandardLayout.
+    const float lineHeight = font.height > 0.0f ? font.height : 1.0f;
+    const float outline = std::min(label.style.outlineSize, 0.45f);
+    vsg::vec2 pen(0.0f, 0.0f);
+    std::uint32_t count = 0;
+
+    _lineWidths.clear();
+    _lineOfGlyph.clear();
+
+    for (auto c : label.text)
+    {
+        if (c == '\n')
+        {
+            _lineWidths.push_back(pen.x);
+            pen.x = 0.0f;
+            pen.y -= lineHeight;
+            continue;
+        }
+
+        auto& metrics = font.glyphMetrics->at(font.glyphIndexForCharcode((std::uint8_t)c));
+
+        if (metrics.width > 0.0f && metrics.height > 0.0f && count < capacity)
+        {
+            float x0 = pen.x + metrics.horiBearingX;
+            float y0 = pen.y + metrics.horiBearingY - metrics.height;
+
+            glyphs[count * 3 + 0] = vsg::vec4(x0, y0, x0 + metrics.width, y0 + metrics.height);
+            glyphs[count * 3 + 1] = metrics.uvrect;
+            glyphs[count * 3 + 2] = vsg::vec4((float)slot.label, outline, 1.0f, 0.0f);
+            _lineOfGlyph.push_back((std::uint32_t)_lineWidths.size());
+            ++count;
+        }
+
+        pen.x += metrics.horiAdvance;
+    }
+    _lineWidths.push_back(pen.x);
+
+    // Alignment. (vsg::StandardLayout aliases LEFT, BOTTOM and BASELINE,
+    // and RIGHT and TOP, so compare instead of switching.)
+    auto halign = label.style.horizontalAlignment;
+    auto valign = label.style.verticalAlignment;
+
+    float top = font.ascender > 0.0f ? font.ascender : lineHeight;
+    float bottom = pen.y + font.descender;
+    float dy =
+        valign == vsg::StandardLayout::CENTER_ALIGNMENT ? -0.5f * (top + bottom) :
+        valign == vsg::StandardLayout::TOP_ALIGNMENT ? -top :
+        0.0f;
+
+    const float size = label.style.pointSize;
+
+    for (std::uint32_t i = 0; i < count; ++i)
+    {
+        float width = _lineWidths[_lineOfGlyph[i]];
+        float dx =
+            halign == vsg::StandardLayout::CENTER_ALIGNMENT ? -0.5f * width :
+            halign == vsg::StandardLayout::RIGHT_ALIGNMENT ? -width :
+            0.0f;
+
+        // font units to pixels
+        auto& rect = glyphs[i * 3];
+        rect = vsg::vec4(rect.x + dx, rect.y + dy, rect.z + dx, rect.w + dy) * size;
+    }
+
+    // hide the rest of the run
+    std::fill(glyphs + count * 3, glyphs + capacity * 3, vsg::vec4(0, 0, 0, 0));
+
+    page.dirty = true;
+    slot.text = label.text;
+    slot.style = label.style;
+    ++_stats.layouts;
+}
+
+void
+LabelBatcher::writePosition(Slot& slot, const Label& label, const GeoTransform& xform)
+{
+    glm::dvec3 world(0, 0, 0);
+    bool ok = false;
+
+    if (xform.position.srs() == _labelSRS)
+    {
+        world = glm::dvec3(xform.position.x, xform.position.y, xform.position.z);
+        ok = true;
+    }
+    else
+    {
+        if (xform.position.srs() != _toWorldSource)
+        {
+            _toWorldSource = xform.position.srs();
+            _toWorld = _toWorldSource.to(_labelSRS);
+        }
+        ok = _toWorld.transform(glm::dvec3(xform.position.x, xform.position.y, xform.position.z), world);
+    }
+
+    auto& batch = *slot.batch;
+
+    batch.labelData->at(slot.label) = vsg::vec4(
+        (float)(world.x - batch.anchor.x),
+        (float)(world.y - batch.anchor.y),
+        (float)(world.z - batch.anchor.z),
+        (ok && *label.active_ptr) ? 1.0f : 0.0f);
+
+    batch.labelsDirty = true;
+}
+
+void
+LabelBatcher::rebuild(Batch& batch, Runtime& runtime)
+{
+    ROCKY_PROFILE_FUNCTION();
+
+    auto sampler = vsg::Sampler::create();
+    sampler->minFilter = VK_FILTER_LINEAR;
+    sampler->magFilter = VK_FILTER_LINEAR;
+    sampler->addressModeU = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+    sampler->addressModeV = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+    sampler->addressModeW = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+
+    auto atlasDescriptor = vsg::DescriptorImage::create(
+        sampler, batch.font->atlas, ATLAS_BINDING, 0, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER);
+
+    auto labelDescriptor = vsg::DescriptorBuffer::create(
+        batch.labelData, LABEL_BINDING, 0, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER);
+
+    auto batchDescriptor = vsg::DescriptorBuffer::create(
+        batch.batchData, BATCH_BINDING, 0, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER);
+
+    // One descriptor set and draw per page:
+    auto node = vsg::Group::create();
+    for (auto& page : batch.pages)
+    {
+        vsg::Descriptors descriptors{
+            vsg::DescriptorBuffer::create(page.data, GLYPH_BINDING, 0, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER),
+            labelDescriptor,
+            atlasDescriptor,
+            batchDescriptor };
+
+        auto stateGroup = vsg::StateGroup::create();
+        stateGroup->stateCommands.push_back(vsg::BindDescriptorSet::create(
+            VK_PIPELINE_BIND_POINT_GRAPHICS, _config->layout, GLYPH_SET,
+            vsg::DescriptorSet::create(_config->layout->setLayouts.front(), descriptors)));
+        stateGroup->addChild(page.draw);
+        node->addChild(stateGroup);
+    }
+
+    if (batch.node)
+    {
+        runtime.dispose(batch.node);
+    }
+
+    runtime.compile(node);
+    batch.node = node;
+    batch.rebuild = false;
+}
+
+void
+LabelBatcher::update(Runtime& runtime)
+{
+    ROCKY_PROFILE_FUNCTION();
+
+    _stats.pagesUploaded = 0;
+    _stats.layouts = 0;
+
+    // We need the world SRS from a record traversal before we can place anything.
+    {
+        std::scoped_lock lock(_worldSRSMutex);
+        if (_worldSRS != _labelSRS)
+        {
+            _labelSRS = _worldSRS;
+            _resync = true;
+        }
+    }
+
+    if (!_labelSRS.valid())
+        return;
+
+    // New labels get a slot:
+    _newEntities.clear();
+    _registry.view<Label, Transform>(entt::exclude<Slot>).each([&](const entt::entity entity, const Label&, const Transform& xform)
+        {
+            if (xform.node)
+                _newEntities.emplace_back(entity);
+        });
+
+    for (auto entity : _newEntities)
+    {
+        _registry.emplace<Slot>(entity);
+    }
+
+    // Lay out labels whose text changed, and place those that moved:
+    _registry.view<Label, Transform, Slot>().each([&](const entt::entity entity, const Label& label, const Transform& xform, Slot& slot)
+        {
+            if (!xform.node || !label.style.font)
+            {
+                // nothing to place or draw; keep the slot but free the label
+                free(slot);
+                return;
+            }
+
+            if (slot.batch == nullptr || slot.batch->font != label.style.font)
+            {
+                free(slot);
+
+                glm::dvec3 world(0, 0, 0);
+                xform.node->position.transform(_labelSRS, world);
+
+                slot.batch = getOrCreateBatch(label.style.font);
+                slot.label = acquireLabel(*slot.batch, vsg::dvec3(world.x, world.y, world.z));
+                slot.transformRevision = -1;
+                slot.labelRevision = -1;
+            }
+
+            if (slot.labelRevision != label.revision)
+            {
+                // dirty() was called, but the text may be the same
+                if (slot.capacity == 0 || slot.text != label.text || !sameLayout(slot.style, label.style))
+                {
+                    layout(slot, label);
+                }
+                slot.labelRevision = label.revision;
+            }
+
+            bool active = *label.active_ptr;
+
+            if (_resync ||
+                slot.transformRevision != xform.node->revision ||
+                slot.active != active)
+            {
+                writePosition(slot, label, *xform.node);
+                slot.transformRevision = xform.node->revision;
+                slot.active = active;
+            }
+        });
+
+    _resync = false;
+
+    // Rebuild batches with new pages or a bigger label buffer, and upload only what changed.
+    _stats.batches = 0;
+    _stats.draws = 0;
+
+    for (auto& batch : _batches)
+    {
+        if (batch->pages.empty())
+            continue;
+
+        if (batch->rebuild)
+        {
+            auto& center = batch->batchData->at(0);
+            center = vsg::vec4(-batch->anchor.x, -batch->anchor.y, -batch->anchor.z, 0.0);
+
+            auto& inv_radii = batch->batchData->at(1);
+            if (_labelSRS.isGeocentric())
+            {
+                auto& e = _labelSRS.ellipsoid();
+                inv_radii = vsg::vec4(1.0 / e.semiMajorAxis(), 1.0 / e.semiMajorAxis(), 1.0 / e.semiMinorAxis(), 0.0);
+            }
+            else
+            {
+                inv_radii = vsg::vec4(0, 0, 0, 0);
+            }
+            batch->batchData->dirty();
+
+            rebuild(*batch, runtime);
+        }
+
+        if (batch->labelsDirty)
+        {
+            batch->labelData->dirty();
+            batch->labelsDirty = false;
+        }
+
+        for (auto& page : batch->pages)
+        {
+            page.draw->instanceCount = page.count;
+
+            if (page.dirty)
+            {
+                page.data->dirty();
+                page.dirty = false;
+                ++_stats.pagesUploaded;
+            }
+
+            if (page.count > 0)
+                ++_stats.draws;
+        }
+
+        ++_stats.batches;
+    }
+}
+
+void
+LabelBatcher::compile(vsg::Context& context)
+{
+    if (_pipelineCommands)
+    {
+        _pipelineCommands->compile(context);
+    }
+
+    util::SimpleCompiler compiler(context);
+    for (auto& batch : _batches)
+    {
+        if (batch->node)
+            batch->node->accept(compiler);
+    }
+}
+
+void
+LabelBatcher::record(vsg::RecordTraversal& rt) const
+{
+    ROCKY_PROFILE_FUNCTION();
+
+    auto& context = CullContext::get(rt);
+
+    // Remember the world SRS for the next update.
+    if (context.worldSRS.valid())
+    {
+        std::scoped_lock lock(_worldSRSMutex);
+        if (context.worldSRS != _worldSRS)
+            _worldSRS = context.worldSRS;
+    }
+
+    if (!_pipelineCommands || _stats.draws == 0)
+        return;
+
+    _pipelineCommands->accept(rt);
+
+    auto state = rt.getState();
+
+    for (auto& batch : _batches)
+    {
+        if (batch->node)
+        {
+            // Label positions are relative to the anchor:
+            state->modelviewMatrixStack.push(state->modelviewMatrixStack.top() * vsg::translate(batch->anchor));
+            state->dirty = true;
+
+            batch->node->accept(rt);
+
+            state->modelviewMatrixStack.pop();
+            state->dirty = true;
+        }
+    }
+}
@@ -0,0 +1,149 @@
+/**
+ * rocky c++
+ * Copyright 2023 Pelican Mapping
+ * MIT License
+ */
+#pragma once
+#include <rocky_vsg/Label.h>
+#include <rocky_vsg/ECS.h>
+#include <rocky/SRS.h>
+#include <vsg/commands/Draw.h>
+#include <map>
+#include <memory>
+#include <mutex>
+
+namespace ROCKY_NAMESPACE
+{
+    class Runtime;
+
+    /**
+     * Renders Label components as batches of glyph quads. Labels that use
+     * the same font share a batch: the font's glyph atlas is the one texture,
+     * each label has one entry in a per-batch label buffer (position,
+     * visibility), and each laid-out glyph is one instance in a glyph storage
+     * buffer (pixel rectangle, atlas rectangle, label index). Each page of the
+     * glyph buffer is one draw.
+     *
+     * Text is laid out on the CPU, and only when a label's text or style
+     * actually changes. Moving a label rewrites only its position.
+     *
+     * Only labels with a Transform are drawn. The label position comes
+     * from the Transform's GeoTransform node; local matrices and parent
+     * transforms are not applied.
+     *
+     * Used by LabelSystemNode when LabelSystemNode::batched is set.
+     */
+    class ROCKY_VSG_EXPORT LabelBatcher
+    {
+    public:
+        //! Number of glyphs in each storage buffer page
+        static constexpr std::uint32_t page_size = 16384;
+
+        //! Maximum number of glyphs drawn for one label
+        static constexpr std::uint32_t max_glyphs = 256;
+
+        //! Number of labels added to a batch's label buffer when it fills up
+        static constexpr std::uint32_t label_block_size = 4096;
+
+        //! Construct the batcher
+        LabelBatcher(entt::registry& registry);
+
+        //! Destructor
+        ~LabelBatcher();
+
+        LabelBatcher(const LabelBatcher&) = delete;
+
+        //! Create the graphics pipeline (once)
+        Status initialize(Runtime& runtime);
+
+        //! Bring the glyph and label data up to date with the registry (once per frame)
+        void update(Runtime& runtime);
+
+        //! Compile the pipeline and batches
+        void compile(vsg::Context& context);
+
+        //! Record all batches
+        void record(vsg::RecordTraversal& rt) const;
+
+        //! Per-frame statistics
+        struct Stats
+        {
+            std::size_t labels = 0;
+            std::size_t batches = 0;
+            std::size_t draws = 0;
+            std::size_t layouts = 0;
+            std::size_t pagesUploaded = 0;
+        };
+        Stats stats() const { return _stats; }
+
+    private:
+        // A slice of a batch's glyph buffer, drawn with one command
+        struct Page
+        {
+            // 3 vec4s per glyph; see rocky.label.batched.vert
+            vsg::ref_ptr<vsg::vec4Array> data;
+            vsg::ref_ptr<vsg::Draw> draw;
+            std::uint32_t count = 0; // high-water mark of used glyphs
+            bool dirty = false;
+        };
+
+        // All labels that use the same font
+        struct Batch
+        {
+            vsg::ref_ptr<vsg::Font> font;
+            std::vector<Page> pages;
+            std::uint32_t glyphEnd = 0;
+            std::map<std::uint32_t, std::vector<std::uint32_t>> freeRuns; // by capacity
+            vsg::ref_ptr<vsg::vec4Array> labelData;
+            std::uint32_t labelEnd = 0;
+            std::vector<std::uint32_t> freeLabels;
+            bool labelsDirty = false;
+            vsg::dvec3 anchor;
+            vsg::ref_ptr<vsg::vec4Array> batchData;
+            vsg::ref_ptr<vsg::Group> node;
+            bool rebuild = true;
+        };
+
+        // Registry component tying an entity to its label entry and glyph run
+        struct Slot
+        {
+            Batch* batch = nullptr;
+            std::uint32_t label = 0;
+            std::uint32_t run = 0;
+            std::uint32_t capacity = 0;
+            Revision transformRevision = -1;
+            Revision labelRevision = -1;
+            std::string text;  // as last laid out
+            LabelStyle style;  // as last laid out
+            bool active = false;
+        };
+
+        entt::registry& _registry;
+        std::vector<std::unique_ptr<Batch>> _batches;
+        vsg::ref_ptr<vsg::GraphicsPipelineConfigurator> _config;
+        vsg::ref_ptr<vsg::Commands> _pipelineCommands;
+        Stats _stats;
+        std::vector<entt::entity> _newEntities;
+        std::vector<std::uint32_t> _lineOfGlyph;
+        std::vector<float> _lineWidths;
+        bool _resync = false;
+
+        // world SRS, as seen by the most recent record traversal
+        mutable std::mutex _worldSRSMutex;
+        mutable SRS _worldSRS;
+        SRS _labelSRS;
+        SRS _toWorldSource;
+        SRSOperation _toWorld;
+
+        Batch* getOrCreateBatch(vsg::ref_ptr<vsg::Font> font);
+        std::uint32_t acquireLabel(Batch& batch, const vsg::dvec3& world);
+        std::uint32_t acquireRun(Batch& batch, std::uint32_t capacity);
+        void freeRun(Batch& batch, std::uint32_t run, std::uint32_t capacity);
+        void free(Slot& slot);
+        void removeSlot(entt::registry&, entt::entity);
+        void releaseSlot(entt::registry&, entt::entity);
+        void layout(Slot& slot, const Label& label);
+        void writePosition(Slot& slot, const Label& label, const GeoTransform& xform);
+        void rebuild(Batch& batch, Runtime& runtime);
+    };
+}
@@ -29,4 +29,35 @@ LabelSystemNode::initialize(Runtime& runtime)
     depthStencilState->depthTestEnable = VK_FALSE;
     depthStencilState->depthWriteEnable = VK_FALSE;
     shaderSet->defaultGraphicsPipelineStates.push_back(depthStencilState);
+
+    auto batcherStatus = batcher.initialize(runtime);
+    if (batcherStatus.failed())
+    {
+        Log()->warn(batcherStatus.message);
+    }
+}
+
+void
+LabelSystemNode::update(Runtime& runtime)
+{
+    if (batched)
+        batcher.update(runtime);
+    else
+        helper.initializeNewComponents(runtime);
+}
+
+void
+LabelSystemNode::compile(vsg::Context& context)
+{
+    helper.compile(context);
+    batcher.compile(context);
+}
+
+void
+LabelSystemNode::traverse(vsg::RecordTraversal& rt) const
+{
+    if (batched)
+        batcher.record(rt);
+    else
+        helper.record(rt);
 }
@@ -6,6 +6,7 @@
 #pragma once
 #include <rocky_vsg/Label.h>
 #include <rocky_vsg/ECS.h>
+#include <rocky_vsg/engine/LabelBatcher.h>
 
 namespace ROCKY_NAMESPACE
 {
@@ -17,7 +18,11 @@ namespace ROCKY_NAMESPACE
     public:
         //! Construct the mesh renderer
         LabelSystemNode(entt::registry& registry) :
-            helper(registry) { }
+            helper(registry), batcher(registry) { }
+
+        //! Draw labels as batches of glyphs, a few draws per font,
+        //! instead of one text node per label. See LabelBatcher.
+        bool batched = false;
 
         enum Features
         {
@@ -30,7 +35,19 @@ namespace ROCKY_NAMESPACE
         //! One time setup of the system
         void initialize(Runtime&) override;
 
-        ROCKY_VSG_SYSTEM_HELPER(Label, helper);
+        //! Update the system (once per frame)
+        void update(Runtime&) override;
+
+        ECS::VSG_SystemHelper<Label> helper;
+        LabelBatcher batcher;
+
+        void accept(vsg::Visitor& v) override { helper.accept(v); }
+        void accept(vsg::ConstVisitor& v) const override { helper.accept(v); }
+        void compile(vsg::Context& context) override;
+        void traverse(vsg::RecordTraversal& rt) const override;
+
+    protected:
+        void initializeNewComponents(Runtime& runtime) override { helper.initializeNewComponents(runtime); }
     };
 
     class ROCKY_VSG_EXPORT LabelSystem : public ECS::VSG_System
@@ -10,6 +10,8 @@
 #include <vsg/state/BindDescriptorSet.h>
 #include <vsg/state/ViewDependentState.h>
 #include <vsg/commands/DrawIndexed.h>
+#include <vsg/state/BufferInfo.h>
+#include <vsg/vk/ResourceRequirements.h>
 
 using namespace ROCKY_NAMESPACE;
 
@@ -206,27 +208,122 @@ LineGeometry::LineGeometry()
     );
 }
 
+void
+LineGeometry::setCapacity(unsigned points)
+{
+    ROCKY_SOFT_ASSERT_AND_RETURN(_current.empty() && _size == 0, void(), "setCapacity() must precede push_back()");
+    ROCKY_SOFT_ASSERT_AND_RETURN(points >= 2, void());
+
+    _capacity = points;
+
+    auto numPages = (points + page_size - 1) / page_size;
+    _currentPages.resize(numPages);
+    _previousPages.resize(numPages);
+    _nextPages.resize(numPages);
+    _colorPages.resize(numPages);
+
+    for (unsigned i = 0; i < numPages; ++i)
+    {
+        // 4 verts per point; the final page may overhang the capacity
+        _currentPages[i] = vsg::vec3Array::create(page_size * 4);
+        _previousPages[i] = vsg::vec3Array::create(page_size * 4);
+        _nextPages[i] = vsg::vec3Array::create(page_size * 4);
+        _colorPages[i] = vsg::vec4Array::create(page_size * 4, _defaultColor);
+
+        for (auto* data : { (vsg::Data*)_currentPages[i].get(), (vsg::Data*)_previousPages[i].get(),
+            (vsg::Data*)_nextPages[i].get(), (vsg::Data*)_colorPages[i].get() })
+        {
+            data->properties.dataVariance = vsg::DYNAMIC_DATA;
+        }
+    }
+
+    // Each page is its own buffer range with its own upload, but all the pages
+    // of an attribute are packed back to back in one buffer, so we can bind
+    // each attribute at the start of its first page and draw across pages.
+    // Create the buffer infos now so the resource collector finds them all
+    // (see accept) and the transfer task uploads each page when it changes.
+    _pageBuffers.clear();
+    auto add = [&](auto& attributePages)
+        {
+            for (auto& page : attributePages)
+                _pageBuffers.push_back(vsg::BufferInfo::create(page));
+        };
+    add(_currentPages);
+    add(_previousPages);
+    add(_nextPages);
+    add(_colorPages);
+
+    arrays = {
+        _pageBuffers[0],
+        _pageBuffers[numPages],
+        _pageBuffers[numPages * 2],
+        _pageBuffers[numPages * 3] };
+
+    setFirst(0);
+    setCount(0);
+}
+
 void
 LineGeometry::setFirst(unsigned value)
 {
-    _drawCommand->firstIndex = value * 4;
+    // 6 indices per segment; see compile()
+    _drawCommand->firstIndex = value * 6;
 }
 
 void
 LineGeometry::setCount(unsigned value)
 {
-    _drawCommand->indexCount = value;
+    _drawCommand->indexCount = value > 1 ? (value - 1) * 6 : 0;
 }
 
 unsigned
 LineGeometry::numVerts() const
 {
-    return _current.size() / 4;
+    return _capacity > 0 ? _size : _current.size() / 4;
+}
+
+void
+LineGeometry::write(std::vector<vsg::ref_ptr<vsg::vec3Array>>& pages, unsigned point, const vsg::vec3& value)
+{
+    auto& page = pages[point / page_size];
+    auto* v = &page->at((point % page_size) * 4);
+    v[0] = v[1] = v[2] = v[3] = value;
+    page->dirty();
 }
 
 void
 LineGeometry::push_back(const vsg::vec3& value)
 {
+    if (_capacity > 0)
+    {
+        if (_size == _capacity)
+        {
+            pop_front();
+        }
+
+        auto point = (_first + _size) % _capacity;
+
+        if (_size > 0)
+        {
+            // the current last point now leads to the new one:
+            auto last = (point + _capacity - 1) % _capacity;
+            write(_nextPages, last, value);
+            write(_previousPages, point, _currentPages[last / page_size]->at((last % page_size) * 4));
+        }
+        else
+        {
+            write(_previousPages, point, value);
+        }
+
+        write(_currentPages, point, value);
+        write(_nextPages, point, value);
+
+        ++_size;
+        setFirst(_first);
+        setCount(_size);
+        return;
+    }
+
     bool first = _current.empty();
 
     _previous.push_back(first ? value : _current.back());
@@ -258,9 +355,87 @@ LineGeometry::push_back(const vsg::vec3& value)
     _colors.push_back(_defaultColor);
 }
 
+void
+LineGeometry::pop_front()
+{
+    ROCKY_SOFT_ASSERT_AND_RETURN(_capacity > 0, void(), "pop_front() requires a dynamic geometry");
+
+    if (_size == 0)
+        return;
+
+    _first = (_first + 1) % _capacity;
+    --_size;
+
+    if (_size > 0)
+    {
+        // the new first point starts the line:
+        write(_previousPages, _first, _currentPages[_first / page_size]->at((_first % page_size) * 4));
+    }
+
+    setFirst(_first);
+    setCount(_size);
+}
+
+void
+LineGeometry::compileDynamic(vsg::Context& context)
+{
+    // Indices for two trips around the ring, so that the live range of
+    // points is always one contiguous index range starting at _first.
+    // Segment k joins point k to point k+1 (modulo the capacity).
+    auto numVerts = _capacity * 4;
+    auto indices = vsg::uintArray::create(_capacity * 2 * 6);
+    for (unsigned k = 0, i = 0; k < _capacity * 2; ++k)
+    {
+        unsigned e = (k * 4 + 2);
+        (*indices)[i++] = (e + 3) % numVerts;
+        (*indices)[i++] = (e + 1) % numVerts;
+        (*indices)[i++] = (e + 0) % numVerts; // provoking vertex
+        (*indices)[i++] = (e + 2) % numVerts;
+        (*indices)[i++] = (e + 3) % numVerts;
+        (*indices)[i++] = (e + 0) % numVerts; // provoking vertex
+    }
+
+    vsg::createBufferAndTransferData(context, _pageBuffers, VK_BUFFER_USAGE_VERTEX_BUFFER_BIT, VK_SHARING_MODE_EXCLUSIVE);
+
+    auto indexInfo = vsg::BufferInfo::create(indices);
+    vsg::createBufferAndTransferData(context, { indexInfo }, VK_BUFFER_USAGE_INDEX_BUFFER_BIT, VK_SHARING_MODE_EXCLUSIVE);
+    this->indices = indexInfo;
+    indexType = VK_INDEX_TYPE_UINT32;
+
+    commands.clear();
+    commands.push_back(_drawCommand);
+}
+
+void
+LineGeometry::accept(vsg::ConstVisitor& visitor) const
+{
+    Inherit::accept(visitor);
+
+    // The base geometry only reports the first page of each attribute (the
+    // ones it binds); report the others too so the transfer task tracks them.
+    if (auto* collector = dynamic_cast<vsg::CollectResourceRequirements*>(&visitor))
+    {
+        auto numPages = _currentPages.size();
+        for (std::size_t i = 0; i < _pageBuffers.size(); ++i)
+        {
+            if (i % numPages != 0)
+                collector->apply(_pageBuffers[i]);
+        }
+    }
+}
+
 void
 LineGeometry::compile(vsg::Context& context)
 {
+    if (_capacity > 0)
+    {
+        // The buffers are created once; after that the transfer task
+        // uploads whichever pages are dirty.
+        if (commands.empty())
+            compileDynamic(context);
+        return;
+    }
+
     if (commands.empty())
     {
         if (_current.size() == 0)
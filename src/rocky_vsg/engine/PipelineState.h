@@ -7,6 +7,9 @@
 #include <vsg/utils/ShaderSet.h>
 #include <vsg/utils/GraphicsPipelineConfigurator.h>
 #include <vsg/state/ViewDependentState.h>
+#include <vsg/state/RasterizationState.h>
+#include <vsg/state/DepthStencilState.h>
+#include <vsg/state/ColorBlendState.h>
 
 namespace ROCKY_NAMESPACE
 {
@@ -59,5 +62,36 @@ namespace ROCKY_NAMESPACE
                 VK_PIPELINE_BIND_POINT_GRAPHICS, pipelineConfig->layout,
                 VSG_VIEW_DEPENDENT_DATA_SET);
         }
+
+        //! Render states for screen-space overlays like icons and labels:
+        //! no depth test, no backface culling, alpha blending.
+        static void setOverlayStates(vsg::ref_ptr<vsg::GraphicsPipelineConfigurator> pipelineConfig)
+        {
+            struct SetOverlayStates : public vsg::Visitor
+            {
+                void apply(vsg::Object& object) override {
+                    object.traverse(*this);
+                }
+                void apply(vsg::RasterizationState& state) override {
+                    state.cullMode = VK_CULL_MODE_NONE;
+                }
+                void apply(vsg::DepthStencilState& state) override {
+                    state.depthCompareOp = VK_COMPARE_OP_ALWAYS;
+                    state.depthTestEnable = VK_FALSE;
+                    state.depthWriteEnable = VK_FALSE;
+                }
+                void apply(vsg::ColorBlendState& state) override {
+                    state.attachments = vsg::ColorBlendState::ColorBlendAttachments{
+                        { true,
+                          VK_BLEND_FACTOR_SRC_ALPHA, VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA, VK_BLEND_OP_ADD,
+                          VK_BLEND_FACTOR_SRC_ALPHA, VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA, VK_BLEND_OP_ADD,
+                          VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT | VK_COLOR_COMPONENT_B_BIT | VK_COLOR_COMPONENT_A_BIT }
+                    };
+                }
+            };
+
+            SetOverlayStates visitor;
+            pipelineConfig->accept(visitor);
+        }
     };
 }
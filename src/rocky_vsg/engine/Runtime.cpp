@@ -8,7 +8,17 @@
 #include <vsg/app/Viewer.h>
 #include <vsg/text/Font.h>
 #include <vsg/io/read.h>
+#include <vsg/core/Objects.h>
+#include <vsg/nodes/Geometry.h>
+#include <vsg/nodes/VertexIndexDraw.h>
+#include <vsg/nodes/StateGroup.h>
+#include <vsg/commands/BindVertexBuffers.h>
+#include <vsg/commands/BindIndexBuffer.h>
+#include <vsg/state/BindDescriptorSet.h>
+#include <vsg/state/DescriptorImage.h>
+#include <vsg/state/DescriptorBuffer.h>
 #include <shared_mutex>
+#include <unordered_set>
 
 using namespace ROCKY_NAMESPACE;
 
@@ -110,6 +120,91 @@ namespace
             _function();
         };
     };
+
+    //! Totals up the size of the image and buffer data an object graph
+    //! will transfer to the GPU when compiled. Shared data counts once.
+    struct CountUploadBytes : public vsg::Inherit<vsg::ConstVisitor, CountUploadBytes>
+    {
+        std::size_t bytes = 0;
+        std::unordered_set<const vsg::Data*> _seen;
+
+        void count(const vsg::Data* data)
+        {
+            if (data && _seen.insert(data).second)
+                bytes += data->dataSize();
+        }
+
+        void count(const vsg::BufferInfoList& list)
+        {
+            for (auto& info : list)
+                if (info) count(info->data.get());
+        }
+
+        void apply(const vsg::Object& object) override
+        {
+            object.traverse(*this);
+        }
+
+        void apply(const vsg::StateGroup& sg) override
+        {
+            for (auto& command : sg.stateCommands)
+                command->accept(*this);
+            sg.traverse(*this);
+        }
+
+        void apply(const vsg::BindDescriptorSet& bind) override
+        {
+            if (bind.descriptorSet)
+                bind.descriptorSet->accept(*this);
+        }
+
+        void apply(const vsg::BindDescriptorSets& bind) override
+        {
+            for (auto& ds : bind.descriptorSets)
+                if (ds) ds->accept(*this);
+        }
+
+        void apply(const vsg::DescriptorSet& ds) override
+        {
+            for (auto& descriptor : ds.descriptors)
+                if (descriptor) descriptor->accept(*this);
+        }
+
+        void apply(const vsg::DescriptorImage& di) override
+        {
+            for (auto& info : di.imageInfoList)
+                if (info && info->imageView && info->imageView->image)
+                    count(info->imageView->image->data.get());
+        }
+
+        void apply(const vsg::DescriptorBuffer& db) override
+        {
+            count(db.bufferInfoList);
+        }
+
+        void apply(const vsg::Geometry& geom) override
+        {
+            count(geom.arrays);
+            if (geom.indices) count(geom.indices->data.get());
+            geom.traverse(*this);
+        }
+
+        void apply(const vsg::VertexIndexDraw& vid) override
+        {
+            count(vid.arrays);
+            if (vid.indices) count(vid.indices->data.get());
+        }
+
+        void apply(const vsg::BindVertexBuffers& bvb) override
+        {
+            count(bvb.arrays);
+        }
+
+        void apply(const vsg::BindIndexBuffer& bib) override
+        {
+            if (bib.indices) count(bib.indices->data.get());
+        }
+    };
 }
 
 
@@ -125,6 +220,17 @@ Runtime::Runtime()
     // a large number of frames ensures objects will be safely destroyed and
     // and we won't have too many deletions per frame.
     _deferred_unref_queue.resize(8);
+
+    // one upload batch at a time; each batch already holds everything
+    // that was requested while the previous one was in flight.
+    util::job_scheduler::get(uploadSchedulerName)->setConcurrency(1);
+}
+
+Runtime::~Runtime()
+{
+    // the upload job refers to this object, so wait for it.
+    if (!_uploader.empty())
+        _uploader.join();
 }
 
 void
@@ -169,11 +275,102 @@ Runtime::compile(vsg::ref_ptr<vsg::Object> compilable)
     }
     else
     {
-        std::shared_lock lock(_compileMutex);
-        _toCompile.push(compilable);
+        upload(compilable);
+    }
+}
+
+void
+Runtime::upload(vsg::ref_ptr<vsg::Object> object, std::function<void()> onReady, std::function<void()> onFailed)
+{
+    ROCKY_SOFT_ASSERT_AND_RETURN(object.valid(), void());
+
+    std::scoped_lock lock(_uploadMutex);
+
+    _pendingUploads.emplace_back(Upload{ object, onReady, onFailed });
+
+    if (asyncCompile && !_uploading)
+    {
+        _uploading = true;
+
+        // Drain the pending list one batch at a time until it's empty.
+        // Anything requested while a batch is compiling joins the next one.
+        auto drain = [this](Cancelable&) -> bool
+        {
+            while (true)
+            {
+                std::vector<Upload> uploads;
+                {
+                    std::scoped_lock lock(_uploadMutex);
+                    if (_pendingUploads.empty())
+                    {
+                        _uploading = false;
+                        break;
+                    }
+                    uploads.swap(_pendingUploads);
+                }
+
+                auto batches = runUploads(std::move(uploads));
+
+                std::scoped_lock lock(_uploadMutex);
+                for (auto& batch : batches)
+                    _readyUploads.emplace_back(std::move(batch));
+            }
+            return true;
+        };
+
+        _uploader = util::job::dispatch(drain,
+            util::job{ "rocky::Runtime upload", nullptr, util::job_scheduler::get(uploadSchedulerName) });
     }
 }
 
+std::vector<Runtime::UploadBatch>
+Runtime::runUploads(std::vector<Upload>&& uploads)
+{
+    std::vector<UploadBatch> batches;
+    batches.emplace_back(compileUploads(std::move(uploads)));
+
+    // One bad object fails the whole batch, so retry its objects one at a
+    // time; that way only the bad one fails.
+    if (!batches.front().result && batches.front().uploads.size() > 1)
+    {
+        auto failed = std::move(batches.front());
+        batches.clear();
+
+        for (auto& upload : failed.uploads)
+            batches.emplace_back(compileUploads(std::vector<Upload>{ upload }));
+
+        batches.front().time += failed.time;
+    }
+
+    return batches;
+}
+
+Runtime::UploadBatch
+Runtime::compileUploads(std::vector<Upload>&& uploads)
+{
+    ROCKY_PROFILE_FUNCTION();
+
+    UploadBatch batch;
+    batch.uploads = std::move(uploads);
+
+    // Compile the whole batch as one group so the compile manager records
+    // all the staging copies into a single submission and waits on a
+    // single fence, instead of one round trip per object.
+    auto objects = vsg::Objects::create();
+    for (auto& upload : batch.uploads)
+        objects->children.emplace_back(upload.object);
+
+    CountUploadBytes counter;
+    objects->accept(counter);
+    batch.bytes = counter.bytes;
+
+    auto t0 = std::chrono::steady_clock::now();
+    batch.result = viewer->compileManager->compile(objects);
+    batch.time = std::chrono::steady_clock::now() - t0;
+
+    return batch;
+}
+
 void
 Runtime::dispose(vsg::ref_ptr<vsg::Object> object)
 {
@@ -213,26 +410,71 @@ Runtime::update()
         }
     }
 
-    else if (_toCompile.size() > 0)
+    // collect finished upload batches. In synchronous mode, run everything
+    // that's pending right here as one batch; the compile manager waits on
+    // its own fence, so there's no need to idle the whole device first.
+    std::vector<UploadBatch> batches;
+    std::vector<Upload> uploads;
+    {
+        std::scoped_lock lock(_uploadMutex);
+        batches.swap(_readyUploads);
+
+        if (!asyncCompile)
+            uploads.swap(_pendingUploads);
+
+        _uploadStats.pending = (unsigned)_pendingUploads.size();
+    }
+
+    if (!uploads.empty())
     {
-        // make sure the queues are empty..
-        viewer->deviceWaitIdle();
+        for (auto& batch : runUploads(std::move(uploads)))
+            batches.emplace_back(std::move(batch));
+    }
 
-        std::shared_lock lock(_compileMutex);
+    _uploadStats.objects = 0u;
+    _uploadStats.bytes = 0u;
+    std::chrono::steady_clock::duration time = {};
 
-        while(!_toCompile.empty())
+    for (auto& batch : batches)
+    {
+        if (batch.result)
         {
-            auto object = _toCompile.front();
-            _toCompile.pop();
+            if (batch.result.requiresViewerUpdate())
+            {
+                vsg::updateViewer(*viewer, batch.result);
+            }
 
-            auto cr = viewer->compileManager->compile(object);
-            if (cr && cr.requiresViewerUpdate())
+            // the data is on the GPU; let the owners start drawing it.
+            for (auto& upload : batch.uploads)
             {
-                vsg::updateViewer(*viewer, cr);
+                if (upload.onReady)
+                    upload.onReady();
             }
+
+            _uploadStats.objects += (unsigned)batch.uploads.size();
         }
+        else
+        {
+            Log()->warn("Runtime upload failed: " + batch.result.message);
+
+            for (auto& upload : batch.uploads)
+            {
+                if (upload.onFailed)
+                    upload.onFailed();
+            }
+        }
+
+        _uploadStats.bytes += batch.bytes;
+        time += batch.time;
     }
 
+    _uploadStats.time = std::chrono::duration_cast<std::chrono::microseconds>(time).count();
+
+    _totalUploadBytes += _uploadStats.bytes;
+    _totalUploadTime += time;
+    auto seconds = std::chrono::duration<double>(_totalUploadTime).count();
+    _uploadStats.megabytesPerSecond = seconds > 0.0 ? (double)_totalUploadBytes / 1048576.0 / seconds : 0.0;
+
     // process the deferred unref list
     //if (viewer->getFrameStamp()->frameCount % 5 == 0)
     {
@@ -263,11 +505,7 @@ Runtime::compileAndAddChild(
     // scene graph merge.
 
     util::Future<bool> promise;
-    auto& runtime = *this;
-    
-    auto viewer = runtime.viewer;
-
-    auto async_create_and_add_node = [this, viewer, promise, parent, factory](Cancelable& c) -> bool
+    auto async_create_and_add_node = [this, promise, parent, factory](Cancelable& c) -> bool
     {
         if (c.canceled())
             return false;
@@ -277,13 +515,10 @@ Runtime::compileAndAddChild(
         if (!child)
             return false;
 
-        // compile the child:
-        compile(child);
-
-        // queue an update operation to add the child safely.
+        // upload the child, and add it to the scene graph once it's ready.
         // we pass along the original promise so these two operations appear as
         // one to the caller.
-        auto add_child = [parent, child, viewer](Cancelable& c) -> bool
+        auto add_child = [parent, child](Cancelable& c) -> bool
         {
             if (c.canceled())
                 return false;
@@ -294,7 +529,9 @@ Runtime::compileAndAddChild(
             return true;
         };
         auto promise_op = util::PromiseOperation<bool>::create(promise, add_child);
-        viewer->updateOperations->add(promise_op);
+        upload(child,
+            [promise_op]() { promise_op->run(); },
+            [promise]() mutable { promise.resolve(false); });
 
         return true;
     };
@@ -16,6 +16,9 @@
 #include <vsg/threading/OperationThreads.h>
 #include <vsg/utils/SharedObjects.h>
 #include <vsg/text/Font.h>
+#include <chrono>
+#include <functional>
+#include <mutex>
 #include <shared_mutex>
 
 namespace vsg
@@ -37,6 +40,9 @@ namespace ROCKY_NAMESPACE
         //! Constructor
         Runtime();
 
+        //! Destructor
+        ~Runtime();
+
         //! Viewer instance
         vsg::ref_ptr<vsg::Viewer> viewer;
 
@@ -62,10 +68,14 @@ namespace ROCKY_NAMESPACE
         Revision shaderSettingsRevision = 0;
 
         //! If true, compile() will operate immediately regardless
-        //! of the calling thread. If false, compilation is deferred
-        //! until the next call to update().
+        //! of the calling thread, and upload() batches run on a background
+        //! job. If false, both are deferred and run as a single batch
+        //! during the next call to update().
         bool asyncCompile = true;
 
+        //! Name of the job scheduler that runs upload batches
+        std::string uploadSchedulerName = "rocky.upload";
+
         //! Custom vsg object disposer (optional)
         //! By default Runtime uses its own round-robin object disposer
         std::function<void(vsg::ref_ptr<vsg::Object>)> disposer;
@@ -89,6 +99,40 @@ namespace ROCKY_NAMESPACE
         //! Be careful to only call this from a safe thread
         void compile(vsg::ref_ptr<vsg::Object> object);
 
+        //! Uploads an object to the GPU without stalling the render loop.
+        //! Requests made since the last batch started are collected and
+        //! compiled together (one submission, one fence) in the background.
+        //! Safe to call from any thread.
+        //! @param object Object to compile
+        //! @param onReady Function to call during update() once the object
+        //!   is ready to draw; this is where to add it to the scene graph
+        //! @param onFailed Function to call during update() instead of onReady
+        //!   if the object fails to compile
+        void upload(
+            vsg::ref_ptr<vsg::Object> object,
+            std::function<void()> onReady = {},
+            std::function<void()> onFailed = {});
+
+        //! Upload throughput statistics
+        struct UploadStats
+        {
+            //! Number of objects that became ready during the last update()
+            unsigned objects = 0;
+            //! Bytes of image and buffer data in those objects
+            std::size_t bytes = 0;
+            //! Time spent uploading those objects (microseconds)
+            std::uint64_t time = 0;
+            //! Number of objects still waiting to upload
+            unsigned pending = 0;
+            //! Average upload throughput since startup
+            double megabytesPerSecond = 0.0;
+        };
+
+        //! Upload statistics as of the last call to update()
+        const UploadStats& uploadStats() const {
+            return _uploadStats;
+        }
+
         //! Destroys a VSG object, eventually. 
         //! Call this to get rid of descriptor sets you plan to replace.
         //! You can't just let them go since they recycle internally and 
@@ -130,9 +174,32 @@ namespace ROCKY_NAMESPACE
 
         // containers for compilation and integrating the results
         mutable std::shared_mutex _compileMutex;
-        std::queue<vsg::ref_ptr<vsg::Object>> _toCompile;
         std::vector<vsg::CompileResult> _compileResults;
 
+        // upload pipeline
+        struct Upload {
+            vsg::ref_ptr<vsg::Object> object;
+            std::function<void()> onReady;
+            std::function<void()> onFailed;
+        };
+        struct UploadBatch {
+            std::vector<Upload> uploads;
+            vsg::CompileResult result;
+            std::size_t bytes = 0;
+            std::chrono::steady_clock::duration time = {};
+        };
+        std::mutex _uploadMutex;
+        std::vector<Upload> _pendingUploads;
+        std::vector<UploadBatch> _readyUploads;
+        bool _uploading = false;
+        util::Future<bool> _uploader;
+        UploadStats _uploadStats;
+        std::size_t _totalUploadBytes = 0;
+        std::chrono::steady_clock::duration _totalUploadTime = {};
+
+        std::vector<UploadBatch> runUploads(std::vector<Upload>&& uploads);
+        UploadBatch compileUploads(std::vector<Upload>&& uploads);
+
         // deferred deletion container
         mutable std::shared_mutex _deferred_unref_mutex;
         std::list<std::vector<vsg::ref_ptr<vsg::Object>>> _deferred_unref_queue;
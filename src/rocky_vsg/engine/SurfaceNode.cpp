@@ -28,8 +28,15 @@ using namespace ROCKY_NAMESPACE;
 SurfaceNode::SurfaceNode(const TileKey& tilekey, const SRS& worldSRS, Runtime& runtime) :
     _tileKey(tilekey),
     _runtime(runtime),
-    _boundsDirty(true)
+    _boundsDirty(true),
+    _ellipsoidRadii(0.0, 0.0)
 {
+    if (worldSRS.isGeocentric())
+    {
+        _ellipsoidRadii.x = worldSRS.ellipsoid().semiMajorAxis();
+        _ellipsoidRadii.y = worldSRS.ellipsoid().semiMinorAxis();
+    }
+
     // Establish a local reference frame for the tile:
     GeoPoint centroid = tilekey.extent().centroid();
     centroid.transformInPlace(worldSRS);
@@ -166,12 +173,21 @@ SurfaceNode::recomputeBound()
         m * ((corner(0) + corner(3)) * 0.5)
     };
 
-    // Adjust the horizon ellipsoid based on the minimum Z value of the tile;
-    // necessary because a tile that's below the ellipsoid (ocean floor, e.g.)
-    // may be visible even if it doesn't pass the horizon-cone test. In such
-    // cases we need a more conservative ellipsoid.
-    //double zMin = std::min(_localbbox.min.z, 0.0);
-    //_horizon.setEllipsoid(Ellipsoid(_horizonCullDistance + zMin, _horizonCullDistance + zMin));
+    // Compute the horizon culling point from the box corners. A tile that dips
+    // below the ellipsoid (ocean floor, e.g.) may be visible even when the
+    // ellipsoid would hide it, so it gets no culling point.
+    _hasHorizonCullingPoint = false;
+    if (_ellipsoidRadii.x > 0.0)
+    {
+        glm::dvec3 corners[8];
+        for (unsigned i = 0; i < 8; ++i)
+            corners[i] = to_glm(_worldPoints[i]);
+
+        _hasHorizonCullingPoint = Horizon::computeCullingPoint(
+            Ellipsoid(_ellipsoidRadii.x, _ellipsoidRadii.y),
+            corners, 8,
+            _horizonCullingPoint);
+    }
 
 #ifdef RENDER_TILE_BBOX
     if (children.size() == 2)
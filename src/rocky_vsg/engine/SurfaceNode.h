@@ -10,6 +10,7 @@
 #include <rocky/SRS.h>
 #include <rocky/TileKey.h>
 #include <rocky/Horizon.h>
+#include <rocky_vsg/engine/CullContext.h>
 #include <rocky_vsg/engine/Utils.h>
 #include <vsg/nodes/MatrixTransform.h>
 #include <vsg/vk/State.h>
@@ -27,6 +28,14 @@ namespace ROCKY_NAMESPACE
     class SurfaceNode : public vsg::Inherit<vsg::MatrixTransform, SurfaceNode>
     {
     public:
+        //! Outcome of a visibility check
+        enum Visibility : std::uint8_t
+        {
+            VISIBLE,
+            OUTSIDE_FRUSTUM,
+            BEYOND_HORIZON
+        };
+
         SurfaceNode(
             const TileKey& tilekey,
             const SRS& worldSRS,
@@ -49,7 +58,12 @@ namespace ROCKY_NAMESPACE
         
         //! World-space visibility check (includes bounding box
         //! and horizon checks)
-        inline bool isVisible(vsg::State* state) const;
+        inline bool isVisible(vsg::State* state) const {
+            return visibility(state) == VISIBLE;
+        }
+
+        //! World-space visibility check that reports why a tile is not visible
+        inline Visibility visibility(vsg::State* state) const;
      
 #if 0
         // A box can have 4 children. 
@@ -89,12 +103,15 @@ namespace ROCKY_NAMESPACE
         std::vector<vsg::dvec3> _worldPoints;
         vsg::dbox _localbbox;
         bool _boundsDirty;
+        glm::dvec2 _ellipsoidRadii;
+        glm::dvec3 _horizonCullingPoint;
+        bool _hasHorizonCullingPoint = false;
         Runtime& _runtime;
         std::vector<vsg::vec3> _proxyMesh;
     };
 
 
-    bool SurfaceNode::isVisible(vsg::State* state) const
+    SurfaceNode::Visibility SurfaceNode::visibility(vsg::State* state) const
     {
         // bounding box visibility check; this is much tighter than the bounding
         // sphere. _frustumStack.top() contains the frustum in world coordinates.
@@ -109,25 +126,27 @@ namespace ROCKY_NAMESPACE
                 if (vsg::distance(frustum.face[f], _worldPoints[p]) > 0.0) // visible?
                     break;
             if (p == 8)
-                return false;
+                return OUTSIDE_FRUSTUM;
         }
 
         // still good? check against the horizon.
-        shared_ptr<Horizon> horizon;
-        if (state->getValue("horizon", horizon))
+        auto& horizon = CullContext::get(state).horizon;
+        if (horizon)
         {
-            for (p = 0; p < 4; ++p)
-            {
-                auto& wp = _worldPoints[p];
-                if (horizon->isVisible(wp.x, wp.y, wp.z))
-                    return true;
-            }
-
-            return false;
-        }
-        else
-        {
-            return true;
+            // The culling point stands in for the whole bounding box, so one test
+            // suffices. Tiles without one (very large, or dipping below the
+            // ellipsoid) fall back on their bounding sphere.
+            bool visible = _hasHorizonCullingPoint ?
+                horizon->isCullingPointVisible(_horizonCullingPoint) :
+                horizon->isVisible(
+                    worldBoundingSphere.center.x,
+                    worldBoundingSphere.center.y,
+                    worldBoundingSphere.center.z,
+                    worldBoundingSphere.radius);
+
+            return visible ? VISIBLE : BEYOND_HORIZON;
         }
+
+        return VISIBLE;
     }
 }
@@ -30,4 +30,5 @@ TerrainEngine::TerrainEngine(
     stateFactory(new_runtime)
 {
     util::job_scheduler::get(loadSchedulerName)->setConcurrency(4);
+    util::job_scheduler::get(fetchSchedulerName)->setConcurrency(8);
 }
@@ -126,6 +126,7 @@ TerrainNode::update(const vsg::FrameStamp* fs, const IOOptions& io)
         {
             engine->tiles.update(fs, io, engine);
             engine->geometryPool.sweep(engine->runtime);
+            engine->stateFactory.sweep(engine->runtime);
         }
     }
 }
@@ -135,3 +136,9 @@ TerrainNode::ping(TerrainTileNode* tile, const TerrainTileNode* parent, vsg::Rec
 {
     engine->tiles.ping(tile, parent, nv);
 }
+
+void
+TerrainNode::recorded(const TerrainTileNode* tile, TileRecordResult result)
+{
+    engine->tiles.recorded(tile, result);
+}
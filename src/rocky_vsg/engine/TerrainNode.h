@@ -58,6 +58,11 @@ namespace ROCKY_NAMESPACE
             const TerrainTileNode* parent,
             vsg::RecordTraversal&) override;
 
+        //! TerrainTileHost interface
+        void recorded(
+            const TerrainTileNode* tile,
+            TileRecordResult result) override;
+
         //! Terrain settings
         const TerrainSettings& settings() override {
             return *this;
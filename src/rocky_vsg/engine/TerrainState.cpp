@@ -80,6 +80,21 @@ TerrainState::createDefaultDescriptors()
     if (_runtime.sharedObjects)
         _runtime.sharedObjects->share(texturedefs.color.sampler);
 
+    // block-compressed color (see TerrainSettings::compressTextures) carries its
+    // own mipmaps, so it gets the same sampler with mipmapping enabled.
+    texturedefs.compressedColor = { COLOR_TEX_NAME, COLOR_TEX_BINDING, vsg::Sampler::create(), {} };
+    texturedefs.compressedColor.sampler->maxLod = 16;
+    texturedefs.compressedColor.sampler->minFilter = VK_FILTER_LINEAR;
+    texturedefs.compressedColor.sampler->magFilter = VK_FILTER_LINEAR;
+    texturedefs.compressedColor.sampler->mipmapMode = VK_SAMPLER_MIPMAP_MODE_LINEAR;
+    texturedefs.compressedColor.sampler->addressModeU = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+    texturedefs.compressedColor.sampler->addressModeV = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+    texturedefs.compressedColor.sampler->addressModeW = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+    texturedefs.compressedColor.sampler->anisotropyEnable = VK_TRUE;
+    texturedefs.compressedColor.sampler->maxAnisotropy = 4.0f;
+    if (_runtime.sharedObjects)
+        _runtime.sharedObjects->share(texturedefs.compressedColor.sampler);
+
     texturedefs.elevation = { ELEVATION_TEX_NAME, ELEVATION_TEX_BINDING, vsg::Sampler::create(), {} };
     texturedefs.elevation.sampler->maxLod = 16;
     texturedefs.elevation.sampler->minFilter = VK_FILTER_LINEAR;
@@ -275,71 +290,40 @@ TerrainState::updateTerrainTileDescriptors(
     // copy the existing one:
     TerrainTileDescriptors dm = renderModel.descriptors;
 
-    if (renderModel.color.image)
-    {
-        auto data = util::moveImageToVSG(renderModel.color.image->clone());
-        if (data)
-        {
-            // queue the old data for safe disposal
-            runtime.dispose(dm.color);
-
-            // tell vsg to remove the image from CPU memory after sending it to the GPU
-            data->properties.dataVariance = vsg::STATIC_DATA_UNREF_AFTER_TRANSFER;
-
-            dm.color = vsg::DescriptorImage::create(
-                texturedefs.color.sampler,
-                data,
-                texturedefs.color.uniform_binding,
-                0, // array element (TODO: increment if we change to an array)
-                VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER);
-
-            dm.color->setValue("name", renderModel.color.name);
-        }
-    }
-
-    if (renderModel.elevation.image)
+    // Textures that are new to the GPU; once they're compiled, other
+    // tiles using the same rasters can share them.
+    struct Fresh {
+        TextureType type;
+        shared_ptr<Image> image;
+        vsg::ref_ptr<vsg::DescriptorImage> descriptor;
+    };
+    std::vector<Fresh> fresh;
+
+    auto assign = [&](TextureType type, const TextureDef& def, const TextureData& texture,
+        vsg::ref_ptr<vsg::DescriptorImage>& descriptor)
     {
-        auto data = util::moveImageToVSG(renderModel.elevation.image->clone());
-        if (data)
+        if (texture.image)
         {
-            // queue the old data for safe disposal
-            runtime.dispose(dm.elevation);
-
-            // tell vsg to remove the image from CPU memory after sending it to the GPU
-            data->properties.dataVariance = vsg::STATIC_DATA_UNREF_AFTER_TRANSFER;
-
-            dm.elevation = vsg::DescriptorImage::create(
-                texturedefs.elevation.sampler,
-                data,
-                texturedefs.elevation.uniform_binding,
-                0, // array element
-                VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER);
+            auto shared = findSharedTexture(type, texture.image);
+            if (!shared)
+            {
+                shared = createTexture(type, def, texture);
+                if (shared)
+                    fresh.emplace_back(Fresh{ type, texture.image, shared });
+            }
 
-            dm.elevation->setValue("name", renderModel.elevation.name);
+            if (shared)
+            {
+                // queue the old data for safe disposal
+                runtime.dispose(descriptor);
+                descriptor = shared;
+            }
         }
-    }
-
-    if (renderModel.normal.image)
-    {
-        auto data = util::moveImageToVSG(renderModel.normal.image->clone());
-        if (data)
-        {
-            // queue the old data for safe disposal
-            runtime.dispose(dm.normal);
-
-            // tell vsg to remove the image from CPU memory after sending it to the GPU
-            data->properties.dataVariance = vsg::STATIC_DATA_UNREF_AFTER_TRANSFER;
+    };
 
-            dm.normal = vsg::DescriptorImage::create(
-                texturedefs.normal.sampler,
-                data,
-                texturedefs.normal.uniform_binding,
-                0, // array element
-                VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER);
-
-            dm.normal->setValue("name", renderModel.normal.name);
-        }
-    }
+    assign(COLOR, texturedefs.color, renderModel.color, dm.color);
+    assign(ELEVATION, texturedefs.elevation, renderModel.elevation, dm.elevation);
+    assign(NORMAL, texturedefs.normal, renderModel.normal, dm.normal);
 
     // the per-tile uniform block:
     TerrainTileDescriptors::Uniforms uniforms;
@@ -370,36 +354,232 @@ TerrainState::updateTerrainTileDescriptors(
 
     //ROCKY_HARD_ASSERT(bind->vdata().value._vkDescriptorSet == 0);
 
-    // Destroy the old descriptor set(s) safely; don't just replace them
-    // or it could cause a validataion error during compilation due to 
-    // vsg descriptorset internal recycling.
-    for (auto& command : stategroup->stateCommands)
-        runtime.dispose(command);
-    
-    stategroup->stateCommands.clear();
-
-    // Need to compile the descriptors
-    runtime.compile(bind);
-
     // Temporary:
-    // Delete the CPU memory assocaited with the rasters
-    // now that they are compiled to the GPU.
-    for (auto& dd : bind->descriptorSet->descriptors)
+    // Release the CPU references to the rasters now that they are
+    // compiled to the GPU, and offer the new textures to other tiles.
+    // The pixels themselves go away once the render model lets go of
+    // its images too.
+    auto compiled = [cache = weak_ptr<SharedTextures>(_sharedTextures), bind, fresh]()
     {
-        auto di = dd->cast<vsg::DescriptorImage>();
-        if (di)
+        for (auto& dd : bind->descriptorSet->descriptors)
         {
-            for (auto& ii : di->imageInfoList)
+            auto di = dd->cast<vsg::DescriptorImage>();
+            if (di)
             {
-                if (ii->imageView->image->data->properties.dataVariance == vsg::STATIC_DATA_UNREF_AFTER_TRANSFER)
+                for (auto& ii : di->imageInfoList)
                 {
-                    ii->imageView->image->data = nullptr;
+                    auto& data = ii->imageView->image->data;
+                    if (data && data->properties.dataVariance == vsg::STATIC_DATA_UNREF_AFTER_TRANSFER)
+                    {
+                        data = nullptr;
+                    }
                 }
             }
         }
+
+        // the terrain may have been torn down while the upload was pending
+        auto textures = cache.lock();
+        if (!textures)
+            return;
+
+        std::scoped_lock lock(textures->mutex);
+        for (auto& f : fresh)
+        {
+            textures->textures[f.type][f.image.get()] = SharedTexture{ f.image, f.descriptor };
+        }
+    };
+
+    if (stategroup->stateCommands.empty())
+    {
+        // A new tile has nothing to draw with yet, so compile its
+        // first descriptors right away. (In synchronous mode the upload
+        // happens during the next update, before this tile can draw.)
+        stategroup->add(bind);
+
+        if (runtime.asyncCompile)
+        {
+            runtime.compile(bind);
+            compiled();
+        }
+        else
+        {
+            runtime.upload(bind, compiled);
+        }
+    }
+    else
+    {
+        // Replacing existing descriptors: hand the new ones to the upload
+        // pipeline and keep drawing with the old ones until the copy is done.
+        // Observe the state group, since the tile that owns it may page out
+        // before the upload finishes.
+        auto swap = [&runtime, weak_stategroup = vsg::observer_ptr<vsg::StateGroup>(stategroup), bind, compiled]()
+        {
+            vsg::ref_ptr<vsg::StateGroup> stategroup = weak_stategroup;
+            if (!stategroup)
+            {
+                runtime.dispose(bind);
+                return;
+            }
+
+            // Destroy the old descriptor set(s) safely; don't just replace them
+            // or it could cause a validataion error during compilation due to 
+            // vsg descriptorset internal recycling.
+            for (auto& command : stategroup->stateCommands)
+                runtime.dispose(command);
+
+            stategroup->stateCommands.clear();
+
+            compiled();
+
+            // And update the tile's state group
+            stategroup->add(bind);
+        };
+
+        // if the new descriptors fail to compile, keep drawing with the old ones
+        auto failed = [&runtime, bind]()
+        {
+            runtime.dispose(bind);
+        };
+
+        runtime.upload(bind, swap, failed);
+    }
+}
+
+vsg::ref_ptr<vsg::DescriptorImage>
+TerrainState::findSharedTexture(TextureType type, shared_ptr<Image> image) const
+{
+    std::scoped_lock lock(_sharedTextures->mutex);
+
+    auto& textures = _sharedTextures->textures[type];
+    auto iter = textures.find(image.get());
+
+    // the weak pointer guards against a new image at a recycled address
+    if (iter != textures.end() && iter->second.image.lock() == image)
+        return iter->second.descriptor;
+
+    return {};
+}
+
+vsg::ref_ptr<vsg::DescriptorImage>
+TerrainState::createTexture(TextureType type, const TextureDef& def, const TextureData& texture) const
+{
+    // use the block-compressed version of the raster if a loading thread made one
+    shared_ptr<CompressedImage> compressed;
+    if (type == COLOR)
+    {
+        std::scoped_lock lock(_sharedTextures->mutex);
+        auto iter = _compressed.find(texture.image.get());
+        if (iter != _compressed.end())
+        {
+            if (iter->second.image.lock() == texture.image)
+                compressed = iter->second.compressed;
+            _compressed.erase(iter);
+        }
+    }
+
+    // Either way the texture shares storage with the source instead of
+    // cloning it. New data replaces the image pointer and never writes
+    // into the shared pixels.
+    auto data = compressed ?
+        util::shareCompressedImageWithVSG(compressed) :
+        util::shareImageWithVSG(texture.image);
+
+    if (!data)
+        return {};
+
+    // tell vsg to let go of the pixels after sending them to the GPU
+    data->properties.dataVariance = vsg::STATIC_DATA_UNREF_AFTER_TRANSFER;
+
+    auto descriptor = vsg::DescriptorImage::create(
+        compressed ? texturedefs.compressedColor.sampler : def.sampler,
+        data,
+        def.uniform_binding,
+        0, // array element
+        VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER);
+
+    descriptor->setValue("name", texture.name);
+
+    std::scoped_lock lock(_sharedTextures->mutex);
+    _textureStats.textures++;
+    if (compressed)
+    {
+        _textureStats.compressed++;
+        _textureStats.bytes += compressed->data().size();
+        _textureStats.uncompressedBytes += compressed->uncompressedSize();
+    }
+    else
+    {
+        _textureStats.bytes += data->dataSize();
+        _textureStats.uncompressedBytes += data->dataSize();
+    }
+
+    return descriptor;
+}
+
+void
+TerrainState::compress(shared_ptr<Image> image, float quality) const
+{
+    if (!image)
+        return;
+
+    // already on the GPU, or already encoded?
+    if (findSharedTexture(COLOR, image))
+        return;
+    {
+        std::scoped_lock lock(_sharedTextures->mutex);
+        auto iter = _compressed.find(image.get());
+        if (iter != _compressed.end() && iter->second.image.lock() == image)
+            return;
+    }
+
+    auto compressed = CompressedImage::compress(*image, quality, true);
+    if (compressed)
+    {
+        std::scoped_lock lock(_sharedTextures->mutex);
+        _compressed[image.get()] = Compressed{ image, compressed };
+    }
+}
+
+TerrainState::TextureStats
+TerrainState::textureStats() const
+{
+    std::scoped_lock lock(_sharedTextures->mutex);
+    return _textureStats;
+}
+
+void
+TerrainState::sweep(Runtime& runtime)
+{
+    std::scoped_lock lock(_sharedTextures->mutex);
+
+    for (auto& textures : _sharedTextures->textures)
+    {
+        for (auto iter = textures.begin(); iter != textures.end(); )
+        {
+            if (iter->second.image.expired())
+            {
+                runtime.dispose(iter->second.descriptor);
+                iter = textures.erase(iter);
+            }
+            else ++iter;
+        }
     }
 
-    // And update the tile's state group
-    //stategroup->stateCommands.clear();
-    stategroup->add(bind);
+    for (auto iter = _compressed.begin(); iter != _compressed.end(); )
+    {
+        if (iter->second.image.expired())
+            iter = _compressed.erase(iter);
+        else ++iter;
+    }
+}
+
+std::size_t
+TerrainState::sharedTextureCount() const
+{
+    std::scoped_lock lock(_sharedTextures->mutex);
+
+    std::size_t count = 0;
+    for (auto& textures : _sharedTextures->textures)
+        count += textures.size();
+    return count;
 }
@@ -7,12 +7,15 @@
 
 #include <rocky_vsg/Common.h>
 #include <rocky_vsg/engine/TerrainTileNode.h>
+#include <rocky/CompressedImage.h>
 
 #include <vsg/io/Options.h>
 #include <vsg/utils/GraphicsPipelineConfigurator.h>
 #include <vsg/utils/ShaderSet.h>
 #include <vsg/utils/SharedObjects.h>
 #include <vsg/nodes/StateGroup.h>
+#include <mutex>
+#include <unordered_map>
 
 namespace ROCKY_NAMESPACE
 {
@@ -45,6 +48,36 @@ namespace ROCKY_NAMESPACE
             vsg::ref_ptr<vsg::StateGroup> stategroup,
             Runtime& runtime) const;
 
+        //! Releases shared tile textures whose source images no longer exist.
+        //! Call once per frame.
+        void sweep(Runtime& runtime);
+
+        //! Number of tile textures currently shared on the GPU
+        std::size_t sharedTextureCount() const;
+
+        //! Encodes a color raster to a GPU block format ahead of time, so the
+        //! texture created for it later on uploads the compressed data.
+        //! Call this from a loading thread; it's too slow for the render loop.
+        //! @param image Color raster
+        //! @param quality Encoder effort, 0 (fastest) to 1 (best)
+        void compress(shared_ptr<Image> image, float quality) const;
+
+        //! Running totals of the tile textures created so far
+        struct TextureStats
+        {
+            //! Textures created
+            std::size_t textures = 0;
+            //! How many of those were block-compressed
+            std::size_t compressed = 0;
+            //! Bytes of texture data created (what gets uploaded)
+            std::size_t bytes = 0;
+            //! Bytes the same textures would take uncompressed
+            std::size_t uncompressedBytes = 0;
+        };
+
+        //! Tile texture totals
+        TextureStats textureStats() const;
+
         //! Status of the factory.
         Status status;
 
@@ -99,6 +132,7 @@ namespace ROCKY_NAMESPACE
         struct
         {
             TextureDef color;
+            TextureDef compressedColor;
             TextureDef colorParent;
             TextureDef elevation;
             TextureDef normal;
@@ -106,5 +140,45 @@ namespace ROCKY_NAMESPACE
         texturedefs;
 
         Runtime& _runtime;
+
+    private:
+
+        //! A texture already on the GPU. Every tile that renders the same
+        //! source raster (like subtiles that inherit their parent's images)
+        //! binds this one descriptor instead of uploading its own copy.
+        struct SharedTexture
+        {
+            weak_ptr<Image> image;
+            vsg::ref_ptr<vsg::DescriptorImage> descriptor;
+        };
+
+        //! Held by pointer so upload callbacks that outlive this object
+        //! (see updateTerrainTileDescriptors) can tell it's gone.
+        struct SharedTextures
+        {
+            std::mutex mutex;
+            std::unordered_map<const Image*, SharedTexture> textures[NUM_TEXTURE_TYPES];
+        };
+        shared_ptr<SharedTextures> _sharedTextures = std::make_shared<SharedTextures>();
+
+        //! Color rasters already encoded for the GPU, waiting for a texture
+        struct Compressed
+        {
+            weak_ptr<Image> image;
+            shared_ptr<CompressedImage> compressed;
+        };
+        mutable std::unordered_map<const Image*, Compressed> _compressed;
+        mutable TextureStats _textureStats;
+
+        //! Find a compiled texture for this raster, if there is one
+        vsg::ref_ptr<vsg::DescriptorImage> findSharedTexture(
+            TextureType type,
+            shared_ptr<Image> image) const;
+
+        //! Create a new texture descriptor for a raster
+        vsg::ref_ptr<vsg::DescriptorImage> createTexture(
+            TextureType type,
+            const TextureDef& def,
+            const TextureData& texture) const;
     };
 }
@@ -13,6 +13,15 @@ namespace ROCKY_NAMESPACE
     class TerrainTileNode;
     class TerrainSettings;
 
+    //! What the record traversal did with a terrain tile
+    enum class TileRecordResult
+    {
+        DRAWN,           // recorded its own geometry
+        SUBDIVIDED,      // recorded its subtiles instead
+        FRUSTUM_CULLED,  // outside the view frustum
+        HORIZON_CULLED   // hidden behind the horizon
+    };
+
     /** 
      * Interface for terrain tiles to notify their host of their active state.
      */
@@ -25,6 +34,11 @@ namespace ROCKY_NAMESPACE
             const TerrainTileNode* parent,
             vsg::RecordTraversal& t) = 0;
 
+        //! Tell the host what happened to a tile during record.
+        virtual void recorded(
+            const TerrainTileNode* tile,
+            TileRecordResult result) = 0;
+
         //! Access terrain settings.
         virtual const TerrainSettings& settings() = 0;
     };
@@ -158,7 +158,9 @@ TerrainTileNode::accept(vsg::RecordTraversal& rv) const
     if (subtilesExist())
         _needsSubtiles = false;
 
-    if (surface->isVisible(rv.getState()))
+    auto visibility = surface->visibility(rv.getState());
+
+    if (visibility == SurfaceNode::VISIBLE)
     {
         // determine whether we can and should subdivide to a higher resolution:
         bool subtilesInRange = shouldSubDivide(rv.getState());
@@ -168,6 +170,8 @@ TerrainTileNode::accept(vsg::RecordTraversal& rv) const
             // children are available, traverse them now.
             children[1]->accept(rv);
 
+            _host->recorded(this, TileRecordResult::SUBDIVIDED);
+
 #ifdef AGGRESSIVE_PAGEOUT
             // always ping all children at once so the system can never
             // delete one of a quad.
@@ -182,12 +186,20 @@ TerrainTileNode::accept(vsg::RecordTraversal& rv) const
             // children do not exist or are out of range; use this tile's geometry
             children[0]->accept(rv);
 
+            _host->recorded(this, TileRecordResult::DRAWN);
+
             if (subtilesInRange && subtilesLoader.empty())
             {
                 _needsSubtiles = true;
             }
         }
     }
+    else
+    {
+        _host->recorded(this, visibility == SurfaceNode::BEYOND_HORIZON ?
+            TileRecordResult::HORIZON_CULLED :
+            TileRecordResult::FRUSTUM_CULLED);
+    }
 
 #ifndef AGGRESSIVE_PAGEOUT
     if (subtilesExist())
@@ -18,6 +18,9 @@
 #include <vsg/nodes/QuadGroup.h>
 #include <vsg/ui/FrameStamp.h>
 
+#include <algorithm>
+#include <iterator>
+
 using namespace ROCKY_NAMESPACE;
 
 #define LC "[TerrainTilePager] "
@@ -48,10 +51,16 @@ TerrainTilePager::~TerrainTilePager()
 void
 TerrainTilePager::releaseAll()
 {
+    for (auto& shard : _pingShards)
+    {
+        std::scoped_lock lock(shard.mutex);
+        shard.pings.clear();
+    }
+
     std::scoped_lock lock(_mutex);
 
     _tiles.clear();
-    _tracker.reset();
+    _lru.clear();
     _loadSubtiles.clear();
     _loadElevation.clear();
     _mergeElevation.clear();
@@ -60,45 +69,36 @@ TerrainTilePager::releaseAll()
     _updateData.clear();
 }
 
-void
-TerrainTilePager::ping(TerrainTileNode* tile, const TerrainTileNode* parent, vsg::RecordTraversal& rv)
+TerrainTilePager::Stats
+TerrainTilePager::stats() const
 {
-    if (_settings.supportMultiThreadedRecord)
-        _mutex.lock();
-
-    // first, update the tracker to keep this tile alive.
-    TileTable::iterator i = _tiles.find(tile->key);
+    std::scoped_lock lock(_mutex);
+    return _stats;
+}
 
-    if (i == _tiles.end())
-    {
-        // new entry:
-        auto& entry = _tiles[tile->key];
-        entry._tile = tile;
-        entry._trackerToken = _tracker.use(tile, nullptr);
-    }
-    else
+namespace
+{
+    // Each recording thread sticks to one ping shard.
+    unsigned ping_shard_index(unsigned numShards)
     {
-        _tracker.use(tile, i->second._trackerToken);
+        static std::atomic_uint next = { 0 };
+        static thread_local unsigned index = next++;
+        return index % numShards;
     }
+}
+
+void
+TerrainTilePager::ping(TerrainTileNode* tile, const TerrainTileNode* parent, vsg::RecordTraversal& rv)
+{
+    // See if the tile needs anything. We only read the tile's state here;
+    // registration and all the bookkeeping happen in update().
+    std::uint8_t requests = 0;
 
-    // next, see if the tile needs anything.
-    // 
     // "progressive" means do not load LOD N+1 until LOD N is complete.
     const bool progressive = true;
 
     if (progressive)
     {
-
-#if 0
-        auto tileHasData = tile->dataMerger.available();
-
-        if (tileHasData && tile->_needsChildren)
-            _loadChildren.push_back(tile->key);
-
-        if (parentHasData && tile->dataLoader.empty())
-            _loadData.push_back(tile->key);
-#else
-
         auto tileHasData = tile->dataMerger.available();
 
 #ifdef LOAD_ELEVATION_SEPARATELY
@@ -108,46 +108,70 @@ TerrainTilePager::ping(TerrainTileNode* tile, const TerrainTileNode* parent, vsg
 #endif
         
         if (tileHasData && tileHasElevation && tile->_needsSubtiles)
-            _loadSubtiles.push_back(tile->key);
+            requests |= LOAD_SUBTILES;
 
 #ifdef LOAD_ELEVATION_SEPARATELY
         bool parentHasElevation = (parent == nullptr || parent->elevationMerger.available());
         if (parentHasElevation && tile->elevationLoader.empty())
-            _loadElevation.push_back(tile->key);
+            requests |= LOAD_ELEVATION;
 #endif
 
         bool parentHasData = (parent == nullptr || parent->dataMerger.available());
         if (parentHasData && tile->dataLoader.empty())
-            _loadData.push_back(tile->key);
-#endif
-
-    }
-    else
-    {
-        //// free for all
-        //if (tile->_needsChildren)
-        //    _needsChildren.push_back(tile->key);
-
-        //if (tile->dataLoader.empty())
-        //    _needsLoad.push_back(tile->key);
+            requests |= LOAD_DATA;
     }
 
 #ifdef LOAD_ELEVATION_SEPARATELY
     if (tile->elevationLoader.available() && tile->elevationMerger.empty())
-        _mergeElevation.push_back(tile->key);
+        requests |= MERGE_ELEVATION;
 #endif
 
-    // This will only queue one merge per frame, to prevent overloading
-    // the (synchronous) update cycle in VSG.
+    // Merges run synchronously in update(), as many as fit in the
+    // frame's time budget.
     if (tile->dataLoader.available() && tile->dataMerger.empty())
-        _mergeData.push_back(tile->key);
+        requests |= MERGE_DATA;
 
     if (tile->_needsUpdate)
-        _updateData.push_back(tile->key);
-
+        requests |= UPDATE_DATA;
 
     if (_settings.supportMultiThreadedRecord)
-        _mutex.unlock();
+    {
+        auto& shard = _pingShards[ping_shard_index(NUM_PING_SHARDS)];
+
+        // only time the lock when we actually have to wait for it
+        if (!shard.mutex.try_lock())
+        {
+            auto start = std::chrono::steady_clock::now();
+            shard.mutex.lock();
+            _pingLockWaitNanos += std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now() - start).count();
+        }
+        shard.pings.emplace_back(Ping{ vsg::ref_ptr<TerrainTileNode>(tile), requests });
+        shard.mutex.unlock();
+    }
+    else
+    {
+        _pingShards[0].pings.emplace_back(Ping{ vsg::ref_ptr<TerrainTileNode>(tile), requests });
+    }
+}
+
+void
+TerrainTilePager::recorded(const TerrainTileNode* tile, TileRecordResult result)
+{
+    switch (result)
+    {
+    case TileRecordResult::DRAWN:
+        _drawnCount.fetch_add(1, std::memory_order_relaxed);
+        break;
+    case TileRecordResult::FRUSTUM_CULLED:
+        _frustumCulledCount.fetch_add(1, std::memory_order_relaxed);
+        break;
+    case TileRecordResult::HORIZON_CULLED:
+        _horizonCulledCount.fetch_add(1, std::memory_order_relaxed);
+        break;
+    default:
+        break;
+    }
 }
 
 void
@@ -156,11 +180,68 @@ TerrainTilePager::update(
     const IOOptions& io,
     shared_ptr<TerrainEngine> terrain)
 {
+    // collect the pings posted since the last update
+    std::vector<Ping> pings;
+    for (auto& shard : _pingShards)
+    {
+        std::scoped_lock lock(shard.mutex);
+        if (pings.empty())
+        {
+            pings.swap(shard.pings);
+        }
+        else
+        {
+            std::move(shard.pings.begin(), shard.pings.end(), std::back_inserter(pings));
+            shard.pings.clear();
+        }
+    }
+
     std::scoped_lock lock(_mutex);
 
+    // register the pinged tiles and move them to the front of the
+    // expiration list; unpinged tiles collect at the back.
+    ++_generation;
+
+    for (auto& ping : pings)
+    {
+        auto& key = ping.tile->key;
+        auto iter = _tiles.find(key);
+        if (iter == _tiles.end())
+        {
+            // new entry:
+            auto& entry = _tiles[key];
+            entry._tile = ping.tile;
+            entry._lru = _lru.insert(_lru.begin(), key);
+            entry._lastPing = _generation;
+        }
+        else
+        {
+            auto& entry = iter->second;
+            entry._tile = ping.tile;
+            if (entry._lastPing != _generation)
+            {
+                _lru.splice(_lru.begin(), _lru, entry._lru);
+                entry._lastPing = _generation;
+            }
+        }
+
+        if (ping.requests & LOAD_SUBTILES)
+            _loadSubtiles.push_back(key);
+        if (ping.requests & LOAD_ELEVATION)
+            _loadElevation.push_back(key);
+        if (ping.requests & MERGE_ELEVATION)
+            _mergeElevation.push_back(key);
+        if (ping.requests & LOAD_DATA)
+            _loadData.push_back(key);
+        if (ping.requests & MERGE_DATA)
+            _mergeData.push_back(key);
+        if (ping.requests & UPDATE_DATA)
+            _updateData.push_back(key);
+    }
+
     //Log::info()
     //    << "Frame " << fs->frameCount << ": "
-    //    << "tiles=" << _tracker._list.size()-1 << " "
+    //    << "tiles=" << _tiles.size() << " "
     //    << "needsSubtiles=" << _loadSubtiles.size() << " "
     //    << "needsLoad=" << _loadData.size() << " "
     //    << "needsMerge=" << _mergeData.size() << std::endl;
@@ -176,20 +257,39 @@ TerrainTilePager::update(
     }
     _updateData.clear();
 
+    // Everything from here on runs against a per-frame time budget, most
+    // important tiles first. Requests that don't fit are dropped; their tiles
+    // are unchanged, so they will ping the same requests again next frame.
+    // At least one of each runs per frame so nothing starves.
+    auto start = std::chrono::steady_clock::now();
+    auto deadline = start + std::chrono::microseconds((std::int64_t)(_settings.updateBudget.value() * 1000.0f));
+    auto out_of_time = [&]() { return std::chrono::steady_clock::now() >= deadline; };
+
+    // merge newly loaded data into tiles
+    auto merges = prioritize(_mergeData);
+    unsigned done = 0, merged = 0;
+    for (; done < merges.size(); ++done)
+    {
+        if (done > 0 && out_of_time())
+            break;
+
+        if (mergeData(merges[done], terrain))
+            ++merged;
+    }
+    _stats.merged = merged;
+    _stats.mergesDeferred = (unsigned)(merges.size() - done);
+
     // launch any "new subtiles" requests
-    for (auto& key : _loadSubtiles)
+    auto subtiles = prioritize(_loadSubtiles);
+    for (done = 0; done < subtiles.size(); ++done)
     {
-        auto iter = _tiles.find(key);
-        if (iter != _tiles.end())
-        {
-            requestLoadSubtiles(
-                iter->second._tile, // parent
-                terrain);  // context
+        if (done > 0 && out_of_time())
+            break;
 
-            iter->second._tile->_needsSubtiles = false;
-        }
+        requestLoadSubtiles(subtiles[done], terrain);
+        subtiles[done]->_needsSubtiles = false;
     }
-    _loadSubtiles.clear();
+    _stats.subtilesDeferred = (unsigned)(subtiles.size() - done);
 
 #ifdef LOAD_ELEVATION_SEPARATELY
     // launch any data loading requests
@@ -216,51 +316,124 @@ TerrainTilePager::update(
 #endif
 
     // launch any data loading requests
-    for (auto& key : _loadData)
+    auto loads = prioritize(_loadData);
+    for (done = 0; done < loads.size(); ++done)
     {
-        auto iter = _tiles.find(key);
-        if (iter != _tiles.end())
-        {
-            requestLoadData(iter->second._tile, io, terrain);
-        }
+        if (done > 0 && out_of_time())
+            break;
+
+        requestLoadData(loads[done], io, terrain);
     }
-    _loadData.clear();
+    _stats.loadsDeferred = (unsigned)(loads.size() - done);
 
-    // schedule any data merging requests
-    for (auto& key : _mergeData)
+    // Skip expiration if nothing was recorded (e.g. a minimized window);
+    // otherwise every tile would look unused.
+    _stats.expired = 0;
+    _stats.expiryDeferred = false;
+    if (!pings.empty())
+    {
+        expire(terrain, deadline);
+    }
+
+    _stats.budgetedTime = std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - start);
+
+    _stats.pings = (unsigned)pings.size();
+    _stats.tableSize = (unsigned)_tiles.size();
+    _stats.pingLockWait = std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::nanoseconds(_pingLockWaitNanos.exchange(0)));
+    _stats.drawn = _drawnCount.exchange(0);
+    _stats.frustumCulled = _frustumCulledCount.exchange(0);
+    _stats.horizonCulled = _horizonCulledCount.exchange(0);
+}
+
+std::vector<vsg::ref_ptr<TerrainTileNode>>
+TerrainTilePager::prioritize(std::vector<TileKey>& keys) const
+{
+    std::vector<std::pair<float, vsg::ref_ptr<TerrainTileNode>>> sorted;
+    sorted.reserve(keys.size());
+
+    for (auto& key : keys)
     {
         auto iter = _tiles.find(key);
         if (iter != _tiles.end())
         {
-            requestMergeData(iter->second._tile, io, terrain);
+            auto& tile = iter->second._tile;
+            // same as the load job priority: nearest and lowest LOD first
+            sorted.emplace_back(-(sqrt(tile->lastTraversalRange) * tile->key.levelOfDetail()), tile);
         }
     }
-    _mergeData.clear();
+    keys.clear();
+
+    std::stable_sort(sorted.begin(), sorted.end(),
+        [](const auto& lhs, const auto& rhs) { return lhs.first > rhs.first; });
+
+    std::vector<vsg::ref_ptr<TerrainTileNode>> result;
+    result.reserve(sorted.size());
+    for (auto& entry : sorted)
+        result.emplace_back(entry.second);
+    return result;
+}
 
+void
+TerrainTilePager::expire(shared_ptr<TerrainEngine> terrain, Deadline deadline)
+{
     // Flush unused tiles (i.e., tiles that failed to ping) out of the system.
     // Tiles ping their children all at once; this should in theory prevent
     // a child from expiring without its siblings.
-    const auto dispose = [&](TerrainTileNode* tile)
+    // Pinged tiles are all at the front of the list, so we only ever visit
+    // the tiles that actually expire (plus any unpinged doNotExpire tiles).
+    // Whatever doesn't fit in the time budget stays at the back of the list
+    // for the next frame.
+    unsigned maxCount = _settings.maxTilesToUnloadPerFrame.value();
+    unsigned count = 0;
+
+    while (!_lru.empty() && count < maxCount)
     {
-        if (!tile->doNotExpire)
+        TileKey key = _lru.back();
+        auto iter = _tiles.find(key);
+        if (iter == _tiles.end())
         {
-            auto key = tile->key;
-            auto parent_iter = _tiles.find(key.createParentKey());
-            if (parent_iter != _tiles.end())
+            _lru.pop_back();
+            continue;
+        }
+
+        auto& entry = iter->second;
+
+        // everything from here forward was pinged this frame
+        if (entry._lastPing == _generation)
+            break;
+
+        if (entry._tile->doNotExpire)
+        {
+            // treat it as pinged so we don't visit it again this frame
+            _lru.splice(_lru.begin(), _lru, entry._lru);
+            entry._lastPing = _generation;
+            continue;
+        }
+
+        if (count > 0 && std::chrono::steady_clock::now() >= deadline)
+        {
+            _stats.expiryDeferred = true;
+            break;
+        }
+
+        auto parent_iter = _tiles.find(key.createParentKey());
+        if (parent_iter != _tiles.end())
+        {
+            auto parent = parent_iter->second._tile;
+            if (parent.valid())
             {
-                auto parent = parent_iter->second._tile;
-                if (parent.valid())
-                {
-                    parent->unloadSubtiles(terrain->runtime);
-                }
+                parent->unloadSubtiles(terrain->runtime);
             }
-            _tiles.erase(key);
-            return true;
         }
-        return false;
-    };
 
-    _tracker.flush(~0, dispose);
+        _lru.erase(entry._lru);
+        _tiles.erase(iter);
+        ++count;
+    }
+
+    _stats.expired = count;
 }
 
 vsg::ref_ptr<TerrainTileNode>
@@ -438,6 +611,7 @@ TerrainTilePager::requestLoadData(
         TerrainTileModelFactory factory;
 
         factory.compositeColorLayers = true;
+        factory.fetchScheduler = util::job_scheduler::get(engine->fetchSchedulerName);
 
         auto model = factory.createTileModel(
             engine->map.get(),
@@ -445,6 +619,17 @@ TerrainTilePager::requestLoadData(
             manifest,
             IOOptions(io, p));
 
+        // encode the imagery for the GPU while we're still on a loading thread
+        if (engine->settings.compressTextures == true &&
+            !model.colorLayers.empty() &&
+            model.colorLayers[0].image.valid() &&
+            !p.canceled())
+        {
+            engine->stateFactory.compress(
+                model.colorLayers[0].image.image(),
+                engine->settings.compressionQuality);
+        }
+
         return model;
     };
 
@@ -466,116 +651,81 @@ TerrainTilePager::requestLoadData(
         } );
 }
 
-void
-TerrainTilePager::requestMergeData(
+bool
+TerrainTilePager::mergeData(
     vsg::ref_ptr<TerrainTileNode> tile,
-    const IOOptions& in_io,
     shared_ptr<TerrainEngine> engine) const
 {
-    ROCKY_SOFT_ASSERT_AND_RETURN(tile, void());
+    ROCKY_SOFT_ASSERT_AND_RETURN(tile, false);
 
-    // make sure we're not already working on it
+    // make sure we haven't already done it
     if (tile->dataMerger.working() || tile->dataMerger.available())
     {
-        return;
+        return false;
     }
 
-    auto key = tile->key;
-    const IOOptions io(in_io);
+    auto model = tile->dataLoader.value();
 
-    //RP_DEBUG << "requestMergeData -> " << key.str() << std::endl;
+    auto& renderModel = tile->renderModel;
 
-    auto merge = [key, engine](Cancelable& p) -> bool
-    {
-        if (p.canceled())
-        {
-            //RP_DEBUG << "merge CANCELED -> " << key.str() << std::endl;
-            return false;
-        }
-
-        //util::scoped_chrono timer("merge sync " + key.str());
+    bool updated = false;
 
-        auto tile = engine->tiles.getTile(key);
-        if (!tile)
-        {
-            //RP_DEBUG << "merge TILE LOST -> " << key.str() << std::endl;
-            return false;
-        }
-
-        auto model = tile->dataLoader.value();
-
-        auto& renderModel = tile->renderModel;
-
-        bool updated = false;
-
-        if (model.colorLayers.size() > 0)
+    if (model.colorLayers.size() > 0)
+    {
+        auto& layer = model.colorLayers[0];
+        if (layer.image.valid())
         {
-            auto& layer = model.colorLayers[0];
-            if (layer.image.valid())
-            {
-                renderModel.color.name = "color " + layer.key.str();
-                renderModel.color.image = layer.image.image();
-                renderModel.color.matrix = layer.matrix;
-            }
-            updated = true;
+            renderModel.color.name = "color " + layer.key.str();
+            renderModel.color.image = layer.image.image();
+            renderModel.color.matrix = layer.matrix;
         }
+        updated = true;
+    }
 
 #ifndef LOAD_ELEVATION_SEPARATELY
-        if (model.elevation.heightfield.valid())
-        {
-            renderModel.elevation.name = "elevation " + model.elevation.key.str();
-            renderModel.elevation.image = model.elevation.heightfield.heightfield();
-            renderModel.elevation.matrix = model.elevation.matrix;
+    if (model.elevation.heightfield.valid())
+    {
+        renderModel.elevation.name = "elevation " + model.elevation.key.str();
+        renderModel.elevation.image = model.elevation.heightfield.heightfield();
+        renderModel.elevation.matrix = model.elevation.matrix;
 
-            // prompt the tile can update its bounds
-            tile->setElevation(
-                renderModel.elevation.image,
-                renderModel.elevation.matrix);
+        // prompt the tile can update its bounds
+        tile->setElevation(
+            renderModel.elevation.image,
+            renderModel.elevation.matrix);
 
-            updated = true;
-        }
+        updated = true;
+    }
 
-        if (model.normalMap.image.valid())
-        {
-            renderModel.elevation.name = "normal " + model.normalMap.key.str();
-            renderModel.normal.image = model.normalMap.image.image();
-            renderModel.normal.matrix = model.normalMap.matrix;
+    if (model.normalMap.image.valid())
+    {
+        renderModel.elevation.name = "normal " + model.normalMap.key.str();
+        renderModel.normal.image = model.normalMap.image.image();
+        renderModel.normal.matrix = model.normalMap.matrix;
 
-            updated = true;
-        }
+        updated = true;
+    }
 #endif
 
-        renderModel.modelMatrix = to_glm(tile->surface->matrix);
-
-        if (updated)
-        {
-            engine->stateFactory.updateTerrainTileDescriptors(
-                renderModel,
-                tile->stategroup,
-                engine->runtime);
-
-            //RP_DEBUG << "mergeData -> " << key.str() << std::endl;
-        }
-        else
-        {
-            //RP_DEBUG << "merge EMPTY TILE MODEL -> " << key.str() << std::endl;
-        }
+    renderModel.modelMatrix = to_glm(tile->surface->matrix);
 
-        return true;
-    };
-
-    auto merge_op = util::PromiseOperation<bool>::create(merge);
-
-    tile->dataMerger = merge_op->future();
+    if (updated)
+    {
+        engine->stateFactory.updateTerrainTileDescriptors(
+            renderModel,
+            tile->stategroup,
+            engine->runtime);
 
-    vsg::observer_ptr<TerrainTileNode> tile_weak(tile);
-    auto priority_func = [tile_weak]() -> float
+        //RP_DEBUG << "mergeData -> " << tile->key.str() << std::endl;
+    }
+    else
     {
-        vsg::ref_ptr<TerrainTileNode> tile = tile_weak.ref_ptr();
-        return tile ? -(sqrt(tile->lastTraversalRange) * tile->key.levelOfDetail()) : 0.0f;
-    };
+        //RP_DEBUG << "merge EMPTY TILE MODEL -> " << tile->key.str() << std::endl;
+    }
 
-    engine->runtime.runDuringUpdate(merge_op, priority_func);
+    tile->dataMerger.resolve(true);
+
+    return true;
 }
 
 void
@@ -610,6 +760,8 @@ TerrainTilePager::requestLoadElevation(
 
         TerrainTileModelFactory factory;
 
+        factory.fetchScheduler = util::job_scheduler::get(engine->fetchSchedulerName);
+
         auto model = factory.createTileModel(
             engine->map.get(),
             key,
@@ -7,7 +7,10 @@
 
 #include <rocky_vsg/Common.h>
 #include <rocky_vsg/engine/TerrainTileNode.h>
+#include <array>
+#include <atomic>
 #include <chrono>
+#include <list>
 
 namespace ROCKY_NAMESPACE
 {
@@ -22,8 +25,6 @@ namespace ROCKY_NAMESPACE
     public:
         using Ptr = std::shared_ptr<TerrainTilePager>;
 
-        using Tracker = util::SentryTracker<TerrainTileNode*>;
-
         struct TableEntry
         {
             // this needs to be a ref ptr because it's possible for the unloader
@@ -31,12 +32,56 @@ namespace ROCKY_NAMESPACE
             // this Tile into an orphan. As an orphan it will expire and eventually
             // be removed anyway, but we need to keep it alive in the meantime...
             vsg::ref_ptr<TerrainTileNode> _tile;
-            void* _trackerToken;
-            TableEntry() : _trackerToken(nullptr) { }
+
+            // position in the expiration list (most recently pinged first)
+            std::list<TileKey>::iterator _lru;
+
+            // update generation in which this tile was last pinged
+            std::uint64_t _lastPing = 0;
         };
 
         using TileTable = std::unordered_map<TileKey, TableEntry>;
 
+        //! Runtime counters, refreshed by each call to update()
+        struct Stats
+        {
+            //! Pings merged by the last update
+            unsigned pings = 0;
+
+            //! Tiles expired by the last update
+            unsigned expired = 0;
+
+            //! Number of tiles in the registry
+            unsigned tableSize = 0;
+
+            //! Time recording threads spent waiting to post pings since the previous update
+            std::chrono::microseconds pingLockWait = std::chrono::microseconds(0);
+
+            //! Tiles that recorded their own geometry (one draw each) since the previous update
+            unsigned drawn = 0;
+
+            //! Tiles culled by the view frustum since the previous update
+            unsigned frustumCulled = 0;
+
+            //! Tiles culled by the horizon since the previous update
+            unsigned horizonCulled = 0;
+
+            //! Tile data merges run by the last update
+            unsigned merged = 0;
+
+            //! Merges, subtile creations and data loads the last update
+            //! left for a later frame because it ran out of time
+            unsigned mergesDeferred = 0;
+            unsigned subtilesDeferred = 0;
+            unsigned loadsDeferred = 0;
+
+            //! Whether the last update stopped expiring tiles because it ran out of time
+            bool expiryDeferred = false;
+
+            //! Time the last update spent on budgeted work (merges, requests, expiry)
+            std::chrono::microseconds budgetedTime = std::chrono::microseconds(0);
+        };
+
     public:
         //! Consturct the tile manager.
         TerrainTilePager(
@@ -54,9 +99,18 @@ namespace ROCKY_NAMESPACE
             const TerrainTileNode* parent,
             vsg::RecordTraversal&);
 
+        //! TerrainTileNode will call this to report what the record
+        //! traversal did with it. Safe to call from multiple record threads.
+        void recorded(
+            const TerrainTileNode* tile,
+            TileRecordResult result);
+
         //! Number of tiles in the registry.
         unsigned size() const { return _tiles.size(); }
 
+        //! Runtime counters as of the last update.
+        Stats stats() const;
+
         //! Empty the registry, releasing all tiles.
         void releaseAll();
 
@@ -80,7 +134,9 @@ namespace ROCKY_NAMESPACE
     //protected:
 
         TileTable _tiles;
-        Tracker _tracker;
+        std::list<TileKey> _lru;
+        std::uint64_t _generation = 0;
+        Stats _stats;
         mutable std::mutex _mutex;
         TerrainTileHost* _host;
         const TerrainSettings& _settings;
@@ -106,6 +162,44 @@ namespace ROCKY_NAMESPACE
 
     private:
 
+        // Things a tile can ask for when it pings
+        enum PingRequest : std::uint8_t
+        {
+            LOAD_SUBTILES = 1 << 0,
+            LOAD_ELEVATION = 1 << 1,
+            MERGE_ELEVATION = 1 << 2,
+            LOAD_DATA = 1 << 3,
+            MERGE_DATA = 1 << 4,
+            UPDATE_DATA = 1 << 5
+        };
+
+        struct Ping
+        {
+            vsg::ref_ptr<TerrainTileNode> tile;
+            std::uint8_t requests;
+        };
+
+        // Pings are posted to per-thread shards during record so recording
+        // threads never touch the tile table; update() merges them all.
+        struct alignas(64) PingShard
+        {
+            std::mutex mutex;
+            std::vector<Ping> pings;
+        };
+        static constexpr unsigned NUM_PING_SHARDS = 16;
+        std::array<PingShard, NUM_PING_SHARDS> _pingShards;
+        std::atomic<std::int64_t> _pingLockWaitNanos = { 0 };
+        std::atomic_uint _drawnCount = { 0 };
+        std::atomic_uint _frustumCulledCount = { 0 };
+        std::atomic_uint _horizonCulledCount = { 0 };
+
+        using Deadline = std::chrono::steady_clock::time_point;
+
+        // resolves the keys to registered tiles, most important first, and clears the keys
+        std::vector<vsg::ref_ptr<TerrainTileNode>> prioritize(std::vector<TileKey>& keys) const;
+
+        void expire(shared_ptr<TerrainEngine> terrain, Deadline deadline);
+
         void requestLoadSubtiles(
             vsg::ref_ptr<TerrainTileNode> parent,
             shared_ptr<TerrainEngine> terrain) const;
@@ -125,9 +219,8 @@ namespace ROCKY_NAMESPACE
             const IOOptions& io,
             shared_ptr<TerrainEngine> terrain) const;
 
-        void requestMergeData(
+        bool mergeData(
             vsg::ref_ptr<TerrainTileNode> tile,
-            const IOOptions& io,
             shared_ptr<TerrainEngine> terrain) const;
 
         void getRanges(
@@ -7,8 +7,10 @@
 
 #include <rocky_vsg/Common.h>
 #include <rocky/Image.h>
+#include <rocky/CompressedImage.h>
 #include <rocky/Math.h>
 #include <rocky/Threading.h>
+#include <vsg/core/Array2D.h>
 #include <vsg/maths/vec3.h>
 #include <vsg/maths/mat4.h>
 #include <vsg/vk/State.h>
@@ -109,6 +111,81 @@ namespace ROCKY_NAMESPACE
             return vsg_data;
         }
 
+        //! Keeps a rocky Image alive for as long as a VSG Data object
+        //! refers to its pixels. Attached to the Data as an auxiliary object.
+        struct ImageOwner : public vsg::Inherit<vsg::Object, ImageOwner>
+        {
+            shared_ptr<Image> image;
+        };
+
+        template<typename T>
+        vsg::ref_ptr<vsg::Data> share(shared_ptr<Image> image, VkFormat format)
+        {
+            // VSG must never free this memory; the Image owns it.
+            vsg::Data::Properties props;
+            props.format = format;
+            props.allocatorType = vsg::ALLOCATOR_TYPE_NO_DELETE;
+
+            T* data = image->data<T>();
+
+            vsg::ref_ptr<vsg::Data> vsg_data;
+            if (image->depth() == 1)
+            {
+                vsg_data = vsg::Array2D<T>::create(
+                    image->width(), image->height(),
+                    data,
+                    props);
+            }
+            else
+            {
+                vsg_data = vsg::Array3D<T>::create(
+                    image->width(), image->height(), image->depth(),
+                    data,
+                    props);
+            }
+
+            auto owner = ImageOwner::create();
+            owner->image = image;
+            vsg_data->setObject("rocky::Image", owner);
+
+            return vsg_data;
+        }
+
+        //! Wraps a rocky Image's pixels in a VSG Data object without copying.
+        //! The Image and the Data share the pixel storage, which stays alive
+        //! until both let go of it.
+        inline vsg::ref_ptr<vsg::Data> shareImageData(shared_ptr<Image> image)
+        {
+            if (!image) return { };
+
+            switch (image->pixelFormat())
+            {
+            case Image::R8_UNORM:
+                return share<unsigned char>(image, VK_FORMAT_R8_UNORM);
+                break;
+            case Image::R8G8_UNORM:
+                return share<vsg::ubvec2>(image, VK_FORMAT_R8G8_UNORM);
+                break;
+            case Image::R8G8B8_UNORM:
+                return share<vsg::ubvec3>(image, VK_FORMAT_R8G8B8_UNORM);
+                break;
+            case Image::R8G8B8A8_UNORM:
+                return share<vsg::ubvec4>(image, VK_FORMAT_R8G8B8A8_UNORM);
+                break;
+            case Image::R16_UNORM:
+                return share<unsigned short>(image, VK_FORMAT_R16_UNORM);
+                break;
+            case Image::R32_SFLOAT:
+                return share<float>(image, VK_FORMAT_R32_SFLOAT);
+                break;
+            case Image::R64_SFLOAT:
+                return share<double>(image, VK_FORMAT_R64_SFLOAT);
+                break;
+            };
+
+            return { };
+        }
+
         //! Moves a rocky Image object into a VSG Data object.
         //! The source Image is cleared in the process.
         inline vsg::ref_ptr<vsg::Data> moveImageData(shared_ptr<Image> image)
@@ -159,6 +236,71 @@ namespace ROCKY_NAMESPACE
             return data;
         }
 
+        // Share the input image's pixels with a VSG object (zero-copy).
+        // Unlike moveImageToVSG, the input image stays valid. Treat it as
+        // read-only from here on: anything that needs different pixels
+        // must clone it (copy-on-write) rather than modify it in place.
+        inline vsg::ref_ptr<vsg::Data> shareImageWithVSG(shared_ptr<Image> image)
+        {
+            auto data = shareImageData(image);
+            if (!data)
+                return {};
+
+            data->properties.origin = vsg::TOP_LEFT;
+            data->properties.maxNumMipmaps = 1;
+
+            return data;
+        }
+
+        //! Keeps a rocky CompressedImage alive for as long as a VSG Data
+        //! object refers to its blocks.
+        struct CompressedImageOwner : public vsg::Inherit<vsg::Object, CompressedImageOwner>
+        {
+            shared_ptr<CompressedImage> image;
+        };
+
+        // Share a block-compressed image, with all its mipmap levels,
+        // with a VSG object (zero-copy).
+        inline vsg::ref_ptr<vsg::Data> shareCompressedImageWithVSG(shared_ptr<CompressedImage> image)
+        {
+            if (!image || image->numLevels() == 0)
+                return {};
+
+            vsg::Data::Properties props;
+            props.format = image->format() == CompressedImage::BC1 ?
+                VK_FORMAT_BC1_RGB_UNORM_BLOCK :
+                VK_FORMAT_BC3_UNORM_BLOCK;
+            props.blockWidth = 4;
+            props.blockHeight = 4;
+            props.maxNumMipmaps = image->numLevels();
+            props.origin = vsg::TOP_LEFT;
+            props.allocatorType = vsg::ALLOCATOR_TYPE_NO_DELETE;
+
+            // dimensions are in blocks; the levels follow the base level
+            auto data = const_cast<std::uint8_t*>(image->data().data());
+            vsg::ref_ptr<vsg::Data> vsg_data;
+            if (image->format() == CompressedImage::BC1)
+            {
+                vsg_data = vsg::block64Array2D::create(
+                    image->width() / 4, image->height() / 4,
+                    reinterpret_cast<vsg::block64*>(data),
+                    props);
+            }
+            else
+            {
+                vsg_data = vsg::block128Array2D::create(
+                    image->width() / 4, image->height() / 4,
+                    reinterpret_cast<vsg::block128*>(data),
+                    props);
+            }
+
+            auto owner = CompressedImageOwner::create();
+            owner->image = image;
+            vsg_data->setObject("rocky::CompressedImage", owner);
+
+            return vsg_data;
+        }
+
         // Convert a vsg::Data structure to an Image if possible
         inline Result<shared_ptr<Image>> makeImageFromVSG(vsg::ref_ptr<vsg::Data> data)
         {
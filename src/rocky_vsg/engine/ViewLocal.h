@@ -6,8 +6,8 @@
 #pragma once
 
 #include <rocky/Common.h>
-#include <mutex>
-#include <vector>
+#include <array>
+#include <atomic>
 
 namespace ROCKY_NAMESPACE
 {
@@ -21,31 +21,83 @@ namespace ROCKY_NAMESPACE
         * ViewLocal<Data> viewlocal;
         * ...
         * auto view_data = viewlocal[t->getState()->_commandBuffer->viewID];
+        *
+        * Most objects only ever see one view, so view 0 lives inline and
+        * the others are allocated on first use in small chunks. Views may
+        * record in parallel, so chunks never move; a reference returned by
+        * operator[] stays valid for the lifetime of this object.
         */
         template<typename T> struct ViewLocal
         {
         public:
+            //! Number of view slots allocated together, after view 0
+            static constexpr std::uint32_t chunk_size = 4;
+
+            //! Maximum number of views supported
+            static constexpr std::uint32_t max_views = 1 + chunk_size * 256;
+
+            ViewLocal() = default;
+            ViewLocal(const ViewLocal&) = delete;
+            ViewLocal& operator=(const ViewLocal&) = delete;
+
+            ~ViewLocal()
+            {
+                if (auto* chunks = _chunks.load())
+                {
+                    for (auto& chunk : *chunks)
+                        delete[] chunk.load();
+                    delete chunks;
+                }
+            }
+
             //! Fetch the data associated with the view id
             T& operator[](std::uint32_t viewID) const
             {
-                if (viewID >= _vdd.size())
+                if (viewID == 0)
+                    return _first;
+
+                ROCKY_HARD_ASSERT(viewID < max_views);
+
+                // lock-free, since allocating is rare and a per-object
+                // mutex would cost more memory than the data it guards
+                auto* chunks = _chunks.load(std::memory_order_acquire);
+                if (!chunks)
+                {
+                    auto* fresh = new Chunks();
+                    if (_chunks.compare_exchange_strong(chunks, fresh, std::memory_order_acq_rel))
+                        chunks = fresh;
+                    else
+                        delete fresh;
+                }
+
+                auto index = viewID - 1;
+                auto& slot = (*chunks)[index / chunk_size];
+                T* chunk = slot.load(std::memory_order_acquire);
+                if (!chunk)
                 {
-                    std::scoped_lock lock(_mutex);
-                    if (viewID >= _vdd.size())
-                    {
-                        _vdd.resize(viewID + 1);
-                    }
+                    auto* fresh = new T[chunk_size];
+                    if (slot.compare_exchange_strong(chunk, fresh, std::memory_order_acq_rel))
+                        chunk = fresh;
+                    else
+                        delete[] fresh;
                 }
-                return _vdd[viewID];
+
+                std::uint32_t end = (index / chunk_size + 1) * chunk_size + 1;
+                std::uint32_t size = _size.load(std::memory_order_relaxed);
+                while (end > size && !_size.compare_exchange_weak(size, end));
+
+                return chunk[index % chunk_size];
             }
-            using iterator = typename std::vector<T>::iterator;
-            iterator begin() { return _vdd.begin(); }
-            iterator end() { return _vdd.end(); }
-            std::size_t size() const { return _vdd.size(); }
+
+            //! Number of view slots allocated so far. Every index below
+            //! this is a valid argument to operator[].
+            std::size_t size() const { return _size; }
 
         private:
-            mutable std::mutex _mutex;
-            mutable std::vector<T> _vdd;
+            using Chunks = std::array<std::atomic<T*>, (max_views - 1) / chunk_size>;
+            mutable T _first = { };
+            mutable std::atomic<Chunks*> _chunks = { nullptr };
+            mutable std::atomic<std::uint32_t> _size = { 1 };
         };
     }
 }
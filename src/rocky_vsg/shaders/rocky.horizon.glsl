@@ -0,0 +1,22 @@
+// Cesium-style horizon test for a point:
+// https://cesium.com/blog/2013/04/25/horizon-culling/
+// modelview: rigid model-to-view matrix
+// target: point to test, in model coordinates
+// center: center of the ellipsoid, in model coordinates
+// inv_radii: 1/ellipsoid radii, or zero to disable the test
+bool rk_beyond_horizon(in mat4 modelview, in vec3 target, in vec3 center, in vec3 inv_radii)
+{
+    if (inv_radii.x == 0.0)
+        return false;
+
+    // eye position in model coordinates
+    mat3 rot = mat3(modelview);
+    vec3 eye = -(transpose(rot) * modelview[3].xyz);
+
+    vec3 vc = (center - eye) * inv_radii;
+    vec3 vt = (target - eye) * inv_radii;
+    float vh_mag2 = dot(vc, vc) - 1.0;
+    float vt_dot_vc = dot(vt, vc);
+
+    return vh_mag2 > 0.0 && vt_dot_vc > vh_mag2 && vt_dot_vc * vt_dot_vc / dot(vt, vt) > vh_mag2;
+}
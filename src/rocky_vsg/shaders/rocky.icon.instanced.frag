@@ -0,0 +1,16 @@
+#version 450
+
+// uniforms
+layout(set = 0, binding = 2) uniform sampler2DArray icon_textures;
+
+// inputs
+layout(location = 0) in vec2 uv;
+layout(location = 1) flat in float layer;
+
+// outputs
+layout(location = 0) out vec4 out_color;
+
+void main()
+{
+    out_color = texture(icon_textures, vec3(uv, layer));
+}
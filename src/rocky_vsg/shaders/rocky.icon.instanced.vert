@@ -0,0 +1,73 @@
+#version 450
+
+// vsg push constants
+layout(push_constant) uniform PushConstants {
+    mat4 projection;
+    mat4 modelview;
+} pc;
+
+// rocky::IconInstancer per-instance data
+struct Instance {
+    vec4 position_size;  // xyz = position relative to the batch anchor, w = size in pixels
+    vec4 rotation_layer; // x = rotation in radians, y = texture layer, z = visible (0 or 1)
+};
+
+layout(std430, set = 0, binding = 1) readonly buffer Instances {
+    Instance instances[];
+};
+
+// rocky::IconInstancer per-batch data
+layout(set = 0, binding = 3) uniform Batch {
+    vec4 center;    // center of the ellipsoid relative to the batch anchor
+    vec4 inv_radii; // 1/ellipsoid radii, or zero to disable horizon culling
+} batch;
+
+// vsg viewport data
+layout(set = 1, binding = 1) uniform VSG_Viewports {
+    vec4 viewport[1]; // x, y, width, height
+} vsg_viewports;
+
+// output varyings
+layout(location = 0) out vec2 uv;
+layout(location = 1) flat out float layer;
+
+// GL built-ins
+out gl_PerVertex {
+    vec4 gl_Position;
+};
+
+#include "rocky.horizon.glsl"
+
+void main()
+{
+    Instance instance = instances[gl_InstanceIndex];
+
+    if (instance.rotation_layer.z == 0.0 || rk_beyond_horizon(pc.modelview, instance.position_size.xyz, batch.center.xyz, batch.inv_radii.xyz))
+    {
+        // outside the clip volume, so the rasterizer drops it
+        gl_Position = vec4(2.0, 2.0, 2.0, 1.0);
+        return;
+    }
+
+    vec4 clip = pc.projection * pc.modelview * vec4(instance.position_size.xyz, 1);
+
+    // extrude the vertex based on its index to form a clip-space billboard
+    vec2 signs = vec2(
+        gl_VertexIndex == 0 || gl_VertexIndex == 3 || gl_VertexIndex == 5 ? -1 : 1,
+        gl_VertexIndex == 0 || gl_VertexIndex == 1 || gl_VertexIndex == 3 ? -1 : 1);
+
+    vec2 viewport_size = vsg_viewports.viewport[0].zw;
+    vec2 pixel_size = 2.0 / viewport_size;
+
+    // scale and rotate:
+    float rotation = instance.rotation_layer.x;
+    float sr = sin(rotation), cr = cos(rotation);
+    vec2 offset = mat2(cr, sr, -sr, cr) * (instance.position_size.w * signs * 0.5);
+
+    clip.xy += (offset * pixel_size * clip.w);
+
+    uv = vec2(signs.x + 1.0, -signs.y + 1.0) * 0.5;
+    layer = instance.rotation_layer.y;
+
+    gl_Position = clip;
+}
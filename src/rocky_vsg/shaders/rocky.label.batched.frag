@@ -0,0 +1,39 @@
+#version 450
+
+// uniforms
+layout(set = 0, binding = 3) uniform sampler2D font_atlas;
+
+// inputs
+layout(location = 0) in vec2 uv;
+layout(location = 1) flat in float outline;
+
+// outputs
+layout(location = 0) out vec4 out_color;
+
+const vec4 text_color = vec4(1.0, 0.9, 1.0, 1.0);
+const vec4 outline_color = vec4(0.0, 0.0, 0.0, 1.0);
+
+void main()
+{
+    // signed distance field with the glyph edge at 0.5
+    float distance = texture(font_atlas, uv).r;
+    float blur = max(fwidth(distance) * 0.7, 0.001);
+
+    float text_alpha = smoothstep(0.5 - blur, 0.5 + blur, distance);
+
+    if (outline > 0.0)
+    {
+        float outline_edge = 0.5 - outline;
+        float outline_alpha = smoothstep(outline_edge - blur, outline_edge + blur, distance);
+        out_color = mix(outline_color, text_color, text_alpha);
+        out_color.a *= outline_alpha;
+    }
+    else
+    {
+        out_color = text_color;
+        out_color.a *= text_alpha;
+    }
+
+    if (out_color.a <= 0.0)
+        discard;
+}
@@ -0,0 +1,78 @@
+#version 450
+
+// vsg push constants
+layout(push_constant) uniform PushConstants {
+    mat4 projection;
+    mat4 modelview;
+} pc;
+
+// rocky::LabelBatcher per-glyph data
+struct Glyph {
+    vec4 rect;   // x0, y0, x1, y1 in pixels relative to the label position
+    vec4 uvrect; // u0, v0, u1, v1 in the font atlas
+    vec4 info;   // x = label index, y = outline width, z = used (0 or 1)
+};
+
+layout(std430, set = 0, binding = 1) readonly buffer Glyphs {
+    Glyph glyphs[];
+};
+
+// rocky::LabelBatcher per-label data:
+// xyz = position relative to the batch anchor, w = visible (0 or 1)
+layout(std430, set = 0, binding = 2) readonly buffer Labels {
+    vec4 labels[];
+};
+
+// rocky::LabelBatcher per-batch data
+layout(set = 0, binding = 4) uniform Batch {
+    vec4 center;    // center of the ellipsoid relative to the batch anchor
+    vec4 inv_radii; // 1/ellipsoid radii, or zero to disable horizon culling
+} batch;
+
+// vsg viewport data
+layout(set = 1, binding = 1) uniform VSG_Viewports {
+    vec4 viewport[1]; // x, y, width, height
+} vsg_viewports;
+
+// output varyings
+layout(location = 0) out vec2 uv;
+layout(location = 1) flat out float outline;
+
+// GL built-ins
+out gl_PerVertex {
+    vec4 gl_Position;
+};
+
+#include "rocky.horizon.glsl"
+
+void main()
+{
+    Glyph glyph = glyphs[gl_InstanceIndex];
+    vec4 label = labels[int(glyph.info.x)];
+
+    if (glyph.info.z == 0.0 || label.w == 0.0 || rk_beyond_horizon(pc.modelview, label.xyz, batch.center.xyz, batch.inv_radii.xyz))
+    {
+        // outside the clip volume, so the rasterizer drops it
+        gl_Position = vec4(2.0, 2.0, 2.0, 1.0);
+        return;
+    }
+
+    vec4 clip = pc.projection * pc.modelview * vec4(label.xyz, 1);
+
+    // select the corner of the glyph quad based on the vertex index
+    vec2 corner = vec2(
+        gl_VertexIndex == 0 || gl_VertexIndex == 3 || gl_VertexIndex == 5 ? 0 : 1,
+        gl_VertexIndex == 0 || gl_VertexIndex == 1 || gl_VertexIndex == 3 ? 0 : 1);
+
+    vec2 viewport_size = vsg_viewports.viewport[0].zw;
+    vec2 pixel_size = 2.0 / viewport_size;
+
+    // glyph layout is y-up; clip space is y-down
+    vec2 offset = mix(glyph.rect.xy, glyph.rect.zw, corner);
+    clip.xy += vec2(offset.x, -offset.y) * pixel_size * clip.w;
+
+    uv = mix(glyph.uvrect.xy, glyph.uvrect.zw, corner);
+    outline = glyph.info.y;
+
+    gl_Position = clip;
+}
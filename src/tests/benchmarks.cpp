@@ -0,0 +1,580 @@
+/**
+ * rocky c++
+ * Copyright 2023 Pelican Mapping
+ * MIT License
+ */
+
+// Performance benchmarks. These are not part of the test suite; run them
+// by hand, optionally naming the ones to run:
+//
+//   rbenchmarks [name ...]
+//
+// Every measurement prints as one line in the same format, so it's easy to
+// compare runs before and after a change.
+
+#include "helpers.h"
+
+#include <rocky/CompressedImage.h>
+#include <rocky/ElevationLayer.h>
+#include <rocky/GeoImage.h>
+#include <rocky/Heightfield.h>
+#include <rocky/Instance.h>
+#include <rocky/Map.h>
+#include <rocky/SRS.h>
+#include <rocky/TerrainTileModelFactory.h>
+#include <rocky/Threading.h>
+#include <rocky/URI.h>
+#include <rocky/Utils.h>
+
+#include <algorithm>
+#include <cfloat>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+
+#ifdef HTTPLIB_FOUND
+#ifdef OPENSSL_FOUND
+#define CPPHTTPLIB_OPENSSL_SUPPORT
+#endif
+#include <httplib.h>
+#endif
+
+using namespace ROCKY_NAMESPACE;
+using namespace ROCKY_NAMESPACE::test;
+
+namespace
+{
+    struct Benchmark
+    {
+        std::string name;
+        std::string description;
+        std::function<void()> run;
+    };
+
+    std::vector<Benchmark>& benchmarks()
+    {
+        static std::vector<Benchmark> list;
+        return list;
+    }
+
+    struct Registration
+    {
+        Registration(const std::string& name, const std::string& description, void(*run)()) {
+            benchmarks().push_back({ name, description, run });
+        }
+    };
+
+    //! Milliseconds per call of func, averaged over the iterations
+    template<class FUNC>
+    double measure(int iterations, FUNC&& func)
+    {
+        util::timer<> timer;
+        for (int i = 0; i < iterations; ++i)
+            func();
+        return timer.milliseconds() / (double)iterations;
+    }
+
+    //! Prints one measurement
+    void report(const std::string& label, double value, const std::string& units, const std::string& notes = {})
+    {
+        std::cout << "  " << std::left << std::setw(40) << label
+            << std::right << std::setw(12) << std::fixed << std::setprecision(3) << value
+            << " " << std::left << std::setw(10) << units
+            << notes << std::endl;
+    }
+
+    //! Abandons the current benchmark when a precondition fails
+    void require(bool condition, const std::string& what)
+    {
+        if (!condition)
+            throw std::runtime_error(what);
+    }
+
+    //! Image layer with smooth synthetic elevation
+    class SyntheticElevationLayer : public Inherit<ElevationLayer, SyntheticElevationLayer>
+    {
+    public:
+        float offset = 0.0f;
+
+        Status openImplementation(const IOOptions& io) override {
+            setProfile(Profile::GLOBAL_GEODETIC);
+            return super::openImplementation(io);
+        }
+
+        Result<GeoHeightfield> createHeightfieldImplementation(const TileKey& key, const IOOptions& io) const override {
+            auto size = tileSize().value();
+            auto hf = Heightfield::create(size, size);
+            auto& ex = key.extent();
+            for (unsigned r = 0; r < size; ++r) {
+                for (unsigned c = 0; c < size; ++c) {
+                    double x = ex.xmin() + ex.width() * (double)c / (double)(size - 1);
+                    double y = ex.ymin() + ex.height() * (double)r / (double)(size - 1);
+                    hf->heightAt(c, r) = offset + (float)(1000.0 * sin(x * 0.1) * cos(y * 0.1));
+                }
+            }
+            return GeoHeightfield(hf, ex);
+        }
+    };
+}
+
+#define ROCKY_BENCHMARK_NAME2(PREFIX, LINE) PREFIX##LINE
+#define ROCKY_BENCHMARK_NAME(PREFIX, LINE) ROCKY_BENCHMARK_NAME2(PREFIX, LINE)
+
+//! Defines and registers a benchmark
+#define BENCHMARK(NAME, DESCRIPTION) \
+    static void ROCKY_BENCHMARK_NAME(benchmark_, __LINE__)(); \
+    static Registration ROCKY_BENCHMARK_NAME(registration_, __LINE__)(NAME, DESCRIPTION, &ROCKY_BENCHMARK_NAME(benchmark_, __LINE__)); \
+    static void ROCKY_BENCHMARK_NAME(benchmark_, __LINE__)()
+
+
+BENCHMARK("job_scheduler",
+    "Pop latency with a large backlog of pending jobs. A zero refresh interval "
+    "re-evaluates every priority on every pop, like a linear-scan queue.")
+{
+    auto run = [](unsigned num_jobs, std::chrono::steady_clock::duration refresh, const std::string& name)
+    {
+        util::job_scheduler scheduler(name, 1u);
+        scheduler.setPriorityRefreshInterval(refresh);
+
+        util::Event gate;
+        util::job_group group;
+        std::vector<util::Future<bool>> results;
+        results.reserve(num_jobs + 1);
+
+        results.emplace_back(util::job::dispatch(
+            [&gate](Cancelable&) { return gate.wait(); },
+            { "gate", []() { return FLT_MAX; }, &scheduler, &group }));
+
+        std::mt19937 engine(0);
+        std::uniform_real_distribution<float> prng(0.0f, 1000.0f);
+        for (unsigned i = 0; i < num_jobs; ++i)
+        {
+            float p = prng(engine);
+            results.emplace_back(util::job::dispatch(
+                [](Cancelable&) { return true; },
+                { "job", [p]() { return p; }, &scheduler, &group }));
+        }
+
+        util::timer<> timer;
+        gate.set();
+        group.join();
+        auto ms = timer.milliseconds();
+
+        report(name, 1e3 * ms / (double)num_jobs, "us/job",
+            std::to_string((unsigned)(1e3 * (double)num_jobs / ms)) + " jobs/s");
+    };
+
+    for (unsigned num_jobs : { 10000u, 25000u })
+    {
+        run(num_jobs, std::chrono::steady_clock::duration(0), "refresh every pop, " + std::to_string(num_jobs) + " jobs");
+        run(num_jobs, std::chrono::milliseconds(16), "refresh every 16ms, " + std::to_string(num_jobs) + " jobs");
+    }
+}
+
+BENCHMARK("job_scheduler work stealing",
+    "Scaling of a CPU-bound fan-out (like building elevation mosaics for a batch "
+    "of tiles) with the thread count. The shared queue gets every leaf job from "
+    "one thread; with work stealing each tile's job fans out its own.")
+{
+    const int num_tiles = 64, num_rows = 64;
+
+    auto work = [](int seed)
+    {
+        double sum = 0.0;
+        for (int i = 0; i < 20000; ++i)
+            sum += std::sin((double)(seed + i));
+        return sum != 0.0;
+    };
+
+    auto run = [&](unsigned threads, bool stealing)
+    {
+        std::string name = std::string(stealing ? "stealing-" : "shared-") + std::to_string(threads);
+        util::job_scheduler scheduler(name, threads);
+        scheduler.setWorkStealing(stealing);
+
+        util::job_group group;
+        std::vector<util::Future<bool>> results;
+
+        return measure(1, [&]()
+            {
+                if (stealing)
+                {
+                    for (int t = 0; t < num_tiles; ++t)
+                    {
+                        results.emplace_back(util::job::dispatch(
+                            [&, t](Cancelable&)
+                            {
+                                util::job_group rows;
+                                std::vector<util::Future<bool>> subresults;
+                                for (int r = 0; r < num_rows; ++r)
+                                {
+                                    subresults.emplace_back(util::job::dispatch(
+                                        [&, t, r](Cancelable&) { return work(t * num_rows + r); },
+                                        { "row", nullptr, &scheduler, &rows }));
+                                }
+                                rows.join();
+                                return true;
+                            },
+                            { "tile", nullptr, &scheduler, &group }));
+                    }
+                }
+                else
+                {
+                    for (int i = 0; i < num_tiles * num_rows; ++i)
+                    {
+                        results.emplace_back(util::job::dispatch(
+                            [&, i](Cancelable&) { return work(i); },
+                            { "row", nullptr, &scheduler, &group }));
+                    }
+                }
+                group.join();
+            });
+    };
+
+    unsigned max_threads = std::max(1u, std::thread::hardware_concurrency());
+    for (bool stealing : { false, true })
+    {
+        double base = 0.0;
+        for (unsigned threads = 1; threads <= max_threads; threads *= 2)
+        {
+            double ms = run(threads, stealing);
+            if (threads == 1)
+                base = ms;
+
+            std::ostringstream speedup;
+            speedup << std::setprecision(2) << (base / ms) << "x";
+            report(std::string(stealing ? "work stealing, " : "shared queue, ") + std::to_string(threads) + " threads",
+                ms, "ms", speedup.str());
+        }
+    }
+}
+
+#ifdef GDAL_FOUND
+BENCHMARK("weemesh",
+    "Time to cut real-world country polygons into the seed grid with the "
+    "map-based mesh_t and with flat_mesh_t, checking that they agree.")
+{
+    auto fs = OGRFeatureSource::create();
+    fs->uri = "https://readymap.org/readymap/filemanager/download/public/countries.geojson";
+    require(fs->open().ok(), "countries.geojson unavailable");
+
+    // degrees to the same scale FeatureView meshes at (gnomonic_scale * pi / 180),
+    // seeded at its 0.25 degree resolution
+    const double scale = 1000.0 * M_PI / 180.0;
+    const double span = 0.25 * scale;
+
+    std::vector<Geometry> polygons;
+    IOOptions io;
+    auto iter = fs->iterate(io);
+    while (iter->hasMore())
+    {
+        auto& feature = iter->next();
+        if (feature.geometry.type == Geometry::Type::Polygon)
+            polygons.push_back(feature.geometry);
+        else if (feature.geometry.type == Geometry::Type::MultiPolygon)
+            polygons.insert(polygons.end(), feature.geometry.parts.begin(), feature.geometry.parts.end());
+    }
+    for (auto& polygon : polygons)
+    {
+        Geometry::iterator scale_iter(polygon);
+        while (scale_iter.hasMore())
+            for (auto& p : scale_iter.next().points)
+                p *= scale;
+    }
+    require(!polygons.empty(), "no polygons");
+
+    double mesh_ms = 0.0, flat_ms = 0.0;
+    std::size_t triangles = 0, mismatches = 0;
+
+    for (auto& polygon : polygons)
+    {
+        weemesh::mesh_t mesh;
+        weemesh::flat_mesh_t flat;
+        std::vector<std::array<double, 6>> expected, actual;
+
+        mesh_ms += measure(1, [&]() { expected = weemesh_polygon(mesh, polygon, span); });
+        flat_ms += measure(1, [&]() { actual = weemesh_polygon(flat, polygon, span); });
+
+        triangles += actual.size();
+        // (past the 16-bit vertex limit the meshes may legitimately differ)
+        if (mesh.verts.size() + 1 < 0xFFFF && actual != expected)
+            ++mismatches;
+    }
+
+    auto notes = std::to_string(polygons.size()) + " polygons, " + std::to_string(triangles) + " triangles";
+    report("mesh_t", mesh_ms, "ms", notes);
+    report("flat_mesh_t", flat_ms, "ms", notes);
+
+    require(mismatches == 0, std::to_string(mismatches) + " flat_mesh_t results differ from mesh_t");
+}
+#endif
+
+BENCHMARK("CompressedImage",
+    "Cost of block-compressing one terrain tile's color texture with mipmaps.")
+{
+    auto image = Image::create(Image::R8G8B8A8_UNORM, 256, 256);
+    std::mt19937 engine(0);
+    std::uniform_real_distribution<float> prng(0.0f, 1.0f);
+    for (unsigned t = 0; t < 256; ++t)
+        for (unsigned s = 0; s < 256; ++s)
+            image->write(Color(prng(engine), (float)t / 255.0f, (float)s / 255.0f, 1.0f), s, t);
+
+    for (float quality : { 0.0f, 0.5f, 1.0f })
+    {
+        shared_ptr<CompressedImage> result;
+        auto ms = measure(20, [&]() { result = CompressedImage::compress(*image, quality, true); });
+        require(result != nullptr, "compression failed");
+
+        std::ostringstream label;
+        label << "quality " << quality;
+        report(label.str(), ms, "ms/tile", std::to_string(result->uncompressedSize() / result->data().size()) + ":1");
+    }
+}
+
+BENCHMARK("SRS grid",
+    "Exact vs. approximate transformation of a 256x256 tile sample grid, "
+    "at an eighth-of-a-pixel tolerance.")
+{
+    const unsigned n = 256;
+
+    auto run = [&](const std::string& name, const SRS& from, const SRS& to,
+        double xmin, double ymin, double xmax, double ymax)
+    {
+        std::vector<glm::dvec3> grid(n * n);
+        for (unsigned r = 0; r < n; ++r)
+            for (unsigned c = 0; c < n; ++c)
+                grid[r * n + c] = glm::dvec3(xmin + (xmax - xmin) * c / (n - 1), ymin + (ymax - ymin) * r / (n - 1), 0.0);
+
+        // tolerance in target units: 1/8 of the target pixel size
+        glm::dvec3 ll(xmin, ymin, 0), ur(xmax, ymax, 0);
+        from.to(to).transform(ll, ll);
+        from.to(to).transform(ur, ur);
+        double tolerance = 0.125 * std::min(ur.x - ll.x, ur.y - ll.y) / (double)n;
+
+        for (double tol : { 0.0, tolerance })
+        {
+            auto xform = from.to(to);
+            xform.setGridErrorTolerance(tol);
+
+            auto ms = measure(20, [&]()
+                {
+                    auto points = grid;
+                    xform.transformGrid(points.data(), n, n);
+                });
+
+            report(name + (tol > 0.0 ? " (approximate)" : " (exact)"), ms, "ms/tile");
+        }
+    };
+
+    run("geographic > mercator", SRS::WGS84, SRS::SPHERICAL_MERCATOR, 0.0, 40.0, 11.25, 50.0);
+    run("mercator > geographic", SRS::SPHERICAL_MERCATOR, SRS::WGS84, 0.0, 4.8e6, 1.25e6, 6.05e6);
+}
+
+BENCHMARK("Image",
+    "Per-megapixel throughput of the image paths that build terrain tiles.")
+{
+    const unsigned size = 1024;
+    const double mpix = (double)(size * size) / 1e6;
+    const int iterations = 5;
+
+    auto image = Image::create(Image::R8G8B8A8_UNORM, size, size);
+    image->fill(Color(0.25f, 0.5f, 0.75f, 1.0f));
+    GeoImage source(image, GeoExtent(SRS::WGS84, -20, -20, 20, 20));
+
+    std::vector<Image::Pixel> row(size);
+
+    auto ms = measure(iterations, [&]()
+        {
+            for (unsigned t = 0; t < size; ++t)
+                for (unsigned s = 0; s < size; ++s)
+                    image->read(row[s], s, t);
+        });
+    report("read (per pixel)", ms / mpix, "ms/Mpix");
+
+    ms = measure(iterations, [&]()
+        {
+            for (unsigned t = 0; t < size; ++t)
+                image->readSpan(row.data(), 0, t, size);
+        });
+    report("read (span)", ms / mpix, "ms/Mpix");
+
+    ms = measure(iterations, [&]()
+        {
+            for (unsigned t = 0; t < size; ++t)
+                image->writeSpan(row.data(), 0, t, size);
+        });
+    report("write (span)", ms / mpix, "ms/Mpix");
+
+    ms = measure(iterations, [&]()
+        {
+            auto result = source.reproject(SRS::SPHERICAL_MERCATOR, nullptr, size, size);
+            require(result.status.ok(), "reproject failed");
+        });
+    report("reproject", ms / mpix, "ms/Mpix");
+
+    ms = measure(iterations, [&]()
+        {
+            auto canvas = Image::create(Image::R8G8B8A8_UNORM, size, size);
+            canvas->fill(Color(0, 0, 0, 0));
+            GeoImage mosaic(canvas, GeoExtent(SRS::WGS84, -10, -10, 10, 10));
+            mosaic.composite({ source });
+        });
+    report("mosaic", ms / mpix, "ms/Mpix");
+}
+
+BENCHMARK("Heightfield mosaic",
+    "Time to mosaic a 257x257 terrain tile from 1 to 4 stacked elevation "
+    "layers whose 256x256 tiles must be resampled.")
+{
+    IOOptions io;
+    const TileKey key(4, 3, 5, Profile::GLOBAL_GEODETIC);
+
+    for (unsigned num_layers = 1; num_layers <= 4; ++num_layers)
+    {
+        ElevationLayerVector layers;
+        for (unsigned i = 0; i < num_layers; ++i)
+        {
+            auto layer = SyntheticElevationLayer::create();
+            layer->offset = (float)i;
+            layer->setTileSize(256);
+            require(layer->open(io).ok(), "layer failed to open");
+            layers.push_back(layer);
+        }
+
+        auto hf = Heightfield::create(257, 257);
+        std::vector<float> resolutions(hf->sizeInPixels());
+
+        auto ms = measure(20, [&]()
+            {
+                hf->fill(NO_DATA_VALUE);
+                require(layers.populateHeightfield(hf, &resolutions, key, Profile(), Heightfield::BILINEAR, io),
+                    "populateHeightfield failed");
+            });
+
+        report(std::to_string(num_layers) + " layer(s)", ms, "ms/tile");
+    }
+}
+
+BENCHMARK("TerrainTileModelFactory",
+    "Time to build one tile model from 1 to 8 stacked image layers that each "
+    "take 20ms to respond, fetching serially vs. in parallel.")
+{
+    Instance instance;
+    IOOptions io;
+    const TileKey key(2, 1, 1, Profile::GLOBAL_GEODETIC);
+    util::job_scheduler::setConcurrency("benchmark.fetch", 8);
+
+    for (unsigned num_layers = 1; num_layers <= 8; num_layers *= 2)
+    {
+        auto map = Map::create(instance);
+        for (unsigned i = 0; i < num_layers; ++i)
+        {
+            auto layer = CountingImageLayer::create();
+            layer->latency = std::chrono::milliseconds(20);
+            require(layer->open(io).ok(), "layer failed to open");
+            map->layers().add(layer);
+        }
+
+        for (bool parallel : { false, true })
+        {
+            TerrainTileModelFactory factory;
+            if (parallel)
+                factory.fetchScheduler = util::job_scheduler::get("benchmark.fetch");
+
+            auto ms = measure(1, [&]()
+                {
+                    auto model = factory.createTileModel(map.get(), key, {}, io);
+                    require(model.colorLayers.size() == 1, "no color layer");
+                });
+
+            report(std::to_string(num_layers) + " layer(s), " + (parallel ? "parallel" : "serial"), ms, "ms/tile");
+        }
+    }
+}
+
+#ifdef HTTPLIB_FOUND
+BENCHMARK("HTTP",
+    "Tile fetch throughput against a local server, with and without "
+    "persistent connections.")
+{
+    httplib::Server server;
+    server.Get("/tile", [](const httplib::Request&, httplib::Response& res) {
+        res.set_content(std::string(16 * 1024, 'x'), "application/octet-stream");
+        });
+    int port = server.bind_to_any_port("127.0.0.1");
+    std::thread listener([&]() { server.listen_after_bind(); });
+    while (!server.is_running())
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+
+    const unsigned num_threads = 4, num_requests = 500;
+    auto original = URI::httpPoolSettings();
+    unsigned run = 0;
+
+    for (unsigned idle : { 0u, 8u })
+    {
+        auto settings = original;
+        settings.maxIdleConnectionsPerHost = idle;
+        URI::setHTTPPoolSettings(settings);
+
+        auto& metrics = URI::httpMetrics();
+        auto opened = metrics.connectionsOpened.load();
+        auto reused = metrics.connectionsReused.load();
+        auto latency = metrics.totalLatencyUs.load();
+
+        std::string base = "http://127.0.0.1:" + std::to_string(port) + "/tile?run=" + std::to_string(run++) + "&i=";
+        auto ms = measure(1, [&]()
+            {
+                std::vector<std::thread> threads;
+                for (unsigned t = 0; t < num_threads; ++t)
+                {
+                    threads.emplace_back([&, t]() {
+                        for (unsigned i = t; i < num_requests; i += num_threads)
+                            URI(base + std::to_string(i)).read(IOOptions());
+                        });
+                }
+                for (auto& thread : threads)
+                    thread.join();
+            });
+
+        report(idle > 0 ? "keep-alive" : "no keep-alive", 1e3 * (double)num_requests / ms, "req/s",
+            "mean latency " + std::to_string((metrics.totalLatencyUs - latency) / num_requests) + "us"
+            ", opened " + std::to_string(metrics.connectionsOpened - opened) +
+            ", reused " + std::to_string(metrics.connectionsReused - reused));
+    }
+
+    URI::setHTTPPoolSettings(original);
+    server.stop();
+    listener.join();
+}
+#endif
+
+int main(int argc, char** argv)
+{
+    std::vector<std::string> names(argv + 1, argv + argc);
+    int failures = 0;
+
+    for (auto& benchmark : benchmarks())
+    {
+        if (!names.empty() && std::find(names.begin(), names.end(), benchmark.name) == names.end())
+            continue;
+
+        std::cout << benchmark.name << ": " << benchmark.description << std::endl;
+        try
+        {
+            benchmark.run();
+        }
+        catch (const std::exception& ex)
+        {
+            std::cout << "  FAILED: " << ex.what() << std::endl;
+            ++failures;
+        }
+        std::cout << std::endl;
+    }
+
+    return failures > 0 ? 1 : 0;
+}
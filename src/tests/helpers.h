@@ -0,0 +1,116 @@
+/**
+ * rocky c++
+ * Copyright 2023 Pelican Mapping
+ * MIT License
+ */
+#pragma once
+
+// Fixtures shared by the unit tests (tests.cpp) and the benchmarks (benchmarks.cpp).
+
+#include <rocky/Color.h>
+#include <rocky/ImageLayer.h>
+#include <rocky/Feature.h>
+#include <rocky/Math.h>
+#include <rocky/weemesh.h>
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace ROCKY_NAMESPACE
+{
+    namespace test
+    {
+        //! Image layer that makes solid-color tiles, counting the requests
+        //! and optionally taking a while to answer each one
+        class CountingImageLayer : public Inherit<ImageLayer, CountingImageLayer>
+        {
+        public:
+            mutable std::atomic_int count = { 0 };
+            std::chrono::milliseconds latency = std::chrono::milliseconds(0);
+            Color color = Color(1, 0, 0, 1);
+
+            Status openImplementation(const IOOptions& io) override {
+                setProfile(Profile::GLOBAL_GEODETIC);
+                return super::openImplementation(io);
+            }
+
+            Result<GeoImage> createImageImplementation(const TileKey& key, const IOOptions& io) const override {
+                ++count;
+                if (latency.count() > 0)
+                    std::this_thread::sleep_for(latency);
+                auto image = Image::create(Image::R8G8B8A8_UNORM, 16, 16);
+                image->fill(color);
+                return GeoImage(image, key.extent());
+            }
+        };
+
+        // Seeds a weemesh with a grid covering the polygon, then cuts in its
+        // segments, the same way FeatureView does (minus the projections).
+        // Returns the sorted XY corners of each resulting triangle.
+        template<class MESH>
+        std::vector<std::array<double, 6>> weemesh_polygon(MESH& m, const Geometry& polygon, double span)
+        {
+            Box ex;
+            Geometry::const_iterator ex_iter(polygon);
+            while (ex_iter.hasMore())
+            {
+                auto& part = ex_iter.next();
+                ex.expandBy(part.points.begin(), part.points.end());
+            }
+
+            int cols = std::max(2, (int)(ex.width() / span));
+            int rows = std::max(2, (int)(ex.height() / span));
+            for (int row = 0; row < rows; ++row)
+                for (int col = 0; col < cols; ++col)
+                    m.get_or_create_vertex_from_vec3(glm::dvec3(
+                        ex.xmin + ex.width() * (double)col / (double)(cols - 1),
+                        ex.ymin + ex.height() * (double)row / (double)(rows - 1), 0.0), 0);
+
+            for (int row = 0; row < rows - 1; ++row)
+            {
+                for (int col = 0; col < cols - 1; ++col)
+                {
+                    int k = row * cols + col;
+                    m.add_triangle(k, k + 1, k + cols);
+                    m.add_triangle(k + 1, k + cols + 1, k + cols);
+                }
+            }
+
+            Geometry::const_iterator iter(polygon);
+            while (iter.hasMore())
+            {
+                auto& part = iter.next();
+                for (unsigned i = 0; i < part.points.size(); ++i)
+                {
+                    unsigned j = (i == part.points.size() - 1) ? 0 : i + 1;
+                    m.insert(weemesh::segment_t{ part.points[i], part.points[j] }, 0);
+                }
+            }
+
+            std::vector<std::array<double, 6>> result;
+            auto add = [&](const weemesh::vert_t& a, const weemesh::vert_t& b, const weemesh::vert_t& c)
+                {
+                    std::array<std::pair<double, double>, 3> v{ { {a.x, a.y}, {b.x, b.y}, {c.x, c.y} } };
+                    std::sort(v.begin(), v.end());
+                    result.push_back({ v[0].first, v[0].second, v[1].first, v[1].second, v[2].first, v[2].second });
+                };
+            if constexpr (std::is_same_v<MESH, weemesh::flat_mesh_t>)
+            {
+                for (auto& tri : m.triangles)
+                    if (tri.alive)
+                        add(m.get_vertex(tri.i0), m.get_vertex(tri.i1), m.get_vertex(tri.i2));
+            }
+            else
+            {
+                for (auto& tri : m.triangles)
+                    add(tri.second.p0, tri.second.p1, tri.second.p2);
+            }
+            std::sort(result.begin(), result.end());
+            return result;
+        }
+    }
+}
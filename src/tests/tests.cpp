@@ -1,24 +1,48 @@
 #define CATCH_CONFIG_MAIN
 #include "catch.hpp"
+#include "helpers.h"
 
 #include <rocky/Instance.h>
 #include <rocky/Color.h>
+#include <rocky/CompressedImage.h>
+#include <rocky/Feature.h>
+#include <rocky/DiskCache.h>
 #include <rocky/Log.h>
 #include <rocky/Map.h>
 #include <rocky/Math.h>
 #include <rocky/Image.h>
+#include <rocky/ImageLayer.h>
+#include <rocky/ElevationLayer.h>
+#include <rocky/GeoHeightfield.h>
+#include <rocky/GeoImage.h>
 #include <rocky/Heightfield.h>
+#include <rocky/Horizon.h>
+#include <rocky/TerrainTileModelFactory.h>
 #include <rocky/TileKey.h>
 #include <rocky/URI.h>
 #include <rocky/Utils.h>
 #include <rocky/contrib/EarthFileImporter.h>
+#include <rocky/weemesh.h>
+#include <rocky_vsg/Line.h>
+#include <vsg/vk/ResourceRequirements.h>
 
+#include <array>
 #include <random>
+#include <algorithm>
+#include <filesystem>
+#include <thread>
 
 #ifdef ROCKY_SUPPORTS_GDAL
 #include <rocky/GDALImageLayer.h>
 #endif
 
+#ifdef HTTPLIB_FOUND
+#ifdef OPENSSL_FOUND
+#define CPPHTTPLIB_OPENSSL_SUPPORT
+#endif
+#include <httplib.h>
+#endif
+
 #ifdef ROCKY_SUPPORTS_TMS
 #include <rocky/TMSImageLayer.h>
 #endif
@@ -27,6 +51,7 @@
 #include <rocky/json.h>
 
 using namespace ROCKY_NAMESPACE;
+using namespace ROCKY_NAMESPACE::test;
 
 namespace
 {
@@ -128,6 +153,144 @@ TEST_CASE("Threading")
     CHECK(f2.value() == 123);
 }
 
+TEST_CASE("job_scheduler")
+{
+    // each section uses a single worker so that queued jobs run strictly in priority order
+
+    SECTION("Priority order")
+    {
+        util::job_scheduler scheduler("test-priority-order", 1u);
+        util::Event gate;
+        util::job_group group;
+        std::vector<util::Future<bool>> results;
+        std::vector<float> order;
+
+        // occupy the worker until all the other jobs are queued
+        results.emplace_back(util::job::dispatch(
+            [&gate](Cancelable&) { return gate.wait(); },
+            { "gate", []() { return FLT_MAX; }, &scheduler, &group }));
+
+        for (int i = 0; i < 100; ++i)
+        {
+            float p = (float)((i * 37) % 100);
+            results.emplace_back(util::job::dispatch(
+                [&order, p](Cancelable&) { order.push_back(p); return true; },
+                { "job", [p]() { return p; }, &scheduler, &group }));
+        }
+
+        gate.set();
+        group.join();
+
+        REQUIRE(order.size() == 100);
+        CHECK(std::is_sorted(order.rbegin(), order.rend()));
+    }
+
+    SECTION("Priority refresh")
+    {
+        util::job_scheduler scheduler("test-priority-refresh", 1u);
+
+        // refresh before every pop so changed priorities take effect immediately
+        scheduler.setPriorityRefreshInterval(std::chrono::steady_clock::duration(0));
+
+        util::Event gate;
+        util::job_group group;
+        std::vector<util::Future<bool>> results;
+        std::vector<int> order;
+        bool inverted = false;
+
+        results.emplace_back(util::job::dispatch(
+            [&gate](Cancelable&) { return gate.wait(); },
+            { "gate", []() { return FLT_MAX; }, &scheduler, &group }));
+
+        for (int i = 0; i < 10; ++i)
+        {
+            results.emplace_back(util::job::dispatch(
+                [&order, i](Cancelable&) { order.push_back(i); return true; },
+                { "job", [&inverted, i]() { return inverted ? (float)-i : (float)i; }, &scheduler, &group }));
+        }
+
+        // flip all priorities after queueing:
+        inverted = true;
+        gate.set();
+        group.join();
+
+        REQUIRE(order.size() == 10);
+        CHECK(std::is_sorted(order.begin(), order.end()));
+    }
+
+    SECTION("Work stealing")
+    {
+        util::job_scheduler scheduler("test-work-stealing", 2u);
+        scheduler.setWorkStealing(true);
+
+        // Each outer job fans out sub-jobs and joins them from its worker thread.
+        // With only 2 workers this relies on join() helping to run the sub-jobs.
+        std::atomic<int> count = 0;
+        util::job_group outer;
+        std::vector<util::Future<bool>> results;
+
+        for (int i = 0; i < 8; ++i)
+        {
+            results.emplace_back(util::job::dispatch(
+                [&scheduler, &count](Cancelable&)
+                {
+                    util::job_group inner;
+                    std::vector<util::Future<bool>> subresults;
+                    for (int j = 0; j < 16; ++j)
+                    {
+                        subresults.emplace_back(util::job::dispatch(
+                            [&count](Cancelable&) { count++; return true; },
+                            { "sub", nullptr, &scheduler, &inner }));
+                    }
+                    inner.join();
+                    return true;
+                },
+                { "outer", nullptr, &scheduler, &outer }));
+        }
+
+        outer.join();
+
+        CHECK(count == 128);
+        CHECK(std::all_of(results.begin(), results.end(), [](auto& r) { return r.available(); }));
+    }
+
+    SECTION("Cancel all")
+    {
+        util::job_scheduler scheduler("test-cancel-all", 1u);
+
+        util::Event started, gate;
+        util::job_group group;
+        std::vector<util::Future<bool>> results;
+        std::atomic<int> count = 0;
+
+        results.emplace_back(util::job::dispatch(
+            [&](Cancelable&) { started.set(); return gate.wait(); },
+            { "gate", nullptr, &scheduler, &group }));
+        started.wait();
+
+        for (int i = 0; i < 10; ++i)
+        {
+            results.emplace_back(util::job::dispatch(
+                [&count](Cancelable&) { count++; return true; },
+                { "job", nullptr, &scheduler, &group }));
+        }
+
+        scheduler.cancelAll();
+        gate.set();
+
+        // the discarded jobs must not keep the group waiting
+        group.join();
+        CHECK(count == 0);
+
+        auto& metrics = util::job_metrics::get();
+        auto m = std::find_if(metrics.begin(), metrics.end(),
+            [](auto& m) { return m && m->name == "test-cancel-all"; });
+        REQUIRE(m != metrics.end());
+        CHECK((*m)->canceled == 10);
+        CHECK((*m)->pending == 0);
+    }
+}
+
 TEST_CASE("Math")
 {
     CHECK(is_identity(glm::fmat4(1)));
@@ -146,6 +309,113 @@ TEST_CASE("Math")
     CHECK(r == glm::fvec3(0.75f, 0.75f, 0));
 }
 
+TEST_CASE("Horizon")
+{
+    Ellipsoid ellipsoid;
+
+    // corners of a 2x2 degree box at the equator, 0 to 1000m high:
+    std::vector<glm::dvec3> corners;
+    for (double z : { 0.0, 1000.0 })
+        for (double lat : { -1.0, 1.0 })
+            for (double lon : { -1.0, 1.0 })
+                corners.push_back(ellipsoid.geodeticToGeocentric({ lon, lat, z }));
+
+    glm::dvec3 cullingPoint;
+    REQUIRE(Horizon::computeCullingPoint(ellipsoid, corners.data(), (unsigned)corners.size(), cullingPoint));
+
+    Horizon horizon(ellipsoid);
+
+    // directly overhead
+    horizon.setEye(ellipsoid.geodeticToGeocentric({ 0.0, 0.0, 10000.0 }));
+    CHECK(horizon.isCullingPointVisible(cullingPoint));
+
+    // other side of the planet
+    horizon.setEye(ellipsoid.geodeticToGeocentric({ 180.0, 0.0, 10000.0 }));
+    CHECK(!horizon.isCullingPointVisible(cullingPoint));
+
+    // near the ground, far away
+    horizon.setEye(ellipsoid.geodeticToGeocentric({ 20.0, 0.0, 1000.0 }));
+    CHECK(!horizon.isCullingPointVisible(cullingPoint));
+
+    // same spot, but high enough to see over the horizon
+    horizon.setEye(ellipsoid.geodeticToGeocentric({ 20.0, 0.0, 1e7 }));
+    CHECK(horizon.isCullingPointVisible(cullingPoint));
+
+    // points below the ellipsoid have no culling point
+    corners.push_back(ellipsoid.geodeticToGeocentric({ 0.0, 0.0, -100.0 }));
+    CHECK(!Horizon::computeCullingPoint(ellipsoid, corners.data(), (unsigned)corners.size(), cullingPoint));
+}
+
+TEST_CASE("weemesh")
+{
+    // The flat mesh cuts polygons into exactly the same triangles as mesh_t
+    // until the meshes run out of 16-bit vertex indices. After that each one
+    // stops partway through a segment, so they only have to agree on the area
+    // they cover, which is always the whole seed grid.
+    auto area = [](const std::vector<std::array<double, 6>>& triangles)
+        {
+            double total = 0.0;
+            for (auto& t : triangles)
+                total += 0.5 * std::abs((t[2] - t[0]) * (t[5] - t[1]) - (t[4] - t[0]) * (t[3] - t[1]));
+            return total;
+        };
+
+    auto check = [&](unsigned n, double radius, double span, unsigned seed)
+        {
+            std::mt19937 rng(seed);
+            std::uniform_real_distribution<double> jitter(0.5, 1.0);
+
+            // a jagged ring with a hole
+            Geometry polygon(Geometry::Type::Polygon);
+            Geometry hole(Geometry::Type::Polygon);
+            for (unsigned i = 0; i < n; ++i)
+            {
+                double a = 2.0 * M_PI * (double)i / (double)n;
+                double r = radius * jitter(rng);
+                polygon.points.emplace_back(r * cos(a), r * sin(a), 0.0);
+                hole.points.emplace_back(0.2 * r * cos(-a), 0.2 * r * sin(-a), 0.0);
+            }
+            polygon.parts.push_back(hole);
+
+            weemesh::mesh_t mesh;
+            weemesh::flat_mesh_t flat;
+            auto expected = weemesh_polygon(mesh, polygon, span);
+            auto actual = weemesh_polygon(flat, polygon, span);
+
+            INFO("points=" << n << " radius=" << radius << " span=" << span);
+            CHECK(actual.size() == flat.num_triangles());
+
+            // every triangle is well formed and together they tile the seed grid:
+            Box ex;
+            ex.expandBy(polygon.points.begin(), polygon.points.end());
+            const double e = 1e-9 * radius;
+            for (auto& t : actual)
+                for (int i = 0; i < 6; i += 2)
+                    REQUIRE((t[i] >= ex.xmin - e && t[i] <= ex.xmax + e && t[i + 1] >= ex.ymin - e && t[i + 1] <= ex.ymax + e));
+            // (cuts snap to nearby vertices, so allow a little slop here)
+            CHECK(area(actual) == Approx(ex.width() * ex.height()).epsilon(1e-6));
+            CHECK(area(actual) == Approx(area(expected)).epsilon(1e-9));
+
+            bool out_of_verts = mesh.verts.size() + 1 >= 0xFFFF || flat.num_verts() + 1 >= 0xFFFF;
+            if (!out_of_verts)
+            {
+                CHECK(flat.num_verts() == mesh.verts.size());
+                CHECK(actual == expected);
+            }
+            return out_of_verts;
+        };
+
+    for (unsigned trial = 0; trial < 20; ++trial)
+        CHECK(!check(10 + trial * 20, 50.0, 4.36, 7));
+
+    // larger, denser rings, some of which exhaust the vertex indices
+    unsigned exhausted = 0;
+    for (unsigned n : { 906u, 957u, 1008u, 2000u })
+        exhausted += check(n, 500.0, 9.1, 7) ? 1 : 0;
+    exhausted += check(1350, 50.0, 2.0, 1) ? 1 : 0;
+    CHECK(exhausted > 0);
+}
+
 #if defined(ZLIB_FOUND)
 TEST_CASE("Compression")
 {
@@ -216,6 +486,167 @@ TEST_CASE("Image")
     CHECK(equiv(value.g, 0.5f, 0.01f));
     CHECK(equiv(value.b, 0.0f, 0.01f));
     CHECK(equiv(value.a, 1.0f, 0.01f));
+
+    SECTION("Spans")
+    {
+        // span and block APIs must match the per-pixel APIs for every format
+        std::mt19937 gen(7);
+        std::uniform_real_distribution<float> rand(0.0f, 1.0f);
+
+        for (int f = 0; f < Image::NUM_PIXEL_FORMATS; ++f)
+        {
+            auto format = (Image::PixelFormat)f;
+            auto a = Image::create(format, 37, 23);
+            auto b = Image::create(format, 37, 23);
+            std::vector<Image::Pixel> row(37);
+
+            for (unsigned t = 0; t < 23; ++t)
+            {
+                for (auto& p : row)
+                    p = Image::Pixel(rand(gen), rand(gen), rand(gen), rand(gen));
+
+                a->writeSpan(row.data(), 0, t, 37);
+                for (unsigned s = 0; s < 37; ++s)
+                    b->write(row[s], s, t);
+            }
+            CHECK(memcmp(a->data<unsigned char>(), b->data<unsigned char>(), a->sizeInBytes()) == 0);
+
+            unsigned readMismatches = 0;
+            for (unsigned t = 0; t < 23; ++t)
+            {
+                std::fill(row.begin(), row.end(), Image::Pixel(0));
+                a->readSpan(row.data() + 5, 5, t, 32);
+                for (unsigned s = 5; s < 37; ++s)
+                {
+                    Image::Pixel p(0);
+                    a->read(p, s, t);
+                    for (unsigned i = 0; i < a->numComponents(); ++i)
+                        if (p[i] != row[s][i]) ++readMismatches;
+                }
+            }
+            CHECK(readMismatches == 0);
+
+            std::vector<float> u(100), v(100);
+            for (auto& x : u) x = rand(gen);
+            for (auto& x : v) x = rand(gen);
+            std::vector<Image::Pixel> block(100);
+            a->read_bilinear(block.data(), u.data(), v.data(), 100);
+
+            unsigned bilinearMismatches = 0;
+            for (unsigned k = 0; k < 100; ++k)
+            {
+                Image::Pixel p(0);
+                a->read_bilinear(p, u[k], v[k]);
+                for (unsigned i = 0; i < a->numComponents(); ++i)
+                    if (!equiv(p[i], block[k][i], 1e-6)) ++bilinearMismatches;
+            }
+            CHECK(bilinearMismatches == 0);
+        }
+    }
+}
+
+TEST_CASE("GeoImage")
+{
+    SECTION("Reproject a source one pixel wide or high")
+    {
+        for (auto size : { std::make_pair(1u, 16u), std::make_pair(16u, 1u) })
+        {
+            auto image = Image::create(Image::R8G8B8A8_UNORM, size.first, size.second);
+            image->fill(Color(1, 0.5, 0, 1));
+            GeoImage source(image, GeoExtent(SRS::WGS84, -10, -40, 10, 40));
+
+            for (bool bilinear : { true, false })
+            {
+                auto result = source.reproject(SRS::SPHERICAL_MERCATOR, nullptr, 8, 8, bilinear);
+                REQUIRE(result.status.ok());
+                REQUIRE(result.value.image());
+
+                unsigned mismatches = 0;
+                Image::Pixel p;
+                for (unsigned t = 0; t < 8; ++t)
+                {
+                    for (unsigned s = 0; s < 8; ++s)
+                    {
+                        result.value.image()->read(p, s, t);
+                        if (!equiv(p.r, 1.0f, 0.01f) || !equiv(p.g, 0.5f, 0.01f) || !equiv(p.a, 1.0f, 0.01f))
+                            ++mismatches;
+                    }
+                }
+                CHECK(mismatches == 0);
+            }
+        }
+    }
+}
+
+TEST_CASE("CompressedImage")
+{
+    // smooth gradients plus a little noise, like typical imagery
+    std::mt19937 engine(0);
+    std::uniform_real_distribution<float> noise(-0.02f, 0.02f);
+    auto image = Image::create(Image::R8G8B8_UNORM, 256, 256);
+    for (unsigned t = 0; t < 256; ++t)
+        for (unsigned s = 0; s < 256; ++s)
+            image->write(Color((float)s / 255.0f + noise(engine), (float)t / 255.0f, 0.5f + noise(engine), 1.0f), s, t);
+
+    auto rmse = [](const Image& a, const Image& b, int channels)
+    {
+        double error = 0.0;
+        Image::Pixel pa, pb;
+        for (unsigned t = 0; t < a.height(); ++t)
+        {
+            for (unsigned s = 0; s < a.width(); ++s)
+            {
+                a.read(pa, s, t);
+                b.read(pb, s, t);
+                for (int c = 0; c < channels; ++c)
+                    error += (pa[c] - pb[c]) * (pa[c] - pb[c]);
+            }
+        }
+        return std::sqrt(error / (double)(a.width() * a.height() * channels)) * 255.0;
+    };
+
+    auto fast = CompressedImage::compress(*image, 0.0f, true);
+    auto best = CompressedImage::compress(*image, 1.0f, true);
+    REQUIRE(fast);
+    REQUIRE(best);
+
+    // opaque imagery -> BC1, 8 bytes per block, mipmaps down to 4x4
+    CHECK(best->format() == CompressedImage::BC1);
+    CHECK(best->numLevels() == 7);
+    CHECK(best->levelWidth(6) == 4);
+    CHECK(best->levelSize(0) == 64 * 64 * 8);
+    CHECK(best->data().size() * 8 == best->uncompressedSize());
+
+    auto fast_error = rmse(*image, *fast->decompress(), 3);
+    auto best_error = rmse(*image, *best->decompress(), 3);
+    CHECK(fast_error < 6.0);
+    CHECK(best_error < 6.0);
+    CHECK(best_error <= fast_error);
+
+    // each mipmap level is a box-filtered version of the one above it
+    auto mip = best->decompress(1);
+    REQUIRE(mip);
+    CHECK(mip->width() == 128);
+    Image::Pixel p;
+    mip->read(p, 64, 64);
+    CHECK(p.r == Approx(129.0f / 255.0f).margin(0.05f));
+
+    // transparent imagery -> BC3
+    auto rgba = Image::create(Image::R8G8B8A8_UNORM, 64, 64);
+    for (unsigned t = 0; t < 64; ++t)
+        for (unsigned s = 0; s < 64; ++s)
+            rgba->write(Color(1.0f, 0.5f, 0.25f, (float)s / 63.0f), s, t);
+
+    auto bc3 = CompressedImage::compress(*rgba, 0.5f, false);
+    REQUIRE(bc3);
+    CHECK(bc3->format() == CompressedImage::BC3);
+    CHECK(bc3->numLevels() == 1);
+    CHECK(bc3->data().size() == 16 * 16 * 16);
+    CHECK(rmse(*rgba, *bc3->decompress(), 4) < 4.0);
+
+    // ineligible images
+    CHECK(CompressedImage::compress(*Image::create(Image::R8G8B8A8_UNORM, 30, 32)) == nullptr);
+    CHECK(CompressedImage::compress(*Heightfield::create(32, 32)) == nullptr);
 }
 
 TEST_CASE("Heightfield")
@@ -247,6 +678,30 @@ TEST_CASE("Heightfield")
         // all NODATA:
         hf->fill(NO_DATA_VALUE);
         CHECK(hf->heightAtPixel(16.5, 16.5, Heightfield::BILINEAR) == NO_DATA_VALUE);
+
+        // batched sampling must match single-point sampling:
+        std::mt19937 gen(42);
+        std::uniform_real_distribution<float> heights(-100.0f, 100.0f);
+        hf->forEachHeight([&](float& h) { h = (gen() % 8 == 0) ? NO_DATA_VALUE : heights(gen); });
+
+        GeoHeightfield geohf(hf, GeoExtent(SRS::WGS84, -10, -10, 10, 10));
+        std::uniform_real_distribution<double> coords(-11.0, 11.0);
+        std::vector<glm::dvec3> points(1000);
+        for (auto& p : points)
+            p = glm::dvec3(coords(gen), coords(gen), 0.0);
+        points[0] = glm::dvec3(-10, -10, 0);
+        points[1] = glm::dvec3(10, 10, 0);
+
+        std::vector<float> batch(points.size());
+        geohf.heightsAtLocations(points.data(), points.size(), batch.data(), Heightfield::BILINEAR);
+        unsigned mismatches = 0;
+        for (unsigned i = 0; i < points.size(); ++i)
+        {
+            float single = geohf.heightAtLocation(points[i].x, points[i].y, Heightfield::BILINEAR);
+            if (!equiv(single, batch[i], 0.001f))
+                ++mismatches;
+        }
+        CHECK(mismatches == 0);
     }
 }
 
@@ -296,6 +751,68 @@ TEST_CASE("Map")
     }
 }
 
+TEST_CASE("TerrainTileModelFactory")
+{
+    Instance instance;
+    IOOptions io;
+
+    // a different color per layer, so the results show the layer order
+    const std::vector<Color> colors = { Color::Red, Color::Lime, Color::Blue };
+
+    auto map = Map::create(instance);
+    for (auto& color : colors)
+    {
+        auto layer = CountingImageLayer::create();
+        layer->latency = std::chrono::milliseconds(10);
+        layer->color = color;
+        REQUIRE(layer->open(io).ok());
+        map->layers().add(layer);
+    }
+
+    TileKey key(2, 1, 1, Profile::GLOBAL_GEODETIC);
+
+    auto color_at_center = [](const GeoImage& image)
+        {
+            Image::Pixel pixel;
+            image.image()->read(pixel, image.image()->width() / 2, image.image()->height() / 2);
+            return Color(pixel);
+        };
+
+    SECTION("Layer order")
+    {
+        TerrainTileModelFactory parallel;
+        parallel.compositeColorLayers = false;
+        parallel.fetchScheduler = util::job_scheduler::get("test.fetch");
+        auto model = parallel.createTileModel(map.get(), key, {}, io);
+
+        // parallel fetches still land in layer order:
+        REQUIRE(model.colorLayers.size() == colors.size());
+        for (unsigned i = 0; i < colors.size(); ++i)
+            CHECK(color_at_center(model.colorLayers[i].image) == colors[i]);
+    }
+
+    SECTION("Composite")
+    {
+        TerrainTileModelFactory serial;
+        auto serial_model = serial.createTileModel(map.get(), key, {}, io);
+
+        TerrainTileModelFactory parallel;
+        parallel.fetchScheduler = util::job_scheduler::get("test.fetch");
+        auto parallel_model = parallel.createTileModel(map.get(), key, {}, io);
+
+        // same composite either way, with the top layer on top:
+        REQUIRE(serial_model.colorLayers.size() == 1);
+        REQUIRE(parallel_model.colorLayers.size() == 1);
+
+        auto a = serial_model.colorLayers.front().image.image();
+        auto b = parallel_model.colorLayers.front().image.image();
+        REQUIRE((a && b));
+        CHECK(color_at_center(parallel_model.colorLayers.front().image) == colors.back());
+        CHECK(a->sizeInBytes() == b->sizeInBytes());
+        CHECK(std::equal(a->data<unsigned char>(), a->data<unsigned char>() + a->sizeInBytes(), b->data<unsigned char>()));
+    }
+}
+
 #ifdef ROCKY_SUPPORTS_GDAL
 TEST_CASE("GDAL")
 {
@@ -627,6 +1144,45 @@ TEST_CASE("SRS")
         // REQUIRE no crash :)
     }
 
+    SECTION("Approximate grid transform")
+    {
+        // sample grids for one tile each way between geographic and mercator
+        auto make_grid = [](double xmin, double ymin, double xmax, double ymax, unsigned n)
+        {
+            std::vector<glm::dvec3> grid(n * n);
+            for (unsigned r = 0; r < n; ++r)
+                for (unsigned c = 0; c < n; ++c)
+                    grid[r * n + c] = glm::dvec3(xmin + (xmax - xmin) * c / (n - 1), ymin + (ymax - ymin) * r / (n - 1), 0.0);
+            return grid;
+        };
+
+        struct Case { SRS from, to; double xmin, ymin, xmax, ymax, tolerance; };
+        std::vector<Case> cases = {
+            { SRS::WGS84, SRS::SPHERICAL_MERCATOR, 0.0, 40.0, 11.25, 50.0, 0.5 },
+            { SRS::SPHERICAL_MERCATOR, SRS::WGS84, 0.0, 4.8e6, 1.25e6, 6.05e6, 1e-5 }
+        };
+
+        for (auto& test : cases)
+        {
+            auto exact = make_grid(test.xmin, test.ymin, test.xmax, test.ymax, 256);
+            auto approx = exact;
+
+            auto xform = test.from.to(test.to);
+            REQUIRE(xform.transformGrid(exact.data(), 256, 256));
+
+            xform.setGridErrorTolerance(test.tolerance);
+            REQUIRE(xform.transformGrid(approx.data(), 256, 256));
+
+            double max_error = 0.0;
+            for (unsigned i = 0; i < exact.size(); ++i)
+            {
+                max_error = std::max(max_error, std::abs(exact[i].x - approx[i].x));
+                max_error = std::max(max_error, std::abs(exact[i].y - approx[i].y));
+            }
+            CHECK(max_error <= test.tolerance);
+        }
+    }
+
     SECTION("Well-known Profiles")
     {
         Profile GG("global-geodetic");
@@ -716,6 +1272,142 @@ TEST_CASE("IO")
         }
     }
 
+#ifdef HTTPLIB_FOUND
+    SECTION("HTTP connection reuse")
+    {
+        httplib::Server server;
+        server.Get("/tile", [](const httplib::Request&, httplib::Response& res) {
+            res.set_content(std::string(1024, 'x'), "application/octet-stream");
+            });
+        int port = server.bind_to_any_port("127.0.0.1");
+        std::thread listener([&]() { server.listen_after_bind(); });
+        while (!server.is_running())
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+
+        auto& metrics = URI::httpMetrics();
+        auto opened = metrics.connectionsOpened.load();
+        auto reused = metrics.connectionsReused.load();
+
+        // distinct URLs, so the content cache doesn't answer them
+        std::string base = "http://127.0.0.1:" + std::to_string(port) + "/tile?i=";
+        for (int i = 0; i < 10; ++i)
+        {
+            CHECK(URI(base + std::to_string(i)).read(IOOptions()).status.ok());
+        }
+
+        CHECK(metrics.connectionsOpened - opened == 1);
+        CHECK(metrics.connectionsReused - reused == 9);
+
+        server.stop();
+        listener.join();
+    }
+
+    SECTION("HTTP request coalescing")
+    {
+        std::atomic_int served = { 0 };
+        httplib::Server server;
+        server.Get("/slow", [&](const httplib::Request&, httplib::Response& res) {
+            ++served;
+            std::this_thread::sleep_for(std::chrono::milliseconds(200));
+            res.set_content("slow", "text/plain");
+            });
+        int port = server.bind_to_any_port("127.0.0.1");
+        std::thread listener([&]() { server.listen_after_bind(); });
+        while (!server.is_running())
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+
+        // identical concurrent reads should reach the server once
+        URI uri("http://127.0.0.1:" + std::to_string(port) + "/slow");
+        std::atomic_int succeeded = { 0 };
+        std::vector<std::thread> readers;
+        for (int i = 0; i < 8; ++i)
+        {
+            readers.emplace_back([&]() {
+                auto r = uri.read(IOOptions());
+                if (r.status.ok() && r.value.data == "slow")
+                    ++succeeded;
+                });
+        }
+        for (auto& reader : readers)
+            reader.join();
+
+        CHECK(succeeded == 8);
+        CHECK(served == 1);
+
+        server.stop();
+        listener.join();
+    }
+
+    SECTION("HTTP request coalescing with a canceled leader")
+    {
+        std::atomic_int served = { 0 };
+        httplib::Server server;
+        server.Get("/busy", [&](const httplib::Request&, httplib::Response& res) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(300));
+            res.set_content("busy", "text/plain");
+            });
+        server.Get("/tile", [&](const httplib::Request&, httplib::Response& res) {
+            ++served;
+            res.set_content("tile", "text/plain");
+            });
+        int port = server.bind_to_any_port("127.0.0.1");
+        std::thread listener([&]() { server.listen_after_bind(); });
+        while (!server.is_running())
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+
+        // one request at a time, so the leader waits for a connection
+        // behind /busy and can be canceled while it waits
+        auto original = URI::httpPoolSettings();
+        auto settings = original;
+        settings.maxRequestsPerHost = 1;
+        URI::setHTTPPoolSettings(settings);
+
+        std::string base = "http://127.0.0.1:" + std::to_string(port);
+        std::thread busy([&]() { URI(base + "/busy").read(IOOptions()); });
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+
+        struct Flag : public Cancelable {
+            std::atomic_bool value = { false };
+            bool canceled() const override { return value; }
+        } cancel_leader;
+
+        URI uri(base + "/tile");
+        std::atomic_bool leader_failed = { false };
+        std::thread leader([&]() {
+            IOOptions io(cancel_leader);
+            leader_failed = uri.read(io).status.failed();
+            });
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+
+        std::atomic_int succeeded = { 0 };
+        std::vector<std::thread> waiters;
+        for (int i = 0; i < 3; ++i)
+        {
+            waiters.emplace_back([&]() {
+                auto r = uri.read(IOOptions());
+                if (r.status.ok() && r.value.data == "tile")
+                    ++succeeded;
+                });
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+
+        // the waiters must take over the read instead of waiting forever
+        cancel_leader.value = true;
+        leader.join();
+        for (auto& waiter : waiters)
+            waiter.join();
+        busy.join();
+
+        CHECK(leader_failed);
+        CHECK(succeeded == 3);
+        CHECK(served == 1);
+
+        URI::setHTTPPoolSettings(original);
+        server.stop();
+        listener.join();
+    }
+#endif
+
     SECTION("URI")
     {
         URI file("C:/folder/filename.ext");
@@ -748,6 +1440,154 @@ TEST_CASE("IO")
     }
 }
 
+TEST_CASE("ContentCache")
+{
+    // one shard, so the byte budget applies to every entry
+    ContentCache cache(10 * 1024, 1);
+
+    Content big{ "application/octet-stream", std::string(4000, 'x') };
+    cache.put("a", big, "layer1");
+    cache.put("b", big, "layer2");
+    CHECK(cache.get("a", "layer1").status.ok());
+    CHECK(cache.get("c", "layer1").status.failed());
+
+    // exceeds the budget and evicts "b", the least recently used:
+    cache.put("c", big, "layer1");
+    CHECK(cache.get("b", "layer2").status.failed());
+    CHECK(cache.get("a", "layer1").value.data == big.data);
+
+    auto stats = cache.stats();
+    CHECK(stats.entries == 2);
+    CHECK(stats.bytes <= 10 * 1024);
+    CHECK(stats.evictions == 1);
+    CHECK(stats.hits == 2);
+    CHECK(stats.misses == 2);
+    CHECK(cache.hitRatio() == 0.5f);
+
+    auto bins = cache.statsPerBin();
+    CHECK(bins["layer1"].entries == 2);
+    CHECK(bins["layer1"].hits == 2);
+    CHECK(bins["layer2"].entries == 0);
+    CHECK(bins["layer2"].evictions == 1);
+
+    // content larger than the budget is not cached:
+    cache.put("huge", Content{ "", std::string(20 * 1024, 'x') });
+    CHECK(cache.get("huge").status.failed());
+
+    // shrinking evicts immediately:
+    cache.setCapacity(5 * 1024);
+    CHECK(cache.stats().entries == 1);
+
+    cache.clear();
+    CHECK(cache.stats().entries == 0);
+    CHECK(cache.stats().hits == 0);
+
+    // content bigger than one shard's share still fits in the cache,
+    // taking its space from the other shards:
+    ContentCache sharded(16 * 1024, 4);
+    Content small{ "", std::string(1024, 'x') };
+    for (int i = 0; i < 8; ++i)
+        sharded.put("small" + std::to_string(i), small);
+
+    Content large{ "", std::string(10 * 1024, 'x') };
+    sharded.put("large1", large);
+    CHECK(sharded.get("large1").status.ok());
+    CHECK(sharded.stats().bytes <= 16 * 1024);
+
+    sharded.put("large2", large);
+    CHECK(sharded.get("large2").status.ok());
+    CHECK(sharded.get("large1").status.failed());
+    CHECK(sharded.stats().bytes <= 16 * 1024);
+}
+
+TEST_CASE("DiskCache")
+{
+    auto path = (std::filesystem::temp_directory_path() / "rocky_test_disk_cache").string();
+    std::filesystem::remove_all(path);
+
+    SECTION("Read and write")
+    {
+        auto cache = DiskCache::create(path);
+        CHECK(cache->read("bin", "key").status.code == Status::ResourceUnavailable);
+
+        CHECK(cache->write("bin", "key", "hello").ok());
+        auto r = cache->read("bin", "key");
+        REQUIRE(r.status.ok());
+        CHECK(r.value.data == "hello");
+        CHECK(r.value.lastModified > 0);
+        CHECK(cache->count() == 1);
+
+        cache->remove("bin", "key");
+        CHECK(cache->read("bin", "key").status.failed());
+        CHECK(cache->count() == 0);
+        CHECK(cache->size() == 0);
+    }
+
+    SECTION("Eviction")
+    {
+        auto cache = DiskCache::create(path);
+        std::string data(1000, 'x');
+        for (int i = 0; i < 10; ++i)
+            cache->write("bin", std::to_string(i), data);
+
+        // touch the oldest record so it survives:
+        CHECK(cache->read("bin", "0").status.ok());
+
+        cache->setMaxSize(5000);
+        CHECK(cache->size() <= 5000);
+        CHECK(cache->count() == 4);
+        CHECK(cache->read("bin", "0").status.ok());
+        CHECK(cache->read("bin", "1").status.failed());
+        CHECK(cache->read("bin", "9").status.ok());
+    }
+
+    SECTION("Persistence")
+    {
+        {
+            auto cache = DiskCache::create(path);
+            cache->write("bin", "key", "persistent");
+        }
+        auto cache = DiskCache::create(path);
+        CHECK(cache->count() == 1);
+        auto r = cache->read("bin", "key");
+        REQUIRE(r.status.ok());
+        CHECK(r.value.data == "persistent");
+    }
+
+    SECTION("Image layer")
+    {
+        auto cache = DiskCache::create(path);
+        IOOptions io;
+        io.services.cache = [cache]() { return cache; };
+
+        auto layer = CountingImageLayer::create();
+        REQUIRE(layer->open(io).ok());
+
+        TileKey key(1, 0, 0, Profile::GLOBAL_GEODETIC);
+        auto r1 = layer->createImage(key, io);
+        REQUIRE(r1.status.ok());
+        CHECK(layer->count == 1);
+
+        auto r2 = layer->createImage(key, io);
+        REQUIRE(r2.status.ok());
+        REQUIRE(r2.value.valid());
+        CHECK(layer->count == 1);
+        CHECK(r2.value.image()->sizeInBytes() == r1.value.image()->sizeInBytes());
+        Image::Pixel pixel;
+        r2.value.image()->read(pixel, 0, 0);
+        CHECK(pixel.r == 1.0f);
+
+        // with caching disabled, the layer goes back to the source:
+        layer->close();
+        layer->setCachePolicy(CachePolicy::NO_CACHE);
+        REQUIRE(layer->open(io).ok());
+        layer->createImage(key, io);
+        CHECK(layer->count == 2);
+    }
+
+    std::filesystem::remove_all(path);
+}
+
 TEST_CASE("Earth File")
 {
     EarthFileImporter importer;
@@ -767,3 +1607,47 @@ TEST_CASE("Earth File")
         }
     }
 }
+
+TEST_CASE("LineGeometry")
+{
+    // 3 pages of 64 points
+    auto line = LineGeometry::create();
+    line->setCapacity(150);
+
+    // the resource collector must see every page of every attribute, so the
+    // transfer task will re-upload pages that change after compilation:
+    vsg::CollectResourceRequirements collect;
+    line->accept(collect);
+    auto& tracked = collect.requirements.dynamicData.bufferInfos;
+    REQUIRE(tracked.size() == 3 * 4);
+
+    // fill the first two pages, then note the modification counts
+    for (unsigned i = 0; i < 2 * LineGeometry::page_size; ++i)
+        line->push_back(vsg::vec3(i, 0, 0));
+
+    std::vector<vsg::ModifiedCount> before(tracked.size());
+    for (std::size_t i = 0; i < tracked.size(); ++i)
+        tracked[i]->data->getModifiedCount(before[i]);
+
+    // the next point goes to the start of the third page:
+    const vsg::vec3 point(128, 0, 0);
+    line->push_back(point);
+    CHECK(line->numVerts() == 129);
+
+    unsigned changed = 0, changed_with_point = 0;
+    for (std::size_t i = 0; i < tracked.size(); ++i)
+    {
+        if (tracked[i]->data->differentModifiedCount(before[i]))
+        {
+            ++changed;
+            auto array = tracked[i]->data.cast<vsg::vec3Array>();
+            if (array && array->at(0) == point)
+                ++changed_with_point;
+        }
+    }
+
+    // the third current, previous and next pages, plus the second next page
+    // (the old last point now leads to the new one):
+    CHECK(changed == 4);
+    CHECK(changed_with_point == 2);
+}